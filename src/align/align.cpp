@@ -23,17 +23,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "align.h"
 #include "output/output_format.h"
 #include "output/output.h"
-#include "legacy/pipeline.h"
+#include "dp/dp.h"
 #include "search/hit_buffer.h"
 #include "util/parallel/thread_pool.h"
+#include "util/memory/governor.h"
 #include "extend.h"
 #include "util/util.h"
 #ifdef WITH_DNA
 #include "../dna/extension.h"
 #endif
 #include "util/util.h"
-#define _REENTRANT
-#include "ips4o/ips4o.hpp"
 #include "data/queries.h"
 #include "data/sequence_file.h"
 #include "search/hit_buffer.h"
@@ -117,43 +116,6 @@ struct HitIterator {
 	const BlockId query_begin, query_end;
 };
 
-static TextBuffer* legacy_pipeline(const HitIterator::Hits& hits, Search::Config& cfg, Statistics &stat) {
-	if (hits.end == hits.begin) {
-		TextBuffer *buf = nullptr;
-		if (!cfg.blocked_processing && *cfg.output_format != OutputFormat::daa && cfg.output_format->report_unaligned()) {
-			buf = new TextBuffer;
-			Output::Info info{ cfg.query->seq_info(hits.query), true, cfg.db.get(), *buf, Util::Seq::AccessionParsing(), cfg.db->sequence_count(), cfg.db->letters() };
-			cfg.output_format->print_query_intro(info);
-			cfg.output_format->print_query_epilog(info);
-		}
-		return buf;
-	}
-
-	QueryMapper *mapper = new ExtensionPipeline::BandedSwipe::Pipeline(hits.query, hits.begin, hits.end, dp_stat, cfg);
-
-	TaskTimer timer("Initializing mapper", UINT_MAX);
-	mapper->init();
-	timer.finish();
-	mapper->run(stat, cfg);
-
-	timer.go("Generating output");
-	TextBuffer *buf = nullptr;
-	if (*cfg.output_format != OutputFormat::null) {
-		buf = new TextBuffer;
-		const bool aligned = mapper->generate_output(*buf, stat, cfg);
-		if (aligned && cfg.track_aligned_queries) {
-			query_aligned_mtx.lock();
-			if (!query_aligned[hits.query]) {
-				query_aligned[hits.query] = true;
-				++cfg.iteration_query_aligned;
-			}
-			query_aligned_mtx.unlock();
-		}
-	}
-	delete mapper;
-	return buf;
-}
-
 static void align_worker(HitIterator* hit_it, Search::Config* cfg, int64_t next)
 {
 	try {
@@ -165,11 +127,6 @@ static void align_worker(HitIterator* hit_it, Search::Config* cfg, int64_t next)
 		const bool parallel = config.swipe_all && (cfg->target->seqs().size() >= cfg->query->seqs().size());
 
 		for (auto h = hits.cbegin(); h < hits.cend(); ++h) {
-			if (config.frame_shift != 0) {
-				TextBuffer* buf = legacy_pipeline(*h, *cfg, stat);
-				output_sink->push(h->query, buf);
-				continue;
-			}
 			if (h->begin == nullptr && !HitIterator::single_query()) {
 				output_sink->push(h->query, nullptr);
 				continue;
@@ -200,42 +157,40 @@ static void align_worker(HitIterator* hit_it, Search::Config* cfg, int64_t next)
 	}
 }
 
+// Trace points to fetch in one load, limited by the memory headroom.
+static size_t fetch_size(const Search::Config& cfg) {
+	const int64_t headroom = Util::Memory::available(Util::Memory::Pool::TRACE_POINTS) - (int64_t)(cfg.seed_hit_buf->next_bin_size() * sizeof(Search::Hit));
+	return (size_t)std::max(std::min(headroom, (int64_t)config.trace_pt_fetch_size), (int64_t)0);
+}
+
 void align_queries(File* output_file, Search::Config& cfg)
 {
-	const uint64_t mem_limit = Util::String::interpret_number(config.memory_limit.get("16G"));
-
 	pair<BlockId, BlockId> query_range;
 	TaskTimer timer("Allocating memory", 3);
 
 	if (!cfg.blocked_processing && !cfg.iterated())
 		cfg.db->init_random_access(cfg.current_query_block, 0, false);
 
-	uint64_t res_size = cfg.query->mem_size() + cfg.target->mem_size();
 	cfg.seed_hit_buf->alloc_buffer();
-	cfg.seed_hit_buf->load(std::min(mem_limit - res_size - cfg.seed_hit_buf->next_bin_size() * (uint64_t)sizeof(Search::Hit), config.trace_pt_fetch_size));
+	cfg.seed_hit_buf->load(fetch_size(cfg));
+	Util::Memory::Reservation trace_pt_mem(Util::Memory::Pool::TRACE_POINTS, 0);
 	bool goon = true;
 
 	while (goon) {
 		timer.go("Loading trace points");
 		tuple<Search::Hit*, int64_t, BlockId, BlockId> input = cfg.seed_hit_buf->retrieve();
 		statistics.inc(Statistics::TIME_LOAD_SEED_HITS, timer.microseconds());
-		goon = cfg.seed_hit_buf->load(std::min(mem_limit - res_size - cfg.seed_hit_buf->next_bin_size() * (int64_t)sizeof(Search::Hit), config.trace_pt_fetch_size));
-		timer.finish();
 		Search::Hit* hit_buf = get<0>(input);
 		const int64_t hit_count = get<1>(input);
+		trace_pt_mem.resize(hit_count * sizeof(Search::Hit));
+		// Under memory pressure, the next trace points are loaded after the current ones have been aligned instead of concurrently.
+		const bool prefetch = !Util::Memory::pressure();
+		if (prefetch)
+			goon = cfg.seed_hit_buf->load(fetch_size(cfg));
+		timer.finish();
 		*log_stream << "Processing " << hit_count << " trace points (" << Util::String::format(int64_t(hit_count * sizeof(Search::Hit))) << ")." << std::endl;
-		res_size += hit_count * sizeof(Search::Hit);
 		query_range = { get<2>(input), get<3>(input) };
 
-		timer.go("Sorting trace points");
-#ifdef NDEBUG
-		//sort::sort_parallel_blocked_inplace(hit_buf, hit_buf + hit_count, std::less<Search::Hit>(), config.threads_);
-		ips4o::parallel::sort(hit_buf, hit_buf + hit_count, std::less<Search::Hit>(), config.threads_);
-#else
-		std::sort(hit_buf, hit_buf + hit_count);
-#endif
-		statistics.inc(Statistics::TIME_SORT_SEED_HITS, timer.microseconds());
-
 		timer.go("Computing partition");
 		const vector<int64_t> partition = make_partition(hit_buf, hit_buf + hit_count);
 
@@ -259,6 +214,10 @@ void align_queries(File* output_file, Search::Config& cfg)
 		timer.go("Deallocating buffers");
 		cfg.thread_pool.reset();
 		output_sink.reset();
+		if (!prefetch) {
+			trace_pt_mem.release();
+			goon = cfg.seed_hit_buf->load(fetch_size(cfg));
+		}
 	}
 	statistics.max(Statistics::SEARCH_TEMP_SPACE, cfg.seed_hit_buf->total_disk_size());
 
@@ -124,7 +124,7 @@ static TargetVec recompute_alt_hsps(const Sequence* query_seq, const int query_s
 }
 
 void recompute_alt_hsps(vector<Match>::iterator begin, vector<Match>::iterator end, const Sequence* query, const int query_source_len, const HauserCorrection* query_cb, const HspValues v, Statistics& stats) {
-	if (config.max_hsps == 1)
+	if (config.max_hsps == 1 || config.frame_shift != 0)
 		return;
 	TargetVec targets;
 	targets.reserve(end - begin);
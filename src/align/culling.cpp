@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "contrib/mcl/recursive_parser.h"
 #endif
 #include "output/output_format.h"
+#include "util/geo/interval_partition.h"
 #include "culling.h"
 
 using std::vector;
@@ -184,9 +185,49 @@ void Match::apply_filters(int source_query_len, const char *query_title, const S
 	filter_score = hsp.empty() ? 0 : hsp.front().score;
 }
 
+template<typename F>
+static void for_each_hsp(const Target& target, F f) {
+	for (int frame = 0; frame < align_mode.query_contexts; ++frame)
+		for (const Hsp& hsp : target.hsp[frame])
+			f(hsp);
+}
+
+template<typename F>
+static void for_each_hsp(const Match& match, F f) {
+	for (const Hsp& hsp : match.hsp)
+		f(hsp);
+}
+
+template<typename T>
+static void range_culling(vector<T>& targets, const Search::Config& cfg) {
+	IntervalPartition ip(cfg.max_target_seqs);
+	auto out = targets.begin();
+	for (auto i = targets.begin(); i < targets.end(); ++i) {
+		Loc covered = 0, len = 0;
+		for_each_hsp(*i, [&](const Hsp& hsp) {
+			if (config.toppercent.blank())
+				covered += ip.covered(hsp.query_source_range);
+			else
+				covered += ip.covered(hsp.query_source_range, Score(hsp.score / (1.0 - config.toppercent / 100.0)), IntervalPartition::MaxScore());
+			len += hsp.query_source_range.length();
+			});
+		if (len > 0 && (double)covered / len * 100.0 >= config.query_range_cover)
+			continue;
+		for_each_hsp(*i, [&ip](const Hsp& hsp) { ip.insert(hsp.query_source_range, hsp.score); });
+		if (out != i)
+			*out = std::move(*i);
+		++out;
+	}
+	targets.erase(out, targets.end());
+}
+
 void culling(std::vector<Target>& targets, bool sort_only, const Search::Config& cfg) {
 	sort_targets(targets);
-	if (!sort_only)
+	if (sort_only)
+		return;
+	if (config.query_range_culling)
+		range_culling(targets, cfg);
+	else
 		targets.erase(output_range(targets.begin(), targets.end(), cfg), targets.end());
 }
 
@@ -198,7 +239,10 @@ void apply_filters(std::vector<Match>::iterator begin, std::vector<Match>::itera
 
 void culling(std::vector<Match>& targets, const Search::Config& cfg) {
 	std::sort(targets.begin(), targets.end(), config.toppercent.present() ? Match::cmp_score : Match::cmp_evalue);
-	targets.erase(output_range(targets.begin(), targets.end(), cfg), targets.end());
+	if (config.query_range_culling)
+		range_culling(targets, cfg);
+	else
+		targets.erase(output_range(targets.begin(), targets.end(), cfg), targets.end());
 }
 
 }
\ No newline at end of file
@@ -32,6 +32,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "target.h"
 #include "util/log_stream.h"
 #include "util/util.h"
+#include "util/memory/governor.h"
 #include "global_ranking/global_ranking.h"
 #include "search/hit.h"
 #include "load_hits.h"
@@ -219,7 +220,7 @@ static vector<Target> extend_chunk(BlockId query_id,
 	if (!flag_any(flags, DP::Flags::PARALLEL))
 		stat.inc(Statistics::TIME_CHAINING, timer.microseconds());
 
-	auto ret = align(targets, query_seq, cfg.query->ids()[query_id], query_cb, source_query_len, flags, hsp_values, cfg.extension_mode, *cfg.thread_pool, cfg, stat, pool);
+	auto ret = align(targets, query_id, query_seq, cfg.query->ids()[query_id], query_cb, source_query_len, flags, hsp_values, cfg.extension_mode, *cfg.thread_pool, cfg, stat, pool);
 	return ret;
 }
 
@@ -331,7 +332,7 @@ vector<Match> extend(
 		culling(aligned_targets, !first_round_culling, cfg);
 		stat.inc(Statistics::TARGET_HITS5, aligned_targets.size());
 		
-		vector<Match> round_matches = align(aligned_targets, matches.size(), query_seq.data(), query_title, query_cb.data(), source_query_len, self_aln_score, flags, first_round_hspv, first_round_culling, stat, cfg);
+		vector<Match> round_matches = align(aligned_targets, matches.size(), query_id, query_seq.data(), query_title, query_cb.data(), source_query_len, self_aln_score, flags, first_round_hspv, first_round_culling, stat, cfg);
 		matches.insert(matches.end(), make_move_iterator(round_matches.begin()), make_move_iterator(round_matches.end()));
 	} while (config.toppercent.blank() && (int64_t)matches.size() < config.max_target_seqs_.get(DEFAULT_MAX_TARGET_SEQS) && i0 < l.target_scores.cend() && new_hits_ev && (!config.mapany || (config.mapany && matches.empty())));
 
@@ -347,6 +348,8 @@ vector<Match> extend(BlockId query_id, Search::Hit* begin, Search::Hit* end, con
 	TaskTimer timer(flag_any(flags, DP::Flags::PARALLEL) ? config.target_parallel_verbosity : UINT_MAX);
 	timer.go("Loading seed hits");
 	SeedHitList l = load_hits(begin, end, cfg.target->seqs());
+	const Util::Memory::Reservation seed_hit_mem(Util::Memory::Pool::SEED_HITS,
+		int64_t(l.seed_hits.data_size() * sizeof(SeedHit) + l.target_block_ids.size() * (sizeof(uint32_t) + sizeof(TargetScore))));
 	const unsigned contexts = align_mode.query_contexts;
 	vector<Sequence> query_seq;
 	for (unsigned i = 0; i < contexts; ++i)
@@ -77,7 +77,30 @@ static void add_dp_targets(const Target& target, int target_idx, const Sequence*
 	}
 }
 
-vector<Match> align(vector<Target>& targets, const int64_t previous_matches, const Sequence* query_seq, const char* query_id, const HauserCorrection* query_cb, int source_query_len, double query_self_aln_score, DP::Flags flags, const HspValues first_round, const bool first_round_culling, Statistics& stat, const Search::Config& cfg) {
+static void add_dp_targets_3frame(const Target& target, int target_idx, const Sequence* query_seq, DP::FrameshiftTargets& dp_targets) {
+	const Loc tlen = target.seq.length();
+	for (int frame = 0; frame < align_mode.query_contexts; ++frame) {
+		const int strand = frame < 3 ? 0 : 1;
+		const Loc qlen = query_seq[strand * 3].length();
+		for (const Hsp& hsp : target.hsp[frame])
+			dp_targets[strand].emplace_back(target.seq, tlen, hsp.d_begin, hsp.d_end, target_idx, qlen);
+	}
+}
+
+static void align_3frame(vector<Target>::iterator begin, vector<Target>::iterator end, vector<Match>& r, const TranslatedSequence& query, const Sequence* query_seq, DP::Flags flags, const HspValues hsp_values) {
+	DP::FrameshiftTargets dp_targets;
+	for (auto i = begin; i < end; ++i) {
+		if (i->done)
+			continue;
+		add_dp_targets_3frame(*i, (int32_t)r.size(), query_seq, dp_targets);
+		r.emplace_back(i->block_id, i->seq, std::move(i->matrix), i->ungapped_score);
+	}
+	list<Hsp> hsp = DP::BandedSwipe::swipe_3frame(query, dp_targets, hsp_values, flags);
+	while (!hsp.empty())
+		r[hsp.front().swipe_target].add_hit(hsp, hsp.begin());
+}
+
+vector<Match> align(vector<Target>& targets, const int64_t previous_matches, BlockId query_block_id, const Sequence* query_seq, const char* query_id, const HauserCorrection* query_cb, int source_query_len, double query_self_aln_score, DP::Flags flags, const HspValues first_round, const bool first_round_culling, Statistics& stat, const Search::Config& cfg) {
 	static const int64_t MIN_STEP = 16;
 	vector<Match> r;
 	if (targets.empty())
@@ -113,12 +136,15 @@ vector<Match> align(vector<Target>& targets, const int64_t previous_matches, con
 
 		const int64_t matches_begin = r.size();
 
-		for (auto i = it; i < it + step_size; ++i) {
-			if (i->done)
-				continue;
-			add_dp_targets(*i, (int32_t)r.size(), query_seq, dp_targets, flags, hsp_values, cfg.extension_mode);
-			r.emplace_back(i->block_id, i->seq, std::move(i->matrix), i->ungapped_score);
-		}
+		if (config.frame_shift != 0)
+			align_3frame(it, it + step_size, r, cfg.query->translated(query_block_id), query_seq, flags, hsp_values);
+		else
+			for (auto i = it; i < it + step_size; ++i) {
+				if (i->done)
+					continue;
+				add_dp_targets(*i, (int32_t)r.size(), query_seq, dp_targets, flags, hsp_values, cfg.extension_mode);
+				r.emplace_back(i->block_id, i->seq, std::move(i->matrix), i->ungapped_score);
+			}
 
 		for (int frame = 0; frame < align_mode.query_contexts; ++frame) {
 			if (dp_targets[frame].empty())
@@ -179,11 +179,63 @@ static void add_dp_targets(const WorkTarget& target,
 	}
 }
 
-vector<Target> align(vector<WorkTarget>& targets, const Sequence* query_seq, const char* query_id, const HauserCorrection* query_cb, int source_query_len, DP::Flags flags, const HspValues hsp_values, const Mode mode, ThreadPool& tp, const Search::Config& cfg, Statistics& stat, std::pmr::monotonic_buffer_resource& pool) {
+static void add_dp_targets_3frame(const WorkTarget& target, BlockId target_idx, const Sequence* query_seq, DP::FrameshiftTargets& dp_targets, const Mode mode) {
+	const Loc band = Extension::band(query_seq->length(), mode),
+		slen = target.seq.length();
+	vector<pair<Loc, Loc>> bands;
+	for (int strand = 0; strand < 2; ++strand) {
+		const Loc qlen = query_seq[strand * 3].length();
+		bands.clear();
+		for (int frame = strand * 3; frame < strand * 3 + 3; ++frame)
+			for (const ApproxHsp& hsp : target.hsp[frame])
+				bands.emplace_back(std::max(hsp.d_min - band, -(slen - 1)), std::min(hsp.d_max + 1 + band, qlen));
+		if (bands.empty())
+			continue;
+		std::sort(bands.begin(), bands.end());
+		Loc d0 = bands.front().first, d1 = bands.front().second;
+		for (auto i = bands.cbegin() + 1; i < bands.cend(); ++i) {
+			if (i->first <= d1) {
+				d1 = std::max(d1, i->second);
+				continue;
+			}
+			dp_targets[strand].emplace_back(target.seq, slen, d0, d1, target_idx, qlen);
+			d0 = i->first;
+			d1 = i->second;
+		}
+		dp_targets[strand].emplace_back(target.seq, slen, d0, d1, target_idx, qlen);
+	}
+}
+
+static vector<Target> align_3frame(vector<WorkTarget>& targets, const TranslatedSequence& query, const Sequence* query_seq, DP::Flags flags, const HspValues hsp_values, const Mode mode) {
+	DP::FrameshiftTargets dp_targets;
+	vector<Target> r;
+	r.reserve(targets.size());
+	for (size_t i = 0; i < targets.size(); ++i) {
+		r.emplace_back(targets[i].block_id, targets[i].seq, targets[i].ungapped_score.front(), std::move(targets[i].matrix));
+		add_dp_targets_3frame(targets[i], (BlockId)i, query_seq, dp_targets, mode);
+	}
+
+	list<Hsp> hsp = DP::BandedSwipe::swipe_3frame(query, dp_targets, hsp_values, flags);
+	while (!hsp.empty())
+		r[hsp.front().swipe_target].add_hit(hsp, hsp.begin());
+
+	vector<Target> r2;
+	r2.reserve(r.size());
+	for (vector<Target>::iterator i = r.begin(); i != r.end(); ++i)
+		if (i->filter_evalue != DBL_MAX) {
+			i->inner_culling();
+			r2.push_back(std::move(*i));
+		}
+	return r2;
+}
+
+vector<Target> align(vector<WorkTarget>& targets, BlockId query_block_id, const Sequence* query_seq, const char* query_id, const HauserCorrection* query_cb, int source_query_len, DP::Flags flags, const HspValues hsp_values, const Mode mode, ThreadPool& tp, const Search::Config& cfg, Statistics& stat, std::pmr::monotonic_buffer_resource& pool) {
 	array<DP::Targets, MAX_CONTEXT> dp_targets;
 	vector<Target> r;
 	if (targets.empty())
 		return r;
+	if (config.frame_shift != 0)
+		return align_3frame(targets, cfg.query->translated(query_block_id), query_seq, flags, hsp_values, mode);
 	r.reserve(targets.size());
 	size_t cbs_targets = 0;
 
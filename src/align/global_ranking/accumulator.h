@@ -0,0 +1,54 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2012-2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <vector>
+#include "search/hit.h"
+#include "util/memory/governor.h"
+
+namespace Search {
+	struct Config;
+}
+
+namespace Extension { namespace GlobalRanking {
+
+// Per-thread buffer of stage 1 hits in global ranking mode. Whenever it fills up, the hits are
+// re-extended and merged into the per-query top-K ranking table, so memory stays bounded by
+// threads x capacity + queries x K instead of growing with the total seed hit count.
+struct HitAccumulator {
+
+	HitAccumulator(const Search::Config& cfg);
+	void write(const Search::Hit& hit) {
+		buf_.push_back(hit);
+		if (buf_.size() >= CAPACITY)
+			flush();
+	}
+	void flush();
+
+private:
+
+	static const size_t CAPACITY = 1 << 20;
+
+	const Search::Config& cfg_;
+	std::vector<Search::Hit> buf_;
+	Util::Memory::Reservation memory_;
+
+};
+
+}}
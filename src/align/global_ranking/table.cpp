@@ -17,11 +17,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ****/
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <mutex>
 #include "global_ranking.h"
-#define _REENTRANT
-#include "ips4o/ips4o.hpp"
+#include "accumulator.h"
 #include "search/hit.h"
-#include "util/data_structures/deque.h"
 #include "util/util.h"
 #include "util/algo/algo.h"
 #include "dp/ungapped.h"
@@ -29,16 +28,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "../load_hits.h"
 
 using std::endl;
-using std::thread;
 using std::pair;
 using std::vector;
-using SeedHits = Search::Config::RankingBuffer;
+using std::mutex;
+using std::lock_guard;
+using std::atomic_size_t;
+using SeedHits = vector<Search::Hit>;
 
 // #define BATCH_BINSEARCH
 
 namespace Extension { namespace GlobalRanking {
 
-static void get_query_hits(SeedHits::Iterator begin, SeedHits::Iterator end, vector<Hit>& hits, Search::Config& cfg) {
+static void get_query_hits(SeedHits::iterator begin, SeedHits::iterator end, vector<Hit>& hits, const Search::Config& cfg) {
 	hits.clear();
 	const SequenceSet& target_seqs = cfg.target->seqs();
 	if (Search::keep_target_id(cfg)) {
@@ -46,7 +47,7 @@ static void get_query_hits(SeedHits::Iterator begin, SeedHits::Iterator end, vec
 		auto it = merge_keys(begin, end, get_target);
 		while (it.good()) {
 			uint16_t score = 0;
-			for (SeedHits::Iterator i = it.begin(); i != it.end(); ++i)
+			for (SeedHits::iterator i = it.begin(); i != it.end(); ++i)
 				score = std::max(score, i->score_);
 			hits.emplace_back((uint32_t)cfg.target->block_id2oid(it.key()), score, 0);
 			++it;
@@ -73,7 +74,7 @@ static void get_query_hits(SeedHits::Iterator begin, SeedHits::Iterator end, vec
 		auto it = merge_keys(begin, end, get_target);
 		while (it.good()) {
 			uint16_t score = 0;
-			for (SeedHits::Iterator i = it.begin(); i != it.end(); ++i)
+			for (SeedHits::iterator i = it.begin(); i != it.end(); ++i)
 				score = std::max(score, i->score_);
 			hits.emplace_back((uint32_t)cfg.target->block_id2oid(it.key()), score, 0);
 			++it;
@@ -110,7 +111,7 @@ static pair<int, unsigned> target_score(const FlatArray<Extension::SeedHit>::Dat
 	return { score,context };
 }
 
-static void get_query_hits_reextend(size_t source_query_block_id, SeedHits::Iterator begin, SeedHits::Iterator end, vector<Hit>& hits, Search::Config& cfg) {
+static void get_query_hits_reextend(size_t source_query_block_id, SeedHits::iterator begin, SeedHits::iterator end, vector<Hit>& hits, const Search::Config& cfg) {
 	const unsigned contexts = align_mode.query_contexts;
 	vector<Sequence> query_seq;
 	for (unsigned i = 0; i < contexts; ++i)
@@ -125,7 +126,7 @@ static void get_query_hits_reextend(size_t source_query_block_id, SeedHits::Iter
 	}
 }
 
-static void merge_hits(const size_t query, vector<Hit>& hits, vector<Hit>& merged, Search::Config& cfg, size_t& merged_count) {
+static void merge_hits(const size_t query, vector<Hit>& hits, vector<Hit>& merged, const Search::Config& cfg, size_t& merged_count) {
 	const size_t N = config.global_ranking_targets;
 	//std::sort(hits.begin(), hits.end());
 	vector<Hit>::iterator table_begin = cfg.ranking_table->begin() + query * N, table_end = table_begin + N;
@@ -144,48 +145,42 @@ static void merge_hits(const size_t query, vector<Hit>& hits, vector<Hit>& merge
 	//std::copy(merged.begin(), merged.end(), table_begin);
 }
 
-void update_table(Search::Config& cfg) {
-	SeedHits& hits = *cfg.global_ranking_buffer;
-	*log_stream << "Seed hits = " << hits.size() << endl;
-	if (hits.size() == 0)
+// Ranking table rows are guarded by striped locks since all search threads merge into the table concurrently.
+static const size_t TABLE_LOCKS = 4096;
+static mutex table_lock[TABLE_LOCKS];
+static atomic_size_t seed_hit_count(0), merged_target_count(0);
+
+HitAccumulator::HitAccumulator(const Search::Config& cfg):
+	cfg_(cfg),
+	memory_(Util::Memory::Pool::GLOBAL_RANKING, int64_t(CAPACITY * sizeof(Search::Hit)))
+{
+	buf_.reserve(CAPACITY);
+}
+
+void HitAccumulator::flush() {
+	if (buf_.empty())
 		return;
-	TaskTimer timer("Sorting seed hits");
-#if _MSC_FULL_VER == 191627042
-	merge_sort(hits.begin(), hits.end(), config.threads_, Search::Hit::CmpQueryTarget());
-#else
-	ips4o::parallel::sort(hits.begin(), hits.end(), Search::Hit::CmpQueryTarget(), config.threads_);
-#endif
-	timer.go("Creating partition");
-	auto p = Util::Algo::partition_table(hits.begin(), hits.end(), config.threads_ * 8, ::Search::Hit::SourceQuery{ align_mode.query_contexts });
-	timer.go("Processing seed hits");
-	std::atomic_size_t merged_count(0), next(0);
-	auto worker = [&cfg, &merged_count, &next, &p]() {
-		vector<Hit> hits, merged;
-		while (true) {
-			auto i = next++;
-			if (i + 1 >= p.size())
-				break;
-			auto begin = p[i], end = p[i + 1];
-			auto it = merge_keys(begin, end, ::Search::Hit::SourceQuery{ align_mode.query_contexts });
-			size_t n = 0;
-			while (it.good()) {
-				const size_t query = it.begin()->query_ / align_mode.query_contexts;
-				get_query_hits_reextend(query, it.begin(), it.end(), hits, cfg);
-				merge_hits(query, hits, merged, cfg, n);
-				++it;
-			}
-			merged_count += n;
+	seed_hit_count += buf_.size();
+	std::sort(buf_.begin(), buf_.end(), Search::Hit::CmpQueryTarget());
+	vector<Hit> hits, merged;
+	size_t n = 0;
+	auto it = merge_keys(buf_.begin(), buf_.end(), ::Search::Hit::SourceQuery{ align_mode.query_contexts });
+	while (it.good()) {
+		const size_t query = it.begin()->query_ / align_mode.query_contexts;
+		get_query_hits_reextend(query, it.begin(), it.end(), hits, cfg_);
+		{
+			lock_guard<mutex> lock(table_lock[query % TABLE_LOCKS]);
+			merge_hits(query, hits, merged, cfg_, n);
 		}
-	};
-	vector<thread> threads;
-	for (int i = 0; i < config.threads_; ++i)
-		threads.emplace_back(worker);
-	for (thread& t : threads)
-		t.join();
-	timer.go("Deallocating seed hit list");
-	cfg.global_ranking_buffer.reset();
-	timer.finish();
-	*log_stream << "Merged targets = " << merged_count << endl;
+		++it;
+	}
+	merged_target_count += n;
+	buf_.clear();
+}
+
+void update_table(Search::Config& cfg) {
+	*log_stream << "Seed hits = " << seed_hit_count.exchange(0) << endl;
+	*log_stream << "Merged targets = " << merged_target_count.exchange(0) << endl;
 }
 
-}}
\ No newline at end of file
+}}
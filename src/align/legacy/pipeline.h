@@ -1,40 +0,0 @@
-/****
-DIAMOND protein sequence aligner
-Copyright (C) 2012-2026 Benjamin J. Buchfink
-
-This program is free software: you can redistribute it and/or modify
-it under the terms of the GNU General Public License as published by
-the Free Software Foundation, either version 3 of the License, or
-(at your option) any later version.
-
-This program is distributed in the hope that it will be useful,
-but WITHOUT ANY WARRANTY; without even the implied warranty of
-MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-GNU General Public License for more details.
-
-You should have received a copy of the GNU General Public License
-along with this program.  If not, see <http://www.gnu.org/licenses/>.
-****/
-// SPDX-License-Identifier: GPL-3.0-or-later
-
-#pragma once
-#include "query_mapper.h"
-#include "dp/dp.h"
-
-namespace ExtensionPipeline {
-	namespace BandedSwipe {
-		struct Target;
-		struct Pipeline : public QueryMapper
-		{
-			Pipeline(size_t query_id, Search::Hit* begin, Search::Hit* end, DpStat& dp_stat, const Search::Config& cfg) :
-				QueryMapper(query_id, begin, end, cfg),
-				dp_stat(dp_stat)
-			{}
-			Target& target(size_t i);
-			virtual void run(Statistics& stat, const Search::Config& cfg) override;
-			void run_swipe(bool score_only);
-			void range_ranking(const int64_t max_target_seqs);
-			DpStat& dp_stat;
-		};
-	}
-}
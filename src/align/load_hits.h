@@ -60,7 +60,7 @@ static SeedHitList load_hits(It begin, It end, const SequenceSet& ref_seqs) {
 #ifdef HIT_KEEP_TARGET_ID
 	if(true) {
 #else
-	if (std::log2(total_subjects) * hits < total_subjects / 10) {
+	if (ref_seqs.has_position_index() || std::log2(total_subjects) * hits < total_subjects / 10) {
 #endif
 		for (auto i = begin; i < end; ++i) {
 #ifdef HIT_KEEP_TARGET_ID
@@ -32,6 +32,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util/sequence/translate.h"
 #include "masking/masking.h"
 #include "util/system/system.h"
+#include "util/memory/governor.h"
 #include "util/simd.h"
 #include "search/search.h"
 #include "stats/cbs.h"
@@ -150,7 +151,7 @@ CompressionLib Config::compressor() const
 {
 	if (compression.empty() || compression == "0")
 		return CompressionLib::NONE;
-	else if (compression == "1")
+	else if (compression == "1" || compression == "bgzf")
 		return CompressionLib::ZLIB;
 	else if (compression == "zstd")
 		return CompressionLib::ZSTD;
@@ -165,7 +166,7 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
 	double cbs_angle;
 
 	parser.add_command("makedb", "Build DIAMOND database from a FASTA file", makedb)
-		.add_command("prepdb", "", prep_db)
+		.add_command("prepdb", "Build the accession index of a DIAMOND database", prep_db)
 		.add_command("blastp", "Align amino acid query sequences against a protein reference database", blastp)
 		.add_command("blastx", "Align DNA query sequences against a protein reference database", blastx)
 		.add_command("cluster", "Cluster protein sequences", cluster)
@@ -185,6 +186,7 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
 		.add_command("roc", "", roc)
 		.add_command("benchmark", "", benchmark)
 		.add_command("deepclust", "", DEEPCLUST)
+		.add_command("coordinator", "Serve the synchronization of distributed runs (--coordinator)", COORDINATOR)
 #ifdef EXTRA
 		.add_command("random-seqs", "", random_seqs)
 		.add_command("sort", "", sort)
@@ -213,7 +215,7 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
 #endif
 		;
 
-	auto& general = parser.add_group("General options", { makedb, blastp, blastx, cluster, view, getseq, dbinfo, makeidx, CLUSTER_REALIGN, GREEDY_VERTEX_COVER, DEEPCLUST, RECLUSTER, MERGE_DAA, LINCLUST, CLUSTER_REASSIGN });
+	auto& general = parser.add_group("General options", { makedb, prep_db, blastp, blastx, cluster, view, getseq, dbinfo, makeidx, CLUSTER_REALIGN, GREEDY_VERTEX_COVER, DEEPCLUST, RECLUSTER, MERGE_DAA, LINCLUST, CLUSTER_REASSIGN, benchmark });
 	general.add()
 		("threads", 'p', "number of CPU threads", threads_)
 		("log", 0, "enable debug log", debug_log)
@@ -221,11 +223,11 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
 		("tmpdir", 't', "directory for temporary files", tmpdir)
 		("keep-temp-files", 0, "do not delete temporarary files", keep_temp_files);
 
-	auto& general_db = parser.add_group("General/database options", { makedb, blastp, blastx, cluster, getseq, dbinfo, makeidx, CLUSTER_REALIGN, GREEDY_VERTEX_COVER, DEEPCLUST, RECLUSTER, LINCLUST, CLUSTER_REASSIGN });
+	auto& general_db = parser.add_group("General/database options", { makedb, prep_db, blastp, blastx, cluster, getseq, dbinfo, makeidx, CLUSTER_REALIGN, GREEDY_VERTEX_COVER, DEEPCLUST, RECLUSTER, LINCLUST, CLUSTER_REASSIGN });
 	general_db.add()
 		("db", 'd', "database file", database);
 
-	auto& general_out = parser.add_group("General/output", { blastp, blastx, cluster, view, getseq, CLUSTER_REALIGN, GREEDY_VERTEX_COVER, DEEPCLUST, RECLUSTER, MERGE_DAA, LINCLUST, CLUSTER_REASSIGN });
+	auto& general_out = parser.add_group("General/output", { blastp, blastx, cluster, view, getseq, CLUSTER_REALIGN, GREEDY_VERTEX_COVER, DEEPCLUST, RECLUSTER, MERGE_DAA, LINCLUST, CLUSTER_REASSIGN, benchmark });
 	general_out.add()
 		("out", 'o', "output file", output_file);
 
@@ -236,7 +238,13 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
     string dbstring;
 	auto& makedb_opt = parser.add_group("Makedb options", { makedb, MERGE_DAA });
 	makedb_opt.add()
-		("in", 0, "input reference file in FASTA format/input DAA files for merge-daa", input_ref_file);
+		("in", 0, "input reference file in FASTA format/input DAA files for merge-daa", input_ref_file)
+		("append", 0, "append the input sequences to an existing database as a new volume", append_db)
+		("remove-oids", 0, "file of OIDs to mark as removed when appending to a database", remove_oids);
+
+	auto& makedb_prepdb_opt = parser.add_group("Makedb/prepdb options", { makedb, prep_db });
+	makedb_prepdb_opt.add()
+		("precompute-masking", 0, "store the masking intervals of the given algorithms in the database (tantan, seg)", precompute_masking);
 
 	auto& makedb_tax_opt = parser.add_group("Makedb/taxon options", { makedb });
 	makedb_tax_opt.add()
@@ -295,7 +303,7 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
 		("unal", 0, "report unaligned queries (0=no, 1=yes)", report_unaligned, -1)
 		("max-hsps", 0, "maximum number of HSPs per target sequence to report for each query (default=1)", max_hsps, 1u)
 		("range-culling", 0, "restrict hit culling to overlapping query ranges", query_range_culling)
-		("compress", 0, "compression for output files (0=none, 1=gzip, zstd)", compression)
+		("compress", 0, "compression for output files (0=none, 1=gzip, zstd, bgzf)", compression)
 		("min-score", 0, "minimum bit score to report alignments (overrides e-value setting)", min_bit_score)
 		("query-cover", 0, "minimum query cover% to report an alignment", query_cover)
 		("subject-cover", 0, "minimum subject cover% to report an alignment", subject_cover)
@@ -358,7 +366,7 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
 		("aln-out", 0, "Output file for clustering alignments", aln_out)
 		("reps", 0, "Output file for representative sequences in FASTA format. Only includes id and sequence (no additional header data).", reps_out);
 
-	auto& memory_opt = parser.add_group("Memory options", { cluster, RECLUSTER, CLUSTER_REASSIGN, GREEDY_VERTEX_COVER, DEEPCLUST, LINCLUST, CLUSTER_REALIGN });
+	auto& memory_opt = parser.add_group("Memory options", { blastp, blastx, blastn, cluster, RECLUSTER, CLUSTER_REASSIGN, GREEDY_VERTEX_COVER, DEEPCLUST, LINCLUST, CLUSTER_REALIGN });
 	memory_opt.add()
 		("memory-limit", 'M', "Memory limit in GB (default = 16G)", memory_limit);
 
@@ -391,9 +399,10 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
 		("ignore-warnings", 0, "Ignore warnings", ignore_warnings)
 		("no-parse-seqids", 0, "Print raw seqids without parsing", no_parse_seqids);
 
-	auto& advanced_aln_cluster = parser.add_group("Advanced options aln/cluster", { blastp, blastx, blastn, CLUSTER_REASSIGN, regression_test, cluster, DEEPCLUST, LINCLUST, RECLUSTER });
+	auto& advanced_aln_cluster = parser.add_group("Advanced options aln/cluster", { blastp, blastx, blastn, CLUSTER_REASSIGN, regression_test, cluster, DEEPCLUST, LINCLUST, RECLUSTER, COORDINATOR });
 	advanced_aln_cluster.add()
 		("parallel-tmpdir", 0, "directory for temporary files used by multiprocessing", parallel_tmpdir)
+		("coordinator", 0, "address of the coordinator process for distributed runs (host:port or unix:path)", coordinator)
 		("bin", 0, "number of query bins for seed search", query_bins)
 		("ext-chunk-size", 0, "chunk size for adaptive ranking (default=auto)", ext_chunk_size)
 		("no-ranking", 0, "disable ranking heuristic", no_ranking)
@@ -421,6 +430,15 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
 		("freq-sd", 0, "number of standard deviations for ignoring frequent seeds", freq_sd_, 0.0)
 		("sketch-size", 0, "Subsample seeds based on minimizer sketch of the given size", sketch_size)
 		("tile-size", 0, "Loop tiling size (default=1024)", tile_size, (uint32_t)1024)
+		("numa", 0, "NUMA-aware placement of reference sequences and seed arrays", numa)
+		("huge-pages", 0, "huge pages for seed arrays and hit buffers (0=off, 1=transparent, 2=explicit with fallback)", huge_pages, 1)
+		("shape-batch", 0, "maximum number of seed shapes indexed in one pass over the sequences (0=as many as fit into --memory-limit)", shape_batch, 1)
+		("stream", 0, "stream query input in micro-batches against a resident reference", stream_queries)
+		("stream-batch", 0, "maximum number of query letters per streaming micro-batch (default=1000000)", stream_batch, INT64_C(1000000))
+		("stream-deadline", 0, "maximum seconds a streamed query waits before its micro-batch is searched (default=1.0)", stream_deadline, 1.0)
+		("trace-events", 0, "write a timeline of pipeline phases and worker threads in Chrome/Perfetto trace event format", trace_events)
+		("perf-counters", 0, "report hardware performance counters per pipeline phase", perf_counters)
+		("checkpoint", 0, "directory for resuming an interrupted blocked run", checkpoint)
 		("id2", 0, "minimum number of identities for stage 1 hit", min_identities_)
 		("linsearch", 0, "only consider seed hits against longest target for identical seeds", lin_stage1_target)
 		("lin-stage1", 0, "only consider seed hits against longest query for identical seeds", lin_stage1_query)
@@ -430,6 +448,7 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
 		("ungapped-evalue-short", 0, "E-value threshold for ungapped filter (short reads) (auto)", ungapped_evalue_short_, -1.0)
 		("short-query-ungapped-bitscore", 0, "Bit score threshold for ungapped alignments for short queries", short_query_ungapped_bitscore, 25.0)
 		("gapped-filter-evalue", 0, "E-value threshold for gapped filter (auto)", gapped_filter_evalue_, -1.0)
+		("evalue-table-error", 0, "maximum relative error of table-driven e-value evaluation, 0=exact (default=1e-5)", evalue_table_error, 1e-5)
 		("band", 0, "band for dynamic programming computation", padding)
 		("shape-mask", 0, "seed shapes", shape_mask)
 		("multiprocessing", 0, "enable distributed-memory parallel processing", multiprocessing)
@@ -481,7 +500,17 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
 
 	auto& view_options = parser.add_group("View options", { view });
 	view_options.add()
-		("forwardonly", 0, "only show alignments of forward strand", forwardonly);
+		("forwardonly", 0, "only show alignments of forward strand", forwardonly)
+		("daa-records", 0, "range of query records to show (first-last, zero-based)", daa_records);
+
+	auto& benchmark_options = parser.add_group("Benchmark options", { benchmark });
+	benchmark_options.add()
+		("bench-length", 0, "length of the synthetic sequences (default=300)", bench_length, (Loc)300)
+		("bench-identity", 0, "identity of the synthetic homologs in percent (default=60)", bench_identity, 60.0)
+		("bench-reps", 0, "number of timed repetitions per kernel (default=5)", bench_reps, 5)
+		("bench-seed", 0, "random seed for the synthetic data (default=1)", bench_seed, UINT64_C(1))
+		("bench-compare", 0, "compare two result files of the benchmark (baseline, candidate)", bench_compare)
+		("bench-tolerance", 0, "relative slowdown reported as a regression (default=0.05)", bench_tolerance, 0.05);
 
 	auto& getseq_options = parser.add_group("Getseq options", { getseq });
 	getseq_options.add()
@@ -723,8 +752,6 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
 				output_file = daa_file;
 			}
 			if (daa_file.length() > 0 || (output_format.size() > 0 && (output_format[0] == "daa" || output_format[0] == "100"))) {
-				if (!compression.empty())
-					throw runtime_error("Compression is not supported for DAA format.");
 				if (!no_auto_append)
 					auto_append_extension(output_file, ".daa");
 			}
@@ -768,9 +795,10 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
 			auto_append_extension(database, ".dmnd");
 		if (command == Config::view)
 			auto_append_extension(daa_file, ".daa");
-		if (compression == "1")
+		const bool daa_output = command != Config::view && (daa_file.length() > 0 || (!output_format.empty() && (output_format[0] == "daa" || output_format[0] == "100")));
+		if ((compression == "1" || compression == "bgzf") && !daa_output)
 			auto_append_extension(output_file, ".gz");
-		if (compression == "zstd")
+		if (compression == "zstd" && !daa_output)
 			auto_append_extension(output_file, ".zst");
 	}
 
@@ -779,6 +807,11 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
 	*log_stream << "Assertions enabled." << endl;
 #endif
 	set_option(threads_, (int)std::thread::hardware_concurrency());
+	if (!trace_events.empty() && !Trace::enabled)
+		Trace::open(trace_events);
+	if (perf_counters && !Util::Perf::enabled)
+		Util::Perf::open();
+	Util::Memory::init_governor(Util::String::interpret_number(memory_limit.get(DEFAULT_MEMORY_LIMIT)), memory_limit.present());
 
 	switch (command) {
 	case Config::makedb:
@@ -808,6 +841,7 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
 	case Config::opt:
 	case Config::mask:
 	case Config::makedb:
+	case Config::prep_db:
 	case Config::cluster:
 	case Config::DEEPCLUST:
 	case Config::LINCLUST:
@@ -901,6 +935,9 @@ Config::Config(int argc, const char **argv, bool check_io, CommandLineParser& pa
 	if (query_range_culling && taxon_k != 0)
 		throw runtime_error("--taxon-k is not supported for --range-culling mode.");
 
+	if (command == COORDINATOR && coordinator.empty())
+		throw runtime_error("The coordinator command requires setting --coordinator");
+
 	if (multiprocessing && parallel_tmpdir.empty())
 		throw runtime_error("--multiprocessing requires setting --parallel-tmpdir");
 	
@@ -102,6 +102,7 @@ struct Config
 	unsigned	compress_temp;
 	Option<double>	toppercent;
 	string	daa_file;
+	string	daa_records;
 	string_vector	output_format;
 	string	output_file;
 	bool		forwardonly;
@@ -248,6 +249,7 @@ struct Config
 	size_t query_count;
 	double cbs_err_tolerance;
 	int cbs_it_limit;
+	double evalue_table_error;
 	double query_match_distance_threshold;
 	double length_ratio_threshold;
 	bool hash_join_swap;
@@ -283,6 +285,9 @@ struct Config
 	Loc sketch_size;
 	string soft_masking;
 	string oid_list;
+	bool append_db;
+	std::vector<std::string> precompute_masking;
+	string remove_oids;
 	int64_t bootstrap_block;
 	int64_t centroid_factor;
 	int timeout;
@@ -358,6 +363,22 @@ struct Config
 	bool linclust_banded_ext;
 	Loc min_query_len;
 	bool hit_membuf;
+	bool numa;
+	int huge_pages;
+	int shape_batch;
+	bool stream_queries;
+	int64_t stream_batch;
+	double stream_deadline;
+	std::string trace_events;
+	bool perf_counters;
+	std::string checkpoint;
+	std::string coordinator;
+	Loc bench_length;
+	double bench_identity;
+	int bench_reps;
+	uint64_t bench_seed;
+	double bench_tolerance;
+	string_vector bench_compare;
 	size_t minichunk;
 	std::string aln_out;
 	std::string reps_out;
@@ -381,7 +402,7 @@ struct Config
 		smith_waterman = 26, cluster = 27, simulate_seqs = 31, split = 32, upgma = 33, upgma_mc = 34, regression_test = 35,
 		reverse_seqs = 36, compute_medoids = 37, mutate = 38, rocid = 40, makeidx = 41, find_shapes, prep_db, HASH_SEQS, LIST_SEEDS, CLUSTER_REALIGN,
 		GREEDY_VERTEX_COVER, CLUSTER_REASSIGN, blastn, RECLUSTER, MERGE_DAA, DEEPCLUST, LINCLUST, WORD_COUNT, CUT, MODEL_SEQS,
-		MAKE_SEED_TABLE
+		MAKE_SEED_TABLE, COORDINATOR
 	};
 
 	unsigned command;
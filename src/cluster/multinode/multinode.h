@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util/string/string.h"
 #include "util/parallel/filestack.h"
 #include "util/parallel/atomic.h"
+#include "util/parallel/coordinator.h"
 #include "util/system/system.h"
 #include "volume.h"
 
@@ -61,7 +62,10 @@ struct Job {
 		//log("Cleaning up");
 		log_file_.reset();
 		for (const auto& file : sync_files_) {
-			remove_tmp_file(file);
+			if (Coordinator::enabled())
+				Coordinator::erase(file);
+			if (!Coordinator::enabled() || exists(file))
+				remove_tmp_file(file);
 		}
 		for (auto it = temp_dirs_.rbegin(); it != temp_dirs_.rend(); ++it) {
 			rmdir(*it);
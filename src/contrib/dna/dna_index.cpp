@@ -28,6 +28,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <queue>
 #include <numeric>
 #include "../util/util.h"
+#include "util/memory/huge_pages.h"
 //#include "google/protobuf/arena.h"
 
 using std::atomic;
@@ -59,7 +60,7 @@ namespace Dna {
     build_index(range,filter_repetitive(range));
 }
 
-Index::~Index() { delete[] ref_buffer_; }
+Index::~Index() { Util::Memory::huge_free(ref_buffer_); }
 
 pair<SeedArray::Entry *, SeedArray::Entry *> Index::contains(PackedSeed seed) const {
     unsigned partition = seed_partition(seed);
@@ -41,16 +41,16 @@ using std::pair;
 BlastDB::BlastDB(const string& file_name, Flags flags, const ValueTraits& value_traits) :
 	SequenceFile(Type::BLAST, flags, FormatFlags::SEEKABLE | FormatFlags::LENGTH_LOOKUP | FormatFlags::DICT_LENGTHS | FormatFlags::DICT_SEQIDS, value_traits),
 	file_name_(file_name),
-	pal_(file_name),
+	pal_(file_name, value_traits.seq_type),
 	taxon_db_(nullptr),
 	oid_(0),
 	long_seqids_(false),
-	volume_(pal_.volumes[0], 0, pal_.oid_index[0], pal_.oid_index[1], true),
+	volume_(pal_.volumes[0], 0, pal_.oid_index[0], pal_.oid_index[1], true, value_traits.seq_type),
 	raw_chunk_no_(0)
 {
 	for (const string& volume : pal_.volumes) {
-		disk_size_ += file_size((volume + ".psq").c_str());
-		disk_size_ += file_size((volume + ".phr").c_str());
+		disk_size_ += file_size((volume + blastdb_extension(pal_.type, "sq")).c_str());
+		disk_size_ += file_size((volume + blastdb_extension(pal_.type, "hr")).c_str());
 	}
 	std::ostringstream ss;
 	ss << "BLAST database file size: " << disk_size_ << endl;
@@ -149,7 +149,7 @@ void BlastDB::open_volume(OId oid) {
 	if (oid >= volume_.begin && oid < volume_.end)
 		return;
 	const int idx = pal_.volume(oid);
-	volume_ = BlastVolume(pal_.volumes[idx], idx, pal_.oid_index[idx], pal_.oid_index[idx + 1], true);
+	volume_ = BlastVolume(pal_.volumes[idx], idx, pal_.oid_index[idx], pal_.oid_index[idx + 1], true, pal_.type);
 }
 
 void BlastDB::print_info() const {
@@ -235,10 +235,9 @@ void BlastDB::read_seq_data(Letter* dst, size_t len, size_t& pos, bool seek)
 	*(dst + len) = Sequence::DELIMITER;
 	open_volume(pos);
 	const uint32_t volume_oid = uint32_t(pos - volume_.begin);
-	const vector<Letter> seq = volume_.sequence(volume_oid);
-	if (seq.size() != len)
+	if ((size_t)volume_.length(volume_oid) != len)
 		throw runtime_error("BLAST database sequence length mismatch for OID " + std::to_string(pos));
-	copy(seq.begin(), seq.end(), dst);
+	volume_.sequence(volume_oid, dst);
 	++pos;
 }
 
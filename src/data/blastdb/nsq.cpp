@@ -0,0 +1,110 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include "volume.h"
+#include "util/simd.h"
+
+using std::runtime_error;
+
+// NCBI4na codes of ambiguous residues. Only the unambiguous bases map to a nucleotide, everything else becomes N.
+static const Letter NA4_TO_STD[16] = { 4, 0, 1, 4, 2, 4, 4, 4, 3, 4, 4, 4, 4, 4, 4, 4 };
+
+// The four bases of each NCBI2na byte, first base in the high bits.
+struct Na2Table {
+	Na2Table() {
+		for (int i = 0; i < 256; ++i)
+			for (int j = 0; j < 4; ++j)
+				v[i][j] = Letter((i >> (6 - 2 * j)) & 3);
+	}
+	Letter v[256][4];
+};
+
+static const Na2Table na2_table;
+
+static uint32_t read_be32(const char* p) {
+	const uint8_t* u = (const uint8_t*)p;
+	return (uint32_t(u[0]) << 24) | (uint32_t(u[1]) << 16) | (uint32_t(u[2]) << 8) | uint32_t(u[3]);
+}
+
+Loc nucleotide_length(const char* packed, size_t packed_len) {
+	if (packed_len == 0)
+		return 0;
+	return Loc(packed_len - 1) * 4 + (packed[packed_len - 1] & 3);
+}
+
+static void unpack_na2(const char* src, size_t n, Letter* dst) {
+	size_t i = 0;
+#ifdef __SSE2__
+	const __m128i mask = _mm_set1_epi8(3);
+	for (; i + 16 <= n; i += 16) {
+		const __m128i x = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i b0 = _mm_and_si128(_mm_srli_epi16(x, 6), mask), b1 = _mm_and_si128(_mm_srli_epi16(x, 4), mask),
+			b2 = _mm_and_si128(_mm_srli_epi16(x, 2), mask), b3 = _mm_and_si128(x, mask);
+		const __m128i lo01 = _mm_unpacklo_epi8(b0, b1), hi01 = _mm_unpackhi_epi8(b0, b1),
+			lo23 = _mm_unpacklo_epi8(b2, b3), hi23 = _mm_unpackhi_epi8(b2, b3);
+		__m128i* out = (__m128i*)(dst + 4 * i);
+		_mm_storeu_si128(out, _mm_unpacklo_epi16(lo01, lo23));
+		_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo01, lo23));
+		_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi01, hi23));
+		_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi01, hi23));
+	}
+#endif
+	for (; i < n; ++i)
+		std::copy(na2_table.v[(uint8_t)src[i]], na2_table.v[(uint8_t)src[i]] + 4, dst + 4 * i);
+}
+
+void decode_nucleotide_sequence(const char* packed, size_t packed_len, const char* amb, size_t amb_len, Letter* dst) {
+	if (packed_len == 0)
+		return;
+	const Loc len = nucleotide_length(packed, packed_len);
+	unpack_na2(packed, packed_len - 1, dst);
+	const uint8_t last = (uint8_t)packed[packed_len - 1];
+	std::copy(na2_table.v[last], na2_table.v[last] + (last & 3), dst + 4 * (packed_len - 1));
+
+	if (amb_len < 4)
+		return;
+	const uint32_t header = read_be32(amb);
+	const bool new_format = (header & 0x80000000u) != 0;
+	const size_t words = header & 0x7fffffffu;
+	if ((words + 1) * 4 > amb_len)
+		throw runtime_error("Invalid ambiguity data in nucleotide sequence");
+	for (size_t i = 1; i <= words; ++i) {
+		const uint32_t w = read_be32(amb + 4 * i);
+		const Letter residue = NA4_TO_STD[w >> 28];
+		size_t run, pos;
+		if (new_format) {
+			if (i == words)
+				throw runtime_error("Invalid ambiguity data in nucleotide sequence");
+			run = ((w >> 16) & 0xfff) + 1;
+			pos = read_be32(amb + 4 * ++i);
+		}
+		else {
+			run = ((w >> 24) & 0xf) + 1;
+			pos = w & 0xffffff;
+		}
+		if (pos + run > (size_t)len)
+			throw runtime_error("Invalid ambiguity data in nucleotide sequence");
+		std::fill(dst + pos, dst + pos + run, residue);
+	}
+}
+
+Loc BlastVolume::packed_length(uint32_t oid) const {
+	return Loc(index_.ambiguity_index[oid] - index_.sequence_index[oid]) * 4;
+}
@@ -59,7 +59,7 @@ static vector<string> split_whitespace(const std::string& text)
 }
 
 vector<string>::iterator Pal::recurse(const string& path, vector<string>::iterator volume_it) {
-	Pal pal(path);
+	Pal pal(path, type);
 	const auto index = std::distance(volumes.begin(), volume_it);
     volumes.insert(volume_it, pal.volumes.begin(), pal.volumes.end());
 	    
@@ -81,15 +81,18 @@ vector<string>::iterator Pal::recurse(const string& path, vector<string>::iterat
 	return volumes.begin() + index + pal.volumes.size();
 }
 
-Pal::Pal(const string& path) {
+Pal::Pal(const string& path, SequenceType type):
+    type(type)
+{
+    const string alias_ext = blastdb_extension(type, "al");
 	const set<string> supported_keys = { "TITLE", "MEMB_BIT", "SEQIDLIST", "NSEQ", "LENGTH", "TAXIDLIST" };
     string db_dir, file;
     tie(db_dir, file) = absolute_path(path);
-    if (!exists(path + ".pal") && !ends_with(path, ".pal")) {
+    if (!exists(path + alias_ext) && !ends_with(path, alias_ext.c_str())) {
 		volumes.push_back(db_dir + PATH_SEPARATOR + file);
     }
     else {
-        const string pal_path = ends_with(path, ".pal") ? path : path + ".pal";
+        const string pal_path = ends_with(path, alias_ext.c_str()) ? path : path + alias_ext;
         std::ifstream in(pal_path);
         if (!in)
             throw runtime_error("Unable to open PAL file: " + pal_path);
@@ -151,7 +154,7 @@ Pal::Pal(const string& path) {
             it = recurse(is_absolute_path(nested) ? nested : db_dir + PATH_SEPARATOR + nested, it);
         }
         else {
-            BlastVolume vol(*it, 0, 0, 0, false);
+            BlastVolume vol(*it, 0, 0, 0, false, type);
             sequence_count += vol.index().num_oids;
             oid_index.push_back(vol.index().num_oids + oid_index.back());
             letters += vol.index().total_length;
@@ -31,7 +31,8 @@ struct Pal {
 	OId sequence_count;
 	uint64_t letters;
 	int version;
-	Pal(const std::string& path);
+	SequenceType type;
+	Pal(const std::string& path, SequenceType type = SequenceType::amino_acid);
 private:
 	std::vector<std::string>::iterator recurse(const std::string& path, std::vector<std::string>::iterator volume_it);
 };
\ No newline at end of file
@@ -66,22 +66,26 @@ PinIndex BlastVolume::ParsePinFile(File& mapping, bool load_index)
         index.sequence_index.push_back(ReadBE32(mapping));
 
     if (!index.is_protein) {
-        //reserve_offset_array(index.ambiguity_offsets_offset);
+        index.ambiguity_index.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            index.ambiguity_index.push_back(ReadBE32(mapping));
     }
 
     return index;
 }
 
-BlastVolume::BlastVolume(const string& path, int idx, OId begin, OId end, bool load_index) :
+BlastVolume::BlastVolume(const string& path, int idx, OId begin, OId end, bool load_index, SequenceType type) :
     idx(idx),
     begin(begin),
     end(end),
-    phr_mapping_(path + ".phr", "rb"),
-    psq_mapping_(path + ".psq", "rb")    
+    phr_mapping_(path + blastdb_extension(type, "hr"), "rb"),
+    psq_mapping_(path + blastdb_extension(type, "sq"), "rb")    
 {
-	File pin(path + ".pin", "rb");
+	File pin(path + blastdb_extension(type, "in"), "rb");
     index_ = BlastVolume::ParsePinFile(pin, load_index);
-    pin.close();        
+    pin.close();
+    if (index_.is_protein != (type == SequenceType::amino_acid))
+        throw runtime_error("BLAST database volume " + path + " does not contain " + (index_.is_protein ? "nucleotide" : "protein") + " sequences.");
 }
 
 BlastVolume::RawChunk* BlastVolume::raw_chunk(size_t letters, SequenceFile::Flags flags) {
@@ -99,7 +103,7 @@ BlastVolume::RawChunk* BlastVolume::raw_chunk(size_t letters, SequenceFile::Flag
     uint32_t end = begin;
     size_t l = 0;
     while (end < index_.num_oids && l < letters) {
-        l += length(end);
+        l += index_.is_protein ? length(end) : packed_length(end);
         ++end;
     }
     RawChunk* chunk = new RawChunk();
@@ -115,6 +119,8 @@ BlastVolume::RawChunk* BlastVolume::raw_chunk(size_t letters, SequenceFile::Flag
     }
     if (bool(flags & SequenceFile::Flags::SEQS)) {
         chunk->seq_index.assign(index_.sequence_index.begin() + seq_ptr_, index_.sequence_index.begin() + seq_ptr_ + n + 1);
+        if (!index_.is_protein)
+            chunk->amb_index.assign(index_.ambiguity_index.begin() + seq_ptr_, index_.ambiguity_index.begin() + seq_ptr_ + n);
         chunk->seq_data = raw_sequence(n);
     }
     return chunk;
@@ -150,7 +156,9 @@ DecodedPackage* BlastVolume::RawChunk::decode(SequenceFile::Flags flags, const B
         pkg->block.seqs_.reserve(n, seq_data.size());
     if (titles)
         pkg->block.ids_.reserve(n, phr_data.size());
-    vector<Letter> seq_buf;
+    const bool bulk_seqs = seqs && !filter && !accs && seq_type == SequenceType::amino_acid;
+    if (bulk_seqs)
+        decode_protein_sequences(seq_data.data(), seq_index.data(), n, pkg->block.seqs_);
     for (size_t i = 0; i < n; ++i) {
         const OId oid = begin_ + i;
         bool f = !filter || filter->get(oid);
@@ -177,12 +185,18 @@ DecodedPackage* BlastVolume::RawChunk::decode(SequenceFile::Flags flags, const B
             phr_ptr += lhdr;
         }
            
-        if (seqs) {
+        if (seqs && !bulk_seqs) {
             const size_t lseq = seq_index[i + 1] - seq_index[i];
-            if (f) {
-                decode_protein_sequence(seq_ptr, lseq, seq_buf);
-                pkg->block.seqs_.push_back(seq_buf.begin(), seq_buf.end());
+            if (f && seq_type == SequenceType::nucleotide) {
+                const size_t lpacked = amb_index[i] - seq_index[i];
+                const Loc len = nucleotide_length(seq_ptr, lpacked);
+                const Loc offsets[] = { 0, len + 1 };
+                Letter* dst = pkg->block.seqs_.append_raw(offsets, offsets + 2);
+                decode_nucleotide_sequence(seq_ptr, lpacked, seq_ptr + lpacked, lseq - lpacked, dst);
+                dst[len] = Sequence::DELIMITER;
             }
+            else if (f)
+                decode_protein_sequences(seq_ptr, &seq_index[i], 1, pkg->block.seqs_);
             seq_ptr += lseq;
         }
 
@@ -33,6 +33,15 @@ using std::runtime_error;
     return raw_len - trim;
 }*/
 
+void decode_protein_sequence(const char* data, size_t len, Letter* dst)
+{
+    const int64_t separators = translate_ncbistdaa(data, (int64_t)len, dst);
+    if (separators < 0)
+        throw runtime_error("Invalid amino acid code in sequence data");
+    if (separators > 0)
+        throw runtime_error("Unexpected null terminator in sequence data");
+}
+
 void decode_protein_sequence(const char* data, size_t len, vector<Letter>& out)
 {
     size_t begin = 0, end = len;
@@ -41,15 +50,21 @@ void decode_protein_sequence(const char* data, size_t len, vector<Letter>& out)
     if (end > begin && data[end - 1] == '\0')
         --end;
 
-    out.clear();
-    for (size_t i = begin; i < end; ++i) {
-        const uint8_t aa = data[i];
-        if (aa == '\0')
-            throw runtime_error("Unexpected null terminator in sequence data");
-        if (aa >= sizeof(NCBI_TO_STD) / sizeof(NCBI_TO_STD[0]))
-            throw runtime_error("Invalid amino acid code in sequence data");
-        out.push_back(NCBI_TO_STD[aa]);
-    }
+    out.resize(end - begin);
+    decode_protein_sequence(data + begin, end - begin, out.data());
+}
+
+void decode_protein_sequences(const char* data, const uint32_t* index, size_t count, SequenceSet& dst)
+{
+    if (count == 0)
+        return;
+    const size_t len = index[count] - index[0];
+    Letter* ptr = dst.append_raw(index, index + count + 1);
+    if (translate_ncbistdaa(data, (int64_t)len, ptr) != (int64_t)count)
+        throw runtime_error("Invalid amino acid code or null terminator in sequence data");
+    for (size_t i = 1; i <= count; ++i)
+        if (data[index[i] - index[0] - 1] != '\0')
+            throw runtime_error("Missing null terminator in sequence data");
 }
 
 vector<Letter> decode_protein_sequence(const char* data, size_t len)
@@ -69,17 +84,43 @@ vector<Letter> BlastVolume::sequence(uint32_t oid)
     const uint32_t start = index_.sequence_index[oid];
     const uint32_t end = index_.sequence_index[oid + 1];
 
+    if (oid != seq_ptr_ || psq_mapping_.tell() != (int64_t)start)
+        psq_mapping_.seek(start, SEEK_SET);
+    seq_ptr_ = oid + 1;
+    const char* data = psq_mapping_.read_bytes(end - start);
     if (!index_.is_protein) {
-        throw runtime_error("Nucleotide sequence decoding is not supported yet");
+        const size_t packed = index_.ambiguity_index[oid] - start;
+        vector<Letter> seq(nucleotide_length(data, packed));
+        decode_nucleotide_sequence(data, packed, data + packed, end - start - packed, seq.data());
+        return seq;
     }
-    if (oid != seq_ptr_)
+    return decode_protein_sequence(data, end - start);
+}
+
+void BlastVolume::sequence(uint32_t oid, Letter* dst)
+{
+    if (oid >= index_.num_oids)
+        throw out_of_range("OID exceeds number of sequences in volume");
+    const uint32_t start = index_.sequence_index[oid];
+    const uint32_t end = index_.sequence_index[oid + 1];
+    if (oid != seq_ptr_ || psq_mapping_.tell() != (int64_t)start)
         psq_mapping_.seek(start, SEEK_SET);
     seq_ptr_ = oid + 1;
-    return decode_protein_sequence(psq_mapping_.read_bytes(end - start), end - start);
+    const char* data = psq_mapping_.read_bytes(end - start);
+    if (!index_.is_protein) {
+        const size_t packed = index_.ambiguity_index[oid] - start;
+        decode_nucleotide_sequence(data, packed, data + packed, end - start - packed, dst);
+        return;
+    }
+    if (end == start || data[end - start - 1] != '\0')
+        throw runtime_error("Missing null terminator in sequence data");
+    decode_protein_sequence(data, end - start - 1, dst);
 }
 
 vector<char> BlastVolume::raw_sequence(uint32_t count) {
     const size_t n = index_.sequence_index[seq_ptr_ + count] - index_.sequence_index[seq_ptr_];
+    if (psq_mapping_.tell() != (int64_t)index_.sequence_index[seq_ptr_])
+        psq_mapping_.seek(index_.sequence_index[seq_ptr_], SEEK_SET);
     vector<char> v(n);
     psq_mapping_.read(v.data(), n);
     seq_ptr_ += count;
@@ -89,6 +130,17 @@ vector<char> BlastVolume::raw_sequence(uint32_t count) {
 Loc BlastVolume::length(uint32_t oid) {
     const uint32_t start = index_.sequence_index[oid];
     const uint32_t end = index_.sequence_index[oid + 1];
+    if (!index_.is_protein) {
+        const uint32_t packed = index_.ambiguity_index[oid] - start;
+        if (packed == 0)
+            return 0;
+        const int64_t pos = psq_mapping_.tell();
+        uint8_t last;
+        psq_mapping_.seek(start + packed - 1, SEEK_SET);
+        psq_mapping_.read(&last, 1);
+        psq_mapping_.seek(pos, SEEK_SET);
+        return Loc(packed - 1) * 4 + (last & 3);
+    }
     return end - start - 1;
     /*const size_t raw_len = end - start;
     if (raw_len == 0)
@@ -0,0 +1,88 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include "basic/value.h"
+#include "basic/sequence.h"
+#include "util/simd.h"
+#include "util/intrin.h"
+#include "util/simd/dispatch.h"
+
+namespace DISPATCH_ARCH {
+
+static const int NCBISTDAA_CODES = 28;
+
+// NCBI_TO_STD padded to 32 entries, with the null separator mapped to the sequence delimiter.
+struct NcbiTable {
+	NcbiTable() {
+		for (int i = 0; i < 32; ++i)
+			v[i] = i < NCBISTDAA_CODES ? NCBI_TO_STD[i] : MASK_LETTER;
+		v[0] = Sequence::DELIMITER;
+	}
+	alignas(32) Letter v[32];
+};
+
+int64_t translate_ncbistdaa(const char* src, int64_t n, Letter* dst) {
+	static const NcbiTable table;
+	int64_t i = 0, separators = 0;
+	uint8_t max_code = 0;
+#if defined(__AVX2__)
+	const __m256i lo = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)table.v)),
+		hi = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)(table.v + 16))),
+		nibble = _mm256_set1_epi8(0x0f), bit4 = _mm256_set1_epi8(0x10), zero = _mm256_setzero_si256();
+	__m256i m = zero;
+	for (; i + 32 <= n; i += 32) {
+		const __m256i s = _mm256_loadu_si256((const __m256i*)(src + i)), idx = _mm256_and_si256(s, nibble);
+		const __m256i high = _mm256_cmpeq_epi8(_mm256_and_si256(s, bit4), bit4);
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_blendv_epi8(_mm256_shuffle_epi8(lo, idx), _mm256_shuffle_epi8(hi, idx), high));
+		m = _mm256_max_epu8(m, s);
+		separators += popcount32((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(s, zero)));
+	}
+	alignas(32) uint8_t max_lanes[32];
+	_mm256_store_si256((__m256i*)max_lanes, m);
+	for (int j = 0; j < 32; ++j)
+		max_code = std::max(max_code, max_lanes[j]);
+#elif defined(__SSSE3__)
+	const __m128i lo = _mm_load_si128((const __m128i*)table.v), hi = _mm_load_si128((const __m128i*)(table.v + 16)),
+		nibble = _mm_set1_epi8(0x0f), bit4 = _mm_set1_epi8(0x10), zero = _mm_setzero_si128();
+	__m128i m = zero;
+	for (; i + 16 <= n; i += 16) {
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + i)), idx = _mm_and_si128(s, nibble);
+		const __m128i high = _mm_cmpeq_epi8(_mm_and_si128(s, bit4), bit4);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(high, _mm_shuffle_epi8(hi, idx)), _mm_andnot_si128(high, _mm_shuffle_epi8(lo, idx))));
+		m = _mm_max_epu8(m, s);
+		separators += popcount32((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(s, zero)));
+	}
+	alignas(16) uint8_t max_lanes[16];
+	_mm_store_si128((__m128i*)max_lanes, m);
+	for (int j = 0; j < 16; ++j)
+		max_code = std::max(max_code, max_lanes[j]);
+#endif
+	for (; i < n; ++i) {
+		const uint8_t c = (uint8_t)src[i];
+		max_code = std::max(max_code, c);
+		separators += c == 0;
+		dst[i] = table.v[c & 31];
+	}
+	return max_code < NCBISTDAA_CODES ? separators : -1;
+}
+
+}
+
+DISPATCH_3(int64_t, translate_ncbistdaa, const char*, src, int64_t, n, Letter*, dst)
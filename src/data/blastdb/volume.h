@@ -51,10 +51,15 @@ struct PinIndex {
     uint32_t max_length = 0;
     std::vector<uint32_t> header_index;
     std::vector<uint32_t> sequence_index;
-    size_t ambiguity_offsets_offset = 0; // nucleotide only
+    std::vector<uint32_t> ambiguity_index; // nucleotide only
     size_t pin_length = 0;
 };
 
+// Returns the extension of a BLAST database file, e.g. ".psq" for protein or ".nsq" for nucleotide databases.
+inline std::string blastdb_extension(SequenceType type, const char* suffix) {
+    return std::string(".") + (type == SequenceType::amino_acid ? 'p' : 'n') + suffix;
+}
+
 std::string build_title(const std::vector<BlastDefLine>& deflines, const char* delimiter, bool all);
 std::string format_seqid(const SeqId& id);
 
@@ -80,15 +85,16 @@ public:
         }
 		virtual ~RawChunk() override = default;
         std::vector<char> seq_data, phr_data;
-		std::vector<uint32_t> seq_index, phr_index;
+		std::vector<uint32_t> seq_index, phr_index, amb_index;
         OId begin_, end_;
         size_t letters_;
     };
 
-    BlastVolume(const std::string& path, int idx, OId begin, OId end, bool load_index);
+    BlastVolume(const std::string& path, int idx, OId begin, OId end, bool load_index, SequenceType type);
     const PinIndex& index() const { return index_; }
     std::vector<BlastDefLine> deflines(uint32_t oid, bool all, bool full_titles, bool taxids);
     std::vector<Letter> sequence(uint32_t oid);
+    void sequence(uint32_t oid, Letter* dst);
     std::vector<char> raw_sequence(uint32_t count);
     std::vector<char> raw_deflines(uint32_t count);
 	Loc length(uint32_t oid);
@@ -102,6 +108,7 @@ public:
 private:
     BlastVolume(PinIndex index, File&& phr, File&& psq, int idx, OId begin, OId end);
     static PinIndex ParsePinFile(File& mapping, bool index);
+    Loc packed_length(uint32_t oid) const;
     
     PinIndex index_;
     File phr_mapping_;
@@ -112,4 +119,11 @@ private:
 
 std::vector<BlastDefLine> decode_deflines(const char* header_data, size_t len, bool all, bool full_titles, bool taxids);
 std::vector<Letter> decode_protein_sequence(const char* data, size_t len);
-void decode_protein_sequence(const char* data, size_t len, std::vector<Letter>& out);
\ No newline at end of file
+void decode_protein_sequence(const char* data, size_t len, std::vector<Letter>& out);
+void decode_protein_sequence(const char* data, size_t len, Letter* dst);
+// Decodes the null terminated sequences delimited by the .psq offsets index[0..count] in one pass.
+void decode_protein_sequences(const char* data, const uint32_t* index, size_t count, SequenceSet& dst);
+int64_t translate_ncbistdaa(const char* src, int64_t n, Letter* dst);
+// Nucleotide sequences are stored as 2-bit NCBI2na followed by runs of ambiguous NCBI4na residues.
+Loc nucleotide_length(const char* packed, size_t packed_len);
+void decode_nucleotide_sequence(const char* packed, size_t packed_len, const char* amb, size_t amb_len, Letter* dst);
\ No newline at end of file
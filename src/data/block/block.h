@@ -85,6 +85,10 @@ struct Block {
 	BlockId oid2block_id(OId i) const;
 	bool fetch_seq_if_unmasked(size_t block_id, std::vector<Letter>& seq);
 	void write_masked_seq(size_t block_id, const std::vector<Letter>& seq);
+	// Marks all sequences as masked, so that lazy masking skips them.
+	void set_masked() {
+		masked_.assign(masked_.size(), true);
+	}
 	DictId dict_id(size_t block, BlockId block_id, SequenceFile& db, const OutputFormat& format) const;
 	void soft_mask(const MaskingAlgo algo);
 	void remove_soft_masking(const int template_len, const bool add_bit_mask);
@@ -130,5 +134,6 @@ private:
 
 	friend struct SequenceFile;
 	friend struct BlastVolume;
+	friend struct QueryStream;
 
 };
\ No newline at end of file
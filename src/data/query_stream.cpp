@@ -0,0 +1,130 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2012-2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include "query_stream.h"
+
+using std::vector;
+using std::mutex;
+using std::unique_lock;
+using std::lock_guard;
+using std::runtime_error;
+using std::chrono::duration_cast;
+using std::chrono::duration;
+
+// Number of batches worth of letters the reader may queue ahead of the search.
+static const int64_t READ_AHEAD_BATCHES = 4;
+
+QueryStream::QueryStream(SequenceFile& file, int64_t max_letters, double deadline) :
+	file_(file),
+	max_letters_(std::max(max_letters, (int64_t)1)),
+	capacity_(max_letters_ * READ_AHEAD_BATCHES),
+	deadline_(duration_cast<Clock::duration>(duration<double>(std::max(deadline, 0.0)))),
+	load_titles_(flag_any(file.flags(), SequenceFile::Flags::TITLES)),
+	load_quals_(flag_any(file.flags(), SequenceFile::Flags::QUALITY)),
+	preserve_dna_(flag_any(file.flags(), SequenceFile::Flags::DNA_PRESERVATION)),
+	frame_mask_(::frame_mask()),
+	queued_letters_(0),
+	oid_(file.tell_seq()),
+	batches_(0),
+	eof_(false),
+	stop_(false)
+{
+	if (file.file_count() != 1)
+		throw runtime_error("Streaming query input does not support paired query files.");
+	reader_ = std::thread(&QueryStream::read_loop, this);
+}
+
+QueryStream::~QueryStream() {
+	{
+		lock_guard<mutex> lock(mtx_);
+		stop_ = true;
+	}
+	space_.notify_all();
+	reader_.join();
+}
+
+void QueryStream::read_loop() {
+	try {
+		Record r;
+		while (file_.read_seq(r.seq, r.id, load_quals_ ? &r.qual : nullptr)) {
+			if (r.seq.empty())
+				continue;
+			r.arrival = Clock::now();
+			const int64_t len = (int64_t)r.seq.size();
+			{
+				unique_lock<mutex> lock(mtx_);
+				space_.wait(lock, [this] { return stop_ || queued_letters_ < capacity_; });
+				if (stop_)
+					return;
+				queue_.push_back(std::move(r));
+				queued_letters_ += len;
+			}
+			ready_.notify_one();
+			r = Record();
+		}
+	}
+	catch (...) {
+		lock_guard<mutex> lock(mtx_);
+		error_ = std::current_exception();
+	}
+	{
+		lock_guard<mutex> lock(mtx_);
+		eof_ = true;
+	}
+	ready_.notify_one();
+}
+
+Block* QueryStream::next() {
+	vector<Record> batch;
+	{
+		unique_lock<mutex> lock(mtx_);
+		while (!error_ && !eof_ && queued_letters_ < max_letters_) {
+			if (queue_.empty())
+				ready_.wait(lock);
+			else if (ready_.wait_until(lock, queue_.front().arrival + deadline_) == std::cv_status::timeout)
+				break;
+		}
+		if (error_)
+			std::rethrow_exception(error_);
+		int64_t letters = 0;
+		while (!queue_.empty() && letters < max_letters_) {
+			letters += (int64_t)queue_.front().seq.size();
+			batch.push_back(std::move(queue_.front()));
+			queue_.pop_front();
+		}
+		queued_letters_ -= letters;
+	}
+	space_.notify_one();
+
+	const SequenceType seq_type = file_.sequence_type();
+	Block* block = new Block();
+	for (const Record& r : batch)
+		block->push_back(Sequence(r.seq), load_titles_ ? r.id.c_str() : nullptr, load_quals_ ? &r.qual : nullptr, oid_++, seq_type, frame_mask_, !preserve_dna_);
+	block->seqs_.finish_reserve();
+	if (seq_type == SequenceType::nucleotide)
+		block->source_seqs_.finish_reserve();
+	if (load_titles_)
+		block->ids_.finish_reserve();
+	if (load_quals_)
+		block->qual_.finish_reserve();
+	if (!batch.empty())
+		++batches_;
+	return block;
+}
@@ -0,0 +1,73 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2012-2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sequence_file.h"
+#include "block/block.h"
+
+// Cuts a continuously arriving query input (e.g. stdin) into micro-batches. A background thread
+// reads records as they arrive; next() returns a block once it holds max_letters letters or the
+// oldest pending record has waited for deadline seconds, whichever comes first.
+struct QueryStream {
+
+	QueryStream(SequenceFile& file, int64_t max_letters, double deadline);
+	~QueryStream();
+	// Returns an empty block at the end of the input.
+	Block* next();
+	int64_t batches() const {
+		return batches_;
+	}
+
+private:
+
+	using Clock = std::chrono::steady_clock;
+
+	struct Record {
+		std::vector<Letter> seq;
+		std::string id;
+		std::vector<char> qual;
+		Clock::time_point arrival;
+	};
+
+	void read_loop();
+
+	SequenceFile& file_;
+	const int64_t max_letters_, capacity_;
+	const Clock::duration deadline_;
+	const bool load_titles_, load_quals_, preserve_dna_;
+	const int frame_mask_;
+	std::deque<Record> queue_;
+	int64_t queued_letters_;
+	OId oid_;
+	int64_t batches_;
+	bool eof_, stop_;
+	std::exception_ptr error_;
+	std::mutex mtx_;
+	std::condition_variable ready_, space_;
+	std::thread reader_;
+
+};
@@ -67,9 +67,9 @@ const EMap<SequenceFile::Type> EnumTraits<SequenceFile::Type>::to_string = {
 	{SequenceFile::Type::BLOCK, ""}
 };
 
-static string dict_file_name(const size_t query_block, const size_t target_block) {
-	const string file_name = append_label("ref_dict_", query_block) + append_label("_", target_block);
-	return join_path(config.parallel_tmpdir, file_name);
+string SequenceFile::dict_file_name(const size_t query_block, const size_t ref_block) {
+	const string file_name = append_label("ref_dict_", query_block) + append_label("_", ref_block);
+	return join_path(config.checkpoint.empty() ? config.parallel_tmpdir : config.checkpoint, file_name);
 }
 
 static size_t single_oid(const SequenceFile* f, const string& acc) {
@@ -221,7 +221,7 @@ pair<Block*, uint64_t> SequenceFile::load_twopass(const uint64_t max_letters, co
 
 	while (goon()) {
 		SeqInfo r_next = read_seqinfo();
-		if (!use_filter || filter->get(database_id)) {
+		if (!r.deleted() && (!use_filter || filter->get(database_id))) {
 			letters += r.seq_len;
 			if (flag_any(flags(), SequenceFile::Flags::SEQS)) {
 				block->seqs_.reserve(r.seq_len);
@@ -234,9 +234,7 @@ pair<Block*, uint64_t> SequenceFile::load_twopass(const uint64_t max_letters, co
 			}
 			++filtered_seq_count;
 			block->block2oid_.push_back(database_id);
-			if (use_filter) {
-				filtered_pos.push_back(last ? 0 : r.pos);
-			}
+			filtered_pos.push_back(last || seqs == 0 ? 0 : r.pos);
 			last = true;
 		}
 		else {
@@ -265,7 +263,7 @@ pair<Block*, uint64_t> SequenceFile::load_twopass(const uint64_t max_letters, co
 		seek_offset(offset);
 		for (BlockId i = 0; i < filtered_seq_count; ++i) {
 			bool seek = false;
-			if (use_filter && filtered_pos[i]) {
+			if (filtered_pos[i]) {
 				offset = filtered_pos[i];
 				seek = true;
 			}
@@ -344,9 +342,13 @@ pair<Block*, uint64_t> SequenceFile::load_onepass(const uint64_t max_letters, OI
 	return { block, seq_count };
 }
 
+bool SequenceFile::block_dictionaries() {
+	return config.multiprocessing || !config.checkpoint.empty();
+}
+
 size_t SequenceFile::dict_block(const size_t ref_block)
 {
-	return config.multiprocessing ? ref_block : 0;
+	return block_dictionaries() ? ref_block : 0;
 }
 
 Block* SequenceFile::load_seqs(const int64_t max_letters, OId max_seqs, const BitVector* filter, const Chunk& chunk)
@@ -412,24 +414,44 @@ void SequenceFile::get_seq()
 		}
 		f.close();
 	}
+	// With an accession index, the titles are mapped to OIds up front so that the scan can stop at the last selected sequence.
+	std::map<OId, string> oid_titles;
+	if (has_accession_index()) {
+		for (const auto& t : seq_titles) {
+			vector<OId> oids;
+			try {
+				oids = accession_to_oid(t.first);
+			}
+			catch (std::runtime_error&) {
+			}
+			for (OId oid : oids) {
+				oid_titles[oid] = t.second;
+				seqs.insert(oid);
+			}
+		}
+		seq_titles.clear();
+	}
 	if (!seqs.empty())
 		*message_stream << "#Selected sequences: " << seqs.size() << endl;
+	const uint64_t end = seq_titles.empty() && !all ? (seqs.empty() ? 0 : *seqs.rbegin() + 1) : sequence_count().value();
 
 	const size_t max_letters = config.chunk_size == 0.0 ? std::numeric_limits<size_t>::max() : (size_t)(config.chunk_size * 1e9);
 	size_t letters = 0;
 	TextBuffer buf;
 	OutputFile out(config.output_file);
-	for (uint64_t n = 0; n < sequence_count().value(); ++n) {
+	for (uint64_t n = 0; n < std::min(end, sequence_count().value()); ++n) {
 		read_seq(seq, id);
 		std::map<string, string>::const_iterator mapped_title = seq_titles.find(Util::Seq::seqid(id.c_str()));
+		std::map<OId, string>::const_iterator mapped_oid = oid_titles.find(n);
+		const string* title = mapped_title != seq_titles.end() ? &mapped_title->second : (mapped_oid != oid_titles.end() ? &mapped_oid->second : &id);
 		if (all || seqs.find(n) != seqs.end() || mapped_title != seq_titles.end()) {
 			if (config.reverse) {
-				buf << '>' << (mapped_title != seq_titles.end() ? mapped_title->second : id) << '\n';
+				buf << '>' << *title << '\n';
 				Sequence(seq).print(buf, value_traits, Sequence::Reversed());
 				buf << '\n';
 			}
 			else if (config.hardmasked) {
-				buf << '>' << (mapped_title != seq_titles.end() ? mapped_title->second : id) << '\n';
+				buf << '>' << *title << '\n';
 				Sequence(seq).print(buf, value_traits, Sequence::Hardmasked());
 				buf << '\n';
 			}
@@ -469,8 +491,9 @@ SequenceFile::~SequenceFile()
 	}
 }
 
-static bool is_blast_db(const string& path) {
-	if (exists(path + ".pin") || exists(path + ".pal") || ends_with(path, ".pal")) {
+static bool is_blast_db(const string& path, SequenceType type) {
+	const string index_ext = blastdb_extension(type, "in"), alias_ext = blastdb_extension(type, "al");
+	if (exists(path + index_ext) || exists(path + alias_ext) || ends_with(path, alias_ext.c_str())) {
 		if (config.multiprocessing)
 			throw runtime_error("--multiprocessing is not compatible with BLAST databases.");
 		if (config.target_indexed)
@@ -482,7 +505,7 @@ static bool is_blast_db(const string& path) {
 
 SequenceFile* SequenceFile::auto_create(const vector<string>& path, Flags flags, const ValueTraits& value_traits) {
 	if (path.size() == 1) {
-		if (is_blast_db(path.front()))
+		if (is_blast_db(path.front(), value_traits.seq_type))
 			return new BlastDB(path.front(), flags, value_traits);
 		const string a = auto_append_extension_if_exists(path.front(), DatabaseFile::FILE_EXTENSION);
 		if (DatabaseFile::is_diamond_db(a))
@@ -502,10 +525,10 @@ void SequenceFile::load_dict_block(File* f, const size_t ref_block)
 
 void SequenceFile::load_dictionary(const size_t query_block, const size_t ref_blocks)
 {
-	if (!dict_file_ && !config.multiprocessing)
+	if (!dict_file_ && !block_dictionaries())
 		return;
 	TaskTimer timer("Loading dictionary", 3);
-	if (config.multiprocessing) {
+	if (block_dictionaries()) {
 		dict_oid_ = vector<vector<OId>>(ref_blocks);
 		if (flag_any(flags_, Flags::SELF_ALN_SCORES))
 			dict_self_aln_score_ = vector<vector<double>>(ref_blocks);
@@ -597,7 +620,7 @@ void SequenceFile::init_dict(const size_t query_block, const size_t target_block
 {
 	if (dict_file_)
 		dict_file_->close();
-	dict_file_.reset(config.multiprocessing ? new File(dict_file_name(query_block, target_block), "wb") : new File(Temporary()));
+	dict_file_.reset(block_dictionaries() ? new File(dict_file_name(query_block, target_block), "wb") : new File(Temporary()));
 	next_dict_id_ = 0;
 	dict_alloc_size_ = 0;
 	block_to_dict_id_.clear();
@@ -613,7 +636,7 @@ void SequenceFile::init_dict_block(size_t block, size_t seq_count, bool persist)
 
 void SequenceFile::close_dict_block(bool persist)
 {
-	if (config.multiprocessing) {
+	if (block_dictionaries()) {
 		dict_file_->close();
 		dict_file_.reset();
 	}
@@ -720,7 +743,7 @@ bool SequenceFile::load_dict_entry(File& f, size_t ref_block)
 
 void SequenceFile::reserve_dict(const size_t ref_blocks)
 {
-	if (config.multiprocessing) {
+	if (block_dictionaries()) {
 		if (flag_any(format_flags_, FormatFlags::DICT_LENGTHS))
 			dict_len_ = std::vector<std::vector<uint32_t>>(ref_blocks);
 		if (flag_any(format_flags_, FormatFlags::DICT_SEQIDS))
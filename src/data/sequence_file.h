@@ -120,15 +120,20 @@ struct SequenceFile {
 
 	struct SeqInfo
 	{
-		SeqInfo()
+		SeqInfo():
+			flags(0)
 		{}
 		SeqInfo(uint64_t pos, size_t len) :
 			pos(pos),
-			seq_len(uint32_t(len))
+			seq_len(uint32_t(len)),
+			flags(0)
 		{}
+		bool deleted() const {
+			return flags & DELETED;
+		}
 		uint64_t pos;
-		uint32_t seq_len;
-		enum { SIZE = 16 };
+		uint32_t seq_len, flags;
+		enum { SIZE = 16, DELETED = 1 };
 	};
 
     SequenceFile(Type type, Flags flags, FormatFlags format_flags, const ValueTraits& value_traits = amino_acid_traits);
@@ -181,6 +186,18 @@ struct SequenceFile {
 	void init_random_access(const size_t query_block, const size_t ref_blocks, bool dictionary = true);
 	virtual void end_random_access(bool dictionary = true) = 0;
 	virtual std::vector<OId> accession_to_oid(const std::string& acc) const;
+	// Accessions can be mapped by accession_to_oid() without building the mapping in memory.
+	virtual bool has_accession_index() const {
+		return false;
+	}
+	// Masking intervals computed by the algorithm with the current parameters are stored with the database.
+	virtual bool has_stored_masking(MaskingAlgo algo) const {
+		return false;
+	}
+	// Hard masks a block using the stored masking intervals.
+	virtual MaskingStat apply_stored_masking(Block& block, MaskingAlgo algo) {
+		throw OperationNotSupported();
+	}
 	virtual void init_write();
 	virtual void write_seq(const Sequence& seq, const std::string& id);
 	virtual ~SequenceFile();
@@ -204,6 +221,9 @@ struct SequenceFile {
 	virtual int raw_chunk_no() const;
 	uint64_t disk_size() const;
 
+	// Whether every reference block has its own dictionary file that persists until the join (--multiprocessing, --checkpoint).
+	static bool block_dictionaries();
+	static std::string dict_file_name(const size_t query_block, const size_t ref_block);
 	void init_dict(const size_t query_block, const size_t target_block);
 	void init_dict_block(size_t block, size_t seq_count, bool persist);
 	void close_dict_block(bool persist);
@@ -219,6 +239,9 @@ struct SequenceFile {
 	FormatFlags format_flags() const {
 		return format_flags_;
 	}
+	SequenceType sequence_type() const {
+		return value_traits_.seq_type;
+	}
 
     static SequenceFile* auto_create(const std::vector<std::string>& path, Flags flags = Flags::NONE, const ValueTraits& value_traits = amino_acid_traits);
 
@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <assert.h>
 #include <vector>
 #include <algorithm>
+#include "util/memory/huge_pages.h"
 
 template<typename T, char padding_char, size_t padding_len = 1lu>
 struct StringSetBase
@@ -50,6 +51,7 @@ struct StringSetBase
 
 	void reserve(size_t n)
 	{
+		position_index_.clear();
 		limits_.push_back(raw_len() + n + padding_len);
 	}
 
@@ -59,6 +61,7 @@ struct StringSetBase
 	}
 
 	void clear() {
+		position_index_.clear();
 		limits_.resize(1);
 		data_.resize(PERIMETER_PADDING);
 	}
@@ -71,6 +74,7 @@ struct StringSetBase
 	template<typename It>
 	void push_back(It begin, It end)
 	{
+		position_index_.clear();
 		assert(begin <= end);
 		limits_.push_back(raw_len() + (end - begin) + padding_len);
 		data_.insert(data_.end(), begin, end);
@@ -78,6 +82,7 @@ struct StringSetBase
 	}
 
 	void append(const StringSetBase& s, bool remove_padding = false) {
+		position_index_.clear();
 		const Id n = s.size();
 		if (n == 0)
 			return;
@@ -94,6 +99,19 @@ struct StringSetBase
 			data_.insert(data_.end(), s.ptr(0), s.end(n - 1) + 1);
 	}
 
+	// Appends strings stored back to back, each followed by its padding, whose extents are given by the
+	// offsets [begin, end). Returns a pointer to the new storage for the caller to fill in.
+	template<typename It>
+	T* append_raw(It begin, It end)
+	{
+		position_index_.clear();
+		const size_t base = raw_len();
+		for (It i = begin + 1; i < end; ++i)
+			limits_.push_back(base + (*i - *begin));
+		data_.resize(raw_len());
+		return &data_[base];
+	}
+
 	template<typename It>
 	void assign(const size_t i, const It begin, const It end) {
 		std::copy(begin, end, ptr(i));
@@ -102,6 +120,7 @@ struct StringSetBase
 
 	void fill(size_t n, T v)
 	{
+		position_index_.clear();
 		limits_.push_back(raw_len() + n + padding_len);
 		data_.insert(data_.end(), n, v);
 		data_.insert(data_.end(), padding_len, padding_char);
@@ -140,7 +159,7 @@ struct StringSetBase
 	{ return limits_.back(); }
 
 	int64_t mem_size() const {
-		return data_.size() * sizeof(T) + limits_.size() * sizeof(int64_t);
+		return data_.size() * sizeof(T) + limits_.size() * sizeof(int64_t) + position_index_.size() * sizeof(Id);
 	}
 
 	int64_t letters() const
@@ -160,10 +179,42 @@ struct StringSetBase
 
 	std::pair<Id, Length> local_position(int64_t p) const
 	{
+		if (!position_index_.empty() && p >= limits_.front() && p < raw_len()) {
+			Id i = position_index_[p >> position_block_bits_];
+			while (limits_[i + 1] <= p)
+				++i;
+			return std::pair<Id, Length>(i, Length(p - limits_[i]));
+		}
 		auto i = std::upper_bound(limits_.begin(), limits_.end(), p) - limits_.begin() - 1;
 		return std::pair<Id, Length>(Id(i), Length(p - limits_[i]));
 	}
 
+	// Stores the first string overlapping each block of positions, so that local_position() scans a few limits instead
+	// of searching all of them. The block size is the average string length rounded down to a power of 2, which keeps
+	// the scan at about two strings. The index is dropped when strings are added.
+	void init_position_index()
+	{
+		const Pos n = raw_len();
+		const Id count = size();
+		position_index_.clear();
+		if (count == 0)
+			return;
+		position_block_bits_ = 4;
+		while (Pos(2) << position_block_bits_ <= (n - limits_.front()) / count)
+			++position_block_bits_;
+		position_index_.reserve((n >> position_block_bits_) + 1);
+		Id i = 0;
+		for (Pos b = 0; b < n; b += Pos(1) << position_block_bits_) {
+			while (i + 1 < count && limits_[i + 1] <= b)
+				++i;
+			position_index_.push_back(i);
+		}
+	}
+
+	bool has_position_index() const {
+		return !position_index_.empty();
+	}
+
 	template<typename It, typename Out, typename Cmp>
 	void local_position_batch(It begin, It end, Out out, Cmp cmp) const {
 		batch_binary_search(begin, end, limits_.begin(), limits_.end(), out, cmp);
@@ -269,8 +320,10 @@ struct StringSetBase
 
 private:
 
-	std::vector<T> data_;
+	std::vector<T, Util::Memory::HugePageAllocator<T>> data_;
 	std::vector<Pos> limits_;
+	std::vector<Id> position_index_;
+	int position_block_bits_;
 
 };
 
@@ -95,7 +95,7 @@ static Util::Seq::AccessionParsing load_mapping_file(ExternalSorter<pair<string,
 	return stats;
 }
 
-void TaxonList::build(OutputFile &db, ExternalSorter<pair<string, OId>>& acc2oid, OId seqs, Util::Table& stats)
+void TaxonList::build(OutputFile &db, ExternalSorter<pair<string, OId>>& acc2oid, OId seqs, Util::Table& stats, OId oid_begin)
 {
 	TaskTimer timer("Loading taxonomy mapping file");
 	ExternalSorter<pair<string, TaxId>> acc2taxid;
@@ -118,7 +118,7 @@ void TaxonList::build(OutputFile &db, ExternalSorter<pair<string, OId>>& acc2oid
 
 	timer.go("Writing taxon id list");
 	oid2taxid.init_read();
-	auto taxid_it = merge_keys(oid2taxid, First<OId, TaxId>(), Second<OId, TaxId>(), 0);
+	auto taxid_it = merge_keys(oid2taxid, First<OId, TaxId>(), Second<OId, TaxId>(), oid_begin);
 	size_t mapped_seqs = 0;
 	while (taxid_it.key() < seqs) {
 		set<TaxId> tax_ids = *taxid_it;
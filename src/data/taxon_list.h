@@ -31,5 +31,5 @@ struct TaxonList : public CompactArray
 {
 	typedef std::pair<std::string, OId> T;
 	TaxonList(File &in, size_t size, size_t data_size);
-	static void build(OutputFile &db, ExternalSorter<T, std::less<T>>& accessions, OId seqs, Util::Table& stats);
+	static void build(OutputFile &db, ExternalSorter<T, std::less<T>>& accessions, OId seqs, Util::Table& stats, OId oid_begin = 0);
 };
\ No newline at end of file
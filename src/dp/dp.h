@@ -256,6 +256,7 @@ private:
 };
 
 using Targets = std::array<TargetVec, BINS>;
+using FrameshiftTargets = std::array<std::vector<DpTarget>, 2>;
 
 struct NoCBS {
 	constexpr void* operator[](int i) const { return nullptr; }
@@ -288,6 +289,7 @@ std::list<Hsp> swipe(const Targets& targets, Params& params);
 std::list<Hsp> swipe_set(const SequenceSet::ConstIterator begin, const SequenceSet::ConstIterator end, Params& params);
 int bin(HspValues v, int query_len, int score, int ungapped_score, const int64_t dp_size, unsigned score_width, const Loc mismatch_est);
 std::list<Hsp> anchored_swipe(Targets& targets, const DP::AnchoredSwipe::Config& cfg, std::pmr::monotonic_buffer_resource& pool);
+std::list<Hsp> swipe_3frame(const TranslatedSequence& query, FrameshiftTargets& targets, const HspValues v, const Flags flags);
 
 }
 
@@ -352,6 +352,8 @@ Hsp traceback(Sequence *query, Strand strand, int dna_len, const Banded3FrameSwi
 	
 	Hsp out(true);
 	out.swipe_target = target.target_idx;
+	out.d_begin = target.d_begin;
+	out.d_end = target.d_end;
 	out.score = ScoreTraits<_sv>::int_score(max_score) * config.cbs_matrix_scale;
 	out.bit_score = score_matrix.bitscore(out.score);
 	out.evalue = evalue;
@@ -395,6 +397,8 @@ Hsp traceback(Sequence *query, Strand strand, int dna_len, const Banded3FrameSwi
 	Hsp out(false);
 	const int j0 = i1 - (target.d_end - 1);
 	out.swipe_target = target.target_idx;
+	out.d_begin = target.d_begin;
+	out.d_end = target.d_end;
 	out.score = ScoreTraits<_sv>::int_score(max_score) * config.cbs_matrix_scale;
 	out.bit_score = score_matrix.bitscore(out.score);
 	out.evalue = evalue;
@@ -625,4 +629,20 @@ list<Hsp> banded_3frame_swipe(const TranslatedSequence &query, Strand strand, ve
 
 }
 
-DISPATCH_7(std::list<Hsp>, banded_3frame_swipe, const TranslatedSequence&, query, Strand, strand, std::vector<DpTarget>::iterator, target_begin, std::vector<DpTarget>::iterator, target_end, DpStat&, stat, bool, score_only, bool, parallel)
\ No newline at end of file
+DISPATCH_7(std::list<Hsp>, banded_3frame_swipe, const TranslatedSequence&, query, Strand, strand, std::vector<DpTarget>::iterator, target_begin, std::vector<DpTarget>::iterator, target_end, DpStat&, stat, bool, score_only, bool, parallel)
+namespace DP { namespace BandedSwipe { namespace DISPATCH_ARCH {
+
+list<Hsp> swipe_3frame(const TranslatedSequence& query, FrameshiftTargets& targets, const HspValues v, const Flags flags)
+{
+	DpStat stat;
+	const bool score_only = v == HspValues::NONE, parallel = flag_any(flags, Flags::PARALLEL);
+	list<Hsp> out = ::DISPATCH_ARCH::banded_3frame_swipe(query, FORWARD, targets[0].begin(), targets[0].end(), stat, score_only, parallel);
+	out.splice(out.end(), ::DISPATCH_ARCH::banded_3frame_swipe(query, REVERSE, targets[1].begin(), targets[1].end(), stat, score_only, parallel));
+	return out;
+}
+
+}
+
+DISPATCH_4(std::list<Hsp>, swipe_3frame, const TranslatedSequence&, query, FrameshiftTargets&, targets, const HspValues, v, const Flags, flags)
+
+}}
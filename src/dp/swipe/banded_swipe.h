@@ -333,12 +333,20 @@ list<Hsp> swipe(const TargetVec::const_iterator subject_begin, const TargetVec::
 
 	list<Hsp> out;
 	TaskTimer timer;
+	int scores[CHANNELS];
+	unsigned target_len[CHANNELS];
+	double evalues[CHANNELS];
+	for (int i = 0; i < targets.n_targets; ++i) {
+		scores[i] = ScoreTraits<Sv>::int_score(best[i]);
+		if (!subject_begin[i].adjusted_matrix())
+			scores[i] *= config.cbs_matrix_scale;
+		target_len[i] = subject_begin[i].true_target_len;
+	}
+	score_matrix.evalue(scores, qlen, target_len, evalues, targets.n_targets);
 	for (int i = 0; i < targets.n_targets; ++i) {
 		if (best[i] < ScoreTraits<Sv>::max_score() && !overflow_stats<Sv>(stats[i])) {
-			int score = ScoreTraits<Sv>::int_score(best[i]);
-			if (!subject_begin[i].adjusted_matrix())
-				score *= config.cbs_matrix_scale;
-			const double evalue = score_matrix.evalue(score, qlen, subject_begin[i].true_target_len);
+			const int score = scores[i];
+			const double evalue = evalues[i];
 			if (score > 0 && score_matrix.report_cutoff(score, evalue)) {
 				out.push_back(traceback<Sv>(composition_bias, dp, subject_begin[i], d_begin[i], best[i], evalue, max_col[i], i, i0 - j, i1 - j, max_band_row[i], stats[i], p));
 			}
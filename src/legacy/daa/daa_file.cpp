@@ -0,0 +1,212 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2012-2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include "basic/config.h"
+#include "daa_file.h"
+
+using std::runtime_error;
+using std::min;
+
+// Number of query records per block returned by read_block for unblocked files.
+static const uint32_t UNBLOCKED_RECORDS = 32;
+
+void daa_compress_block(const char* ptr, size_t size, CompressionLib codec, BinaryBuffer& dst) {
+	switch (codec) {
+	case CompressionLib::ZLIB: {
+		uLongf n = compressBound((uLong)size);
+		dst.resize(n);
+		if (compress2((Bytef*)dst.data(), &n, (const Bytef*)ptr, (uLong)size, Z_DEFAULT_COMPRESSION) != Z_OK)
+			throw runtime_error("Error compressing DAA record block.");
+		dst.resize(n);
+		break;
+	}
+#ifdef WITH_ZSTD
+	case CompressionLib::ZSTD: {
+		dst.resize(ZSTD_compressBound(size));
+		const size_t n = ZSTD_compress(dst.data(), dst.size(), ptr, size, ZSTD_CLEVEL_DEFAULT);
+		if (ZSTD_isError(n))
+			throw runtime_error(std::string("Error compressing DAA record block: ") + ZSTD_getErrorName(n));
+		dst.resize(n);
+		break;
+	}
+#endif
+	default:
+		throw runtime_error("Unsupported compression for DAA record blocks.");
+	}
+}
+
+bool DAAFile::read_block_raw(DAA_record_block& block) {
+	uint32_t size;
+	f_.read(&size, sizeof(size));
+	if (size == 0) {
+		f_.seek(-(int64_t)sizeof(size), SEEK_CUR);
+		return false;
+	}
+	f_.read(&block.raw_size, sizeof(block.raw_size));
+	f_.read(&block.query_count, sizeof(block.query_count));
+	block.data.resize(size);
+	f_.read(block.data.data(), size);
+	block.compressed = true;
+	return true;
+}
+
+void DAAFile::decompress(const DAA_record_block& block, BinaryBuffer& dst) const {
+	if (!block.compressed) {
+		dst = block.data;
+		return;
+	}
+	dst.resize(block.raw_size);
+	switch (codec()) {
+	case CompressionLib::ZLIB: {
+		uLongf n = block.raw_size;
+		if (uncompress((Bytef*)dst.data(), &n, (const Bytef*)block.data.data(), (uLong)block.data.size()) != Z_OK || n != block.raw_size)
+			throw runtime_error("Error decompressing DAA record block.");
+		break;
+	}
+#ifdef WITH_ZSTD
+	case CompressionLib::ZSTD: {
+		const size_t n = ZSTD_decompress(dst.data(), dst.size(), block.data.data(), block.data.size());
+		if (ZSTD_isError(n) || n != block.raw_size)
+			throw runtime_error("Error decompressing DAA record block.");
+		break;
+	}
+#endif
+	default:
+		throw runtime_error("Unsupported compression of DAA record blocks.");
+	}
+}
+
+void DAAFile::next_record(const BinaryBuffer& block, size_t& pos, BinaryBuffer& dst) {
+	uint32_t size;
+	if (pos + sizeof(size) > block.size())
+		throw runtime_error("Unexpected end of DAA record block.");
+	memcpy(&size, block.data() + pos, sizeof(size));
+	pos += sizeof(size);
+	if (pos + size > block.size())
+		throw runtime_error("Unexpected end of DAA record block.");
+	dst.assign(block.data() + pos, block.data() + pos + size);
+	pos += size;
+}
+
+bool DAAFile::read_query_buffer(BinaryBuffer& buf, size_t& query_num) {
+	if (query_count_ >= query_limit_)
+		return false;
+	if (!blocked()) {
+		uint32_t size;
+		f_.read(&size, sizeof(size));
+		if (size == 0)
+			return false;
+		buf.clear();
+		buf.resize(size);
+		f_.read(buf.data(), size);
+		query_num = query_count_++;
+		return true;
+	}
+	while (block_left_ == 0) {
+		DAA_record_block block;
+		if (!read_block_raw(block))
+			return false;
+		decompress(block, block_);
+		block_pos_ = 0;
+		block_left_ = block.query_count;
+	}
+	next_record(block_, block_pos_, buf);
+	--block_left_;
+	query_num = query_count_++;
+	return true;
+}
+
+bool DAAFile::read_block(DAA_record_block& block) {
+	const size_t limit = query_limit_ - min(query_count_, query_limit_);
+	block.query_count = 0;
+	if (limit == 0)
+		return false;
+	block.first_query = query_count_;
+	block.compressed = false;
+	if (!blocked()) {
+		block.data.clear();
+		uint32_t size;
+		while (block.query_count < min((size_t)UNBLOCKED_RECORDS, limit)) {
+			f_.read(&size, sizeof(size));
+			if (size == 0) {
+				f_.seek(-(int64_t)sizeof(size), SEEK_CUR);
+				break;
+			}
+			const size_t pos = block.data.size();
+			block.data.resize(pos + sizeof(size) + size);
+			memcpy(block.data.data() + pos, &size, sizeof(size));
+			f_.read(block.data.data() + pos + sizeof(size), size);
+			++block.query_count;
+		}
+		block.raw_size = (uint32_t)block.data.size();
+	}
+	else if (block_left_ > 0) {
+		block.data.assign(block_.data() + block_pos_, block_.data() + block_.size());
+		block.raw_size = (uint32_t)block.data.size();
+		block.query_count = block_left_;
+		block_left_ = 0;
+	}
+	else if (!read_block_raw(block))
+		return false;
+	block.query_count = (uint32_t)min((size_t)block.query_count, limit);
+	query_count_ += block.query_count;
+	return block.query_count > 0;
+}
+
+void DAAFile::seek_query(size_t query_num) {
+	const int64_t begin = sizeof(DAA_header1) + sizeof(DAA_header2);
+	block_left_ = 0;
+	if (!blocked()) {
+		f_.seek(begin);
+		query_count_ = 0;
+		uint32_t size;
+		while (query_count_ < query_num) {
+			f_.read(&size, sizeof(size));
+			if (size == 0) {
+				f_.seek(-(int64_t)sizeof(size), SEEK_CUR);
+				return;
+			}
+			f_.seek(size, SEEK_CUR);
+			++query_count_;
+		}
+		return;
+	}
+	auto it = std::upper_bound(index_.begin(), index_.end(), query_num, [](size_t q, const DAA_block_index_entry& e) { return q < e.first_query; });
+	if (it == index_.begin()) {
+		f_.seek(begin);
+		query_count_ = 0;
+		return;
+	}
+	--it;
+	f_.seek(it->offset);
+	query_count_ = it->first_query;
+	DAA_record_block block;
+	if (!read_block_raw(block))
+		return;
+	decompress(block, block_);
+	block_pos_ = 0;
+	block_left_ = block.query_count;
+	BinaryBuffer buf;
+	while (query_count_ < query_num && block_left_ > 0) {
+		next_record(block_, block_pos_, buf);
+		--block_left_;
+		++query_count_;
+	}
+}
@@ -24,16 +24,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util/binary_buffer.h"
 #include "util/io/file.h"
 #include "util/io/output_file.h"
+#include "util/io/decompressor.h"
 #include "basic/value.h"
 
 struct DAAFile;
 
 struct DAA_header1
 {
-	enum { VERSION = 1, COMPATIBILITY_VERSION = 0 };
-	DAA_header1():
+	// Version 2 files store the query records in compressed blocks followed by a block index.
+	enum { VERSION = 1, BLOCKED_VERSION = 2, COMPATIBILITY_VERSION = 0 };
+	DAA_header1(uint64_t version = VERSION):
 		magic_number (0x3c0e53476d3ee36bllu),
-		version (VERSION)
+		version (version)
 	{ }
 	uint64_t magic_number, version;
 };
@@ -68,7 +70,7 @@ struct DAA_header2
 		gap_extend (gap_extend),
 		reward (reward),
 		penalty (penalty),
-		reserved1 (0),
+		block_codec (0),
 		reserved2 (0),
 		reserved3 (0),
 		k (k),
@@ -82,15 +84,33 @@ struct DAA_header2
 		strcpy(this->score_matrix, score_matrix.c_str());
 	}
 	DAA_header2(const DAAFile& f);
-	typedef enum { empty = 0, alignments = 1, ref_names = 2, ref_lengths = 3 } Block_type;
+	typedef enum { empty = 0, alignments = 1, ref_names = 2, ref_lengths = 3, query_index = 4 } Block_type;
+	enum { FLAG_BLOCKED = 1 };
 	uint64_t diamond_build, db_seqs, db_seqs_used, db_letters, flags, query_records;
-	int32_t mode, gap_open, gap_extend, reward, penalty, reserved1, reserved2, reserved3;
+	int32_t mode, gap_open, gap_extend, reward, penalty, block_codec, reserved2, reserved3;
 	double k, lambda, evalue, reserved5;
 	char score_matrix[16];
 	uint64_t block_size[256];
 	char block_type[256];
 };
 
+// Index entry of a compressed record block: file offset of the block header and number of the first query in it.
+struct DAA_block_index_entry
+{
+	uint64_t offset, first_query;
+};
+
+// Query records of a version 2 file as stored on disk: u32 compressed size, u32 raw size, u32 query count, data.
+struct DAA_record_block
+{
+	BinaryBuffer data;
+	uint32_t raw_size, query_count;
+	uint64_t first_query;
+	bool compressed;
+};
+
+void daa_compress_block(const char* ptr, size_t size, CompressionLib codec, BinaryBuffer& dst);
+
 struct DAAFile
 {
 
@@ -101,7 +121,7 @@ struct DAAFile
 		f_.read(&h1_, sizeof(h1_));
 		if(h1_.magic_number != DAA_header1().magic_number)
 			throw std::runtime_error("Input file is not a DAA file.");
-		if(h1_.version > DAA_header1::VERSION)
+		if(h1_.version > DAA_header1::BLOCKED_VERSION)
 			throw std::runtime_error("DAA version requires later version of DIAMOND.");
 		f_.read(&h2_, sizeof(h2_));
 
@@ -120,6 +140,10 @@ struct DAAFile
 		}
 		ref_len_.resize((size_t)h2_.db_seqs_used);
 		f_.read(ref_len_.data(), sizeof(uint32_t) * (size_t)h2_.db_seqs_used);
+		if (blocked()) {
+			index_.resize((size_t)h2_.block_size[3] / sizeof(DAA_block_index_entry));
+			f_.read(index_.data(), index_.size() * sizeof(DAA_block_index_entry));
+		}
 
 		f_.seek(sizeof(DAA_header1) + sizeof(DAA_header2));
 	}
@@ -191,17 +215,28 @@ struct DAAFile
 		return ref_len_;
 	}
 
-	bool read_query_buffer(BinaryBuffer &buf, size_t &query_num)
+	bool blocked() const
 	{
-		uint32_t size;
-		f_.read(&size, sizeof(size));
-		if(size == 0)
-			return false;
-		buf.clear();
-		buf.resize(size);
-		f_.read(buf.data(), size);
-		query_num = query_count_++;
-		return true;
+		return (h2_.flags & DAA_header2::FLAG_BLOCKED) != 0;
+	}
+
+	CompressionLib codec() const
+	{
+		return blocked() ? (CompressionLib)h2_.block_codec : CompressionLib::NONE;
+	}
+
+	bool read_query_buffer(BinaryBuffer &buf, size_t &query_num);
+	// Returns the next block of query records without decompressing it. The records of a block that was
+	// partially consumed by read_query_buffer are returned uncompressed.
+	bool read_block(DAA_record_block& block);
+	void decompress(const DAA_record_block& block, BinaryBuffer& dst) const;
+	static void next_record(const BinaryBuffer& block, size_t& pos, BinaryBuffer& dst);
+	// Positions the reader at the given query record. Uses the block index of version 2 files.
+	void seek_query(size_t query_num);
+	// Stops reading after this query record number.
+	void set_query_limit(size_t limit)
+	{
+		query_limit_ = limit;
 	}
 
 	File& file() {
@@ -210,8 +245,14 @@ struct DAAFile
 
 private:
 
+	bool read_block_raw(DAA_record_block& block);
+
 	File f_;
-	size_t query_count_;
+	size_t query_count_, query_limit_ = SIZE_MAX;
+	BinaryBuffer block_;
+	size_t block_pos_ = 0;
+	uint32_t block_left_ = 0;
+	std::vector<DAA_block_index_entry> index_;
 	DAA_header1 h1_;
 	DAA_header2 h2_;
 	PtrVector<std::string> ref_name_;
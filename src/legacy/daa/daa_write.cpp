@@ -26,12 +26,72 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 using std::string;
 using std::vector;
 
-void init_daa(File& f)
+// Collects the query records written to a DAA file and stores them as compressed blocks.
+struct DAABlockWriter : CompressorX {
+	DAABlockWriter(CompressionLib codec, int64_t offset):
+		codec_(codec),
+		offset_(offset)
+	{}
+	size_t fwrite(const void* buffer, size_t size, size_t count, FILE* stream) override {
+		buf_.insert(buf_.end(), (const char*)buffer, (const char*)buffer + size * count);
+		uint32_t n;
+		while (buf_.size() - record_end_ >= sizeof(n)) {
+			memcpy(&n, buf_.data() + record_end_, sizeof(n));
+			if (record_end_ + sizeof(n) + n > buf_.size())
+				break;
+			record_end_ += sizeof(n) + n;
+			++records_;
+		}
+		if (record_end_ >= BLOCK_SIZE)
+			write_block(stream);
+		return count;
+	}
+	void flush(FILE* stream) override {
+		write_block(stream);
+		std::fflush(stream);
+	}
+	CompressionLib lib() const override {
+		return codec_;
+	}
+	void finish(FILE* stream) {
+		write_block(stream);
+		if (!buf_.empty())
+			throw std::runtime_error("Incomplete query record in DAA output.");
+	}
+	vector<DAA_block_index_entry> index;
+private:
+	void write_block(FILE* stream) {
+		if (records_ == 0)
+			return;
+		daa_compress_block(buf_.data(), record_end_, codec_, out_);
+		const uint32_t header[3] = { (uint32_t)out_.size(), (uint32_t)record_end_, records_ };
+		if (std::fwrite(header, sizeof(header), 1, stream) != 1 || std::fwrite(out_.data(), 1, out_.size(), stream) != out_.size())
+			throw std::runtime_error("Error writing DAA record block.");
+		index.push_back({ (uint64_t)offset_, query_count_ });
+		offset_ += sizeof(header) + out_.size();
+		query_count_ += records_;
+		buf_.erase(buf_.begin(), buf_.begin() + record_end_);
+		record_end_ = 0;
+		records_ = 0;
+	}
+	static const size_t BLOCK_SIZE = 4 * (1 << 20);
+	const CompressionLib codec_;
+	int64_t offset_;
+	uint64_t query_count_ = 0;
+	uint32_t records_ = 0;
+	size_t record_end_ = 0;
+	vector<char> buf_;
+	BinaryBuffer out_;
+};
+
+void init_daa(File& f, CompressionLib codec)
 {
-	DAA_header1 h1;
+	DAA_header1 h1(codec == CompressionLib::NONE ? DAA_header1::VERSION : DAA_header1::BLOCKED_VERSION);
 	f.write(&h1, sizeof(h1));
 	DAA_header2 h2_;
 	f.write(&h2_, sizeof(h2_));
+	if (codec != CompressionLib::NONE)
+		f.set_compressor(new DAABlockWriter(codec, f.tell()));
 }
 
 size_t write_daa_query_record(TextBuffer& buf, const char* query_name, const Sequence& query)
@@ -72,6 +132,35 @@ void write_daa_record(TextBuffer& buf, const Hsp& match, uint32_t subject_id)
 	buf << match.transcript.data();
 }
 
+static vector<DAA_block_index_entry> terminate_aln_block(File& f, DAA_header2& h2) {
+	vector<DAA_block_index_entry> index;
+	DAABlockWriter* writer = dynamic_cast<DAABlockWriter*>(f.compressor());
+	if (writer) {
+		writer->finish(f.file());
+		index = std::move(writer->index);
+		h2.flags |= DAA_header2::FLAG_BLOCKED;
+		h2.block_codec = (int32_t)writer->lib();
+		f.set_compressor(new PassThroughCompressor);
+	}
+	uint32_t size = 0;
+	f.write(&size, sizeof(size));
+	h2.block_size[0] = f.tell() - sizeof(DAA_header1) - sizeof(DAA_header2);
+	return index;
+}
+
+static void write_index(File& f, DAA_header2& h2, const vector<DAA_block_index_entry>& index) {
+	if (!(h2.flags & DAA_header2::FLAG_BLOCKED))
+		return;
+	f.write(index.data(), index.size() * sizeof(DAA_block_index_entry));
+	h2.block_type[3] = DAA_header2::query_index;
+	h2.block_size[3] = index.size() * sizeof(DAA_block_index_entry);
+}
+
+static void write_header2(File& f, const DAA_header2& h2) {
+	f.seek(sizeof(DAA_header1));
+	f.write(&h2, sizeof(h2));
+}
+
 void finish_daa(File& f, SequenceFile& db)
 {
 	DAA_header2 h2_(db.sequence_count().value(),
@@ -90,9 +179,7 @@ void finish_daa(File& f, SequenceFile& db)
 	h2_.block_type[1] = DAA_header2::ref_names;
 	h2_.block_type[2] = DAA_header2::ref_lengths;
 
-	uint32_t size = 0;
-	f.write(&size, sizeof(size));
-	h2_.block_size[0] = f.tell() - sizeof(DAA_header1) - sizeof(DAA_header2);
+	const vector<DAA_block_index_entry> index = terminate_aln_block(f, h2_);
 	const size_t n = db.dict_size();
 	h2_.db_seqs_used = n;
 	h2_.query_records = statistics.get(Statistics::ALIGNED);
@@ -112,9 +199,8 @@ void finish_daa(File& f, SequenceFile& db)
 	}
 
 	h2_.block_size[2] = n * sizeof(uint32_t);
-
-	f.seek(sizeof(DAA_header1));
-	f.write(&h2_, sizeof(h2_));
+	write_index(f, h2_, index);
+	write_header2(f, h2_);
 }
 
 DAA_header2::DAA_header2(const DAAFile& daa_in) :
@@ -135,21 +221,10 @@ DAA_header2::DAA_header2(const DAAFile& daa_in) :
 	block_type[2] = DAA_header2::ref_lengths;
 }
 
-static void terminate_aln_block(File& f, DAA_header2& h2) {
-	uint32_t size = 0;
-	f.write(&size, sizeof(size));
-	h2.block_size[0] = f.tell() - sizeof(DAA_header1) - sizeof(DAA_header2);
-}
-
-static void write_header2(File& f, const DAA_header2& h2) {
-	f.seek(sizeof(DAA_header1));
-	f.write(&h2, sizeof(h2));
-}
-
 void finish_daa(File& f, DAAFile& daa_in) {
 	DAA_header2 h2_(daa_in);
 
-	terminate_aln_block(f, h2_);
+	const vector<DAA_block_index_entry> index = terminate_aln_block(f, h2_);
 	
 	h2_.db_seqs_used = daa_in.db_seqs_used();
 	h2_.query_records = daa_in.query_records();
@@ -161,12 +236,13 @@ void finish_daa(File& f, DAAFile& daa_in) {
 	f.write(daa_in.ref_len().data(), daa_in.ref_len().size() * sizeof(uint32_t));
 	h2_.block_size[2] = daa_in.block_size(2);
 
+	write_index(f, h2_, index);
 	write_header2(f, h2_);
 }
 
 void finish_daa(File& f, DAAFile& daa_in, const StringSet& seq_ids, const vector<uint32_t>& seq_lens, int64_t query_count) {
 	DAA_header2 h2_(daa_in);
-	terminate_aln_block(f, h2_);
+	const vector<DAA_block_index_entry> index = terminate_aln_block(f, h2_);
 	h2_.db_seqs_used = seq_ids.size();
 	h2_.query_records = (uint64_t)query_count;
 	int64_t s = 0;
@@ -177,5 +253,6 @@ void finish_daa(File& f, DAAFile& daa_in, const StringSet& seq_ids, const vector
 	h2_.block_size[1] = (uint64_t)s;
 	f.write(seq_lens.data(), seq_lens.size() * sizeof(uint32_t));
 	h2_.block_size[2] = seq_lens.size() * sizeof(uint32_t);
+	write_index(f, h2_, index);
 	write_header2(f, h2_);
 }
\ No newline at end of file
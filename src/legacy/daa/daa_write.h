@@ -22,7 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "daa_file.h"
 #include "data/sequence_file.h"
 
-void init_daa(File& f);
+void init_daa(File& f, CompressionLib codec = CompressionLib::NONE);
 size_t write_daa_query_record(TextBuffer& buf, const char* query_name, const Sequence& query);
 void finish_daa_query_record(TextBuffer& buf, size_t seek_pos);
 void write_daa_record(TextBuffer& buf, const IntermediateRecord& r);
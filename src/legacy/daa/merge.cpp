@@ -86,7 +86,7 @@ void merge_daa() {
 	*message_stream << "Total number of targets: " << acc2oid.size() << endl;
 	timer.go("Initializing output");
 	File out(config.output_file, "wb");
-	init_daa(out);
+	init_daa(out, files.front()->codec());
 	int64_t query_count = 0;
 	for (vector<DAAFile*>::iterator i = files.begin(); i < files.end(); ++i) {
 		timer.go(("Writing output for file " + (**i).file().name()).c_str());
@@ -38,8 +38,6 @@ using std::unique_ptr;
 using std::vector;
 using std::endl;
 
-const unsigned view_buf_size = 32;
-
 struct ViewWriter
 {
 	ViewWriter() :
@@ -64,20 +62,9 @@ struct ViewFetcher
 	{ }
 	bool operator()()
 	{
-		n = 0;
-		for (unsigned i = 0; i<view_buf_size; ++i)
-			if (!daa.read_query_buffer(buf[i], query_num)) {
-				query_num -= n - 1;
-				return false;
-			}
-			else
-				++n;
-		query_num -= n - 1;
-		return true;
+		return daa.read_block(block);
 	}
-	BinaryBuffer buf[view_buf_size];
-	unsigned n;
-	size_t query_num;
+	DAA_record_block block;
 	DAAFile &daa;
 };
 
@@ -118,9 +105,14 @@ void view_worker(DAAFile *daa, ViewWriter *writer, TaskQueue<TextBuffer, ViewWri
 		size_t n;
 		ViewFetcher query_buf(*daa);
 		TextBuffer *buffer = 0;
+		BinaryBuffer records, buf;
 		while (queue->get(n, buffer, query_buf)) {
-			for (unsigned j = 0; j < query_buf.n; ++j) {
-				DAA_query_record r(*daa, query_buf.buf[j], query_buf.query_num + j);
+			if (query_buf.block.query_count > 0)
+				daa->decompress(query_buf.block, records);
+			size_t pos = 0;
+			for (uint32_t j = 0; j < query_buf.block.query_count; ++j) {
+				DAAFile::next_record(records, pos, buf);
+				DAA_query_record r(*daa, buf, query_buf.block.first_query + j);
 				view_query(r, *buffer, *format, *cfg);
 			}
 			queue->push(n);
@@ -139,6 +131,20 @@ void view_daa()
 	if (align_mode.input_sequence_type == SequenceType::nucleotide)
 		input_value_traits = nucleotide_traits;
 	score_matrix = ScoreMatrix(daa.score_matrix(), daa.gap_open_penalty(), daa.gap_extension_penalty(), 0, 1, daa.db_letters());
+	if (!config.daa_records.empty()) {
+		const size_t i = config.daa_records.find('-');
+		try {
+			const size_t first = std::stoull(config.daa_records.substr(0, i)),
+				last = i == std::string::npos ? first : std::stoull(config.daa_records.substr(i + 1));
+			if (last < first)
+				throw std::invalid_argument("");
+			daa.seek_query(first);
+			daa.set_query_limit(last + 1);
+		}
+		catch (std::logic_error&) {
+			throw std::runtime_error("Invalid query record range: " + config.daa_records);
+		}
+	}
 	timer.finish();
 
 	*message_stream << "Scoring parameters: " << score_matrix << endl;
@@ -156,7 +162,7 @@ void view_daa()
 	timer.go("Generating output");
 	ViewWriter writer;
 	if (*cfg.output_format == OutputFormat::daa)
-		init_daa(*writer.f_);
+		init_daa(*writer.f_, daa.codec());
 
 	BinaryBuffer buf;
 	size_t query_num;
@@ -0,0 +1,198 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <string.h>
+#include <algorithm>
+#include <thread>
+#include "accession_index.h"
+#include "mio/mmap.hpp"
+
+using std::string;
+using std::vector;
+using std::runtime_error;
+
+static void put_varint(vector<char>& buf, uint64_t x) {
+	while (x >= 0x80) {
+		buf.push_back(char(x | 0x80));
+		x >>= 7;
+	}
+	buf.push_back(char(x));
+}
+
+static uint64_t get_varint(const char*& ptr) {
+	uint64_t x = 0;
+	int shift = 0;
+	uint8_t b;
+	do {
+		b = (uint8_t)*ptr++;
+		x |= uint64_t(b & 0x7f) << shift;
+		shift += 7;
+	} while (b & 0x80);
+	return x;
+}
+
+// Decodes entry i of a block, key holds the previous accession of the block.
+static OId next_entry(const char*& ptr, uint64_t i, string& key) {
+	if (i % AccessionIndex::BLOCK_SIZE == 0) {
+		const uint64_t len = get_varint(ptr);
+		key.assign(ptr, len);
+		ptr += len;
+	}
+	else {
+		const uint64_t shared = get_varint(ptr), len = get_varint(ptr);
+		key.resize(shared);
+		key.append(ptr, len);
+		ptr += len;
+	}
+	return get_varint(ptr);
+}
+
+static uint64_t load_u64(const char* ptr) {
+	uint64_t x;
+	memcpy(&x, ptr, sizeof(x));
+	return x;
+}
+
+AccessionIndex::Writer::Writer(OutputFile& out):
+	out_(out),
+	begin_(out.tell()),
+	size_(0),
+	count_(0)
+{}
+
+void AccessionIndex::Writer::flush() {
+	out_.write(buf_.data(), buf_.size());
+	size_ += buf_.size();
+	buf_.clear();
+}
+
+void AccessionIndex::Writer::push(const string& acc, OId oid) {
+	if (count_ > 0 && acc < last_)
+		throw runtime_error("Accession index entries are not sorted.");
+	if (count_ % BLOCK_SIZE == 0) {
+		if (buf_.size() >= BUF_SIZE)
+			flush();
+		block_offsets_.push_back(size_ + buf_.size());
+		put_varint(buf_, acc.length());
+		buf_.insert(buf_.end(), acc.begin(), acc.end());
+	}
+	else {
+		const size_t shared = std::mismatch(acc.begin(), acc.begin() + std::min(acc.length(), last_.length()), last_.begin()).first - acc.begin();
+		put_varint(buf_, shared);
+		put_varint(buf_, acc.length() - shared);
+		buf_.insert(buf_.end(), acc.begin() + shared, acc.end());
+	}
+	put_varint(buf_, oid);
+	last_ = acc;
+	++count_;
+}
+
+void AccessionIndex::Writer::finish() {
+	flush();
+	out_.write(block_offsets_.data(), block_offsets_.size());
+	const uint64_t size = size_ + block_offsets_.size() * sizeof(uint64_t) + sizeof(Footer);
+	const Footer footer{ count_, block_offsets_.size(), size, Footer::MAGIC };
+	out_.write(&footer, 1);
+	block_offsets_.clear();
+	block_offsets_.shrink_to_fit();
+}
+
+AccessionIndex::AccessionIndex(const string& file_name, uint64_t offset, uint64_t size):
+	mmap_(new mio::mmap_source(file_name, offset, size)),
+	data_(mmap_->data())
+{
+	memcpy(&footer_, data_ + size - sizeof(Footer), sizeof(Footer));
+	if (footer_.magic != Footer::MAGIC || footer_.size != size)
+		throw runtime_error("Invalid accession index in database file: " + file_name);
+	dir_ = data_ + size - sizeof(Footer) - footer_.blocks * sizeof(uint64_t);
+}
+
+AccessionIndex::~AccessionIndex() {}
+
+const char* AccessionIndex::block(uint64_t b) const {
+	return data_ + load_u64(dir_ + b * sizeof(uint64_t));
+}
+
+uint64_t AccessionIndex::first_block(const string& acc) const {
+	// The last block whose first accession is less than acc, so that runs of equal accessions spanning blocks are found from the start.
+	uint64_t lo = 0, hi = footer_.blocks;
+	while (lo < hi) {
+		const uint64_t mid = lo + (hi - lo) / 2;
+		const char* ptr = block(mid);
+		const uint64_t len = get_varint(ptr);
+		if (acc.compare(0, string::npos, ptr, len) > 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo > 0 ? lo - 1 : 0;
+}
+
+vector<OId> AccessionIndex::find(const string& acc) const {
+	vector<OId> r;
+	if (footer_.count == 0)
+		return r;
+	uint64_t b = first_block(acc), i = b * BLOCK_SIZE;
+	const char* ptr = block(b);
+	string key;
+	for (; i < footer_.count; ++i) {
+		const OId oid = next_entry(ptr, i, key);
+		const int c = key.compare(acc);
+		if (c == 0)
+			r.push_back(oid);
+		else if (c > 0)
+			break;
+	}
+	return r;
+}
+
+vector<OId> AccessionIndex::find(const vector<string>& acc, int threads) const {
+	vector<OId> r(acc.size());
+	const size_t n = acc.size(), t = std::max(std::min((size_t)threads, n / 1024), (size_t)1);
+	auto worker = [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			const vector<OId> v = find(acc[i]);
+			r[i] = v.empty() ? NOT_FOUND : v.front();
+		}
+	};
+	vector<std::thread> workers;
+	for (size_t i = 0; i < t; ++i)
+		workers.emplace_back(worker, n * i / t, n * (i + 1) / t);
+	for (auto& w : workers)
+		w.join();
+	return r;
+}
+
+AccessionIndex::Iterator::Iterator(const AccessionIndex& index):
+	index_(index),
+	i_(0),
+	ptr_(index.footer_.count > 0 ? index.block(0) : nullptr)
+{
+	if (good())
+		decode();
+}
+
+void AccessionIndex::Iterator::decode() {
+	entry_.second = next_entry(ptr_, i_, entry_.first);
+}
+
+void AccessionIndex::Iterator::operator++() {
+	if (++i_ < index_.footer_.count)
+		decode();
+}
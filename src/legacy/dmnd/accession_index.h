@@ -0,0 +1,98 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "basic/value.h"
+#include "util/io/output_file.h"
+#include "mio/forward.h"
+
+// Accession to OId index stored as a trailer section of the last volume of a .dmnd database, see DatabaseFile::read_trailer().
+// Entries are sorted by accession and front coded in blocks of BLOCK_SIZE entries. A directory of block offsets
+// and a footer follow the blocks.
+struct AccessionIndex {
+
+	struct Footer {
+		uint64_t count, blocks, size, magic;
+		static constexpr uint64_t MAGIC = 0x3c1f7a0e9b2d4a61llu;
+	};
+
+	struct Writer {
+		Writer(OutputFile& out);
+		// Entries must be pushed in ascending order of accessions.
+		void push(const std::string& acc, OId oid);
+		void finish();
+	private:
+		static constexpr size_t BUF_SIZE = 1 << 20;
+		void flush();
+		OutputFile& out_;
+		uint64_t begin_, size_, count_;
+		std::string last_;
+		std::vector<uint64_t> block_offsets_;
+		std::vector<char> buf_;
+	};
+
+	// Sequential access to all entries in accession order.
+	struct Iterator {
+		Iterator(const AccessionIndex& index);
+		bool good() const {
+			return i_ < index_.footer_.count;
+		}
+		const std::pair<std::string, OId>& operator*() const {
+			return entry_;
+		}
+		void operator++();
+	private:
+		void decode();
+		const AccessionIndex& index_;
+		uint64_t i_;
+		const char* ptr_;
+		std::pair<std::string, OId> entry_;
+	};
+
+	static constexpr OId NOT_FOUND = UINT64_MAX;
+	static constexpr uint64_t BLOCK_SIZE = 32;
+
+	// Maps the section at the given file offset.
+	AccessionIndex(const std::string& file_name, uint64_t offset, uint64_t size);
+	~AccessionIndex();
+	// Returns all OIds of an accession.
+	std::vector<OId> find(const std::string& acc) const;
+	// Returns the first OId of each accession or NOT_FOUND, using the given number of threads.
+	std::vector<OId> find(const std::vector<std::string>& acc, int threads) const;
+	uint64_t size() const {
+		return footer_.count;
+	}
+
+private:
+
+	const char* block(uint64_t b) const;
+	uint64_t first_block(const std::string& acc) const;
+
+	Footer footer_;
+	std::unique_ptr<mio::mmap_source> mmap_;
+	const char* data_;
+	const char* dir_;
+
+	friend struct Iterator;
+
+};
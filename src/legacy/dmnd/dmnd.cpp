@@ -33,6 +33,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "data/fasta/fasta_file.h"
 #include "util/sequence/sequence.h"
 #include "legacy/dmnd/io.h"
+#include "util/string/tokenizer.h"
 
 using std::tuple;
 using std::string;
@@ -102,17 +103,17 @@ Serializer& operator<<(Serializer& file, const ReferenceHeader& h)
 }
 
 File& operator>>(File& file, SequenceFile::SeqInfo& r) {
-	uint32_t p;
 	file.read(r.pos);
 	r.pos = big_endian_byteswap(r.pos);
 	file.read(r.seq_len);
 	r.seq_len = big_endian_byteswap(r.seq_len);
-	file.read(p);
+	file.read(r.flags);
+	r.flags = big_endian_byteswap(r.flags);
 	return file;
 }
 
 Serializer& operator<<(Serializer& file, const SequenceFile::SeqInfo& r) {
-	file << r.pos << r.seq_len << (uint32_t)0;
+	file << r.pos << r.seq_len << r.flags;
 	return file;
 }
 
@@ -144,9 +145,12 @@ void DatabaseFile::init(Flags flags)
 
 DatabaseFile::DatabaseFile(const string& input_file, Flags flags, const ValueTraits& value_traits) :
 	SequenceFile(SequenceFile::Type::DMND, flags, FormatFlags::DICT_LENGTHS | FormatFlags::DICT_SEQIDS | FormatFlags::SEEKABLE | FormatFlags::LENGTH_LOOKUP, value_traits),
-	file_(auto_append_extension_if_exists(input_file, FILE_EXTENSION), "rb")
+	file_(volume_names(auto_append_extension_if_exists(input_file, FILE_EXTENSION)).back(), "rb"),
+	file_name_(auto_append_extension_if_exists(input_file, FILE_EXTENSION)),
+	current_volume_(0)
 {
 	init(flags);
+	init_volumes();
 
 	vector<string> e;
 	if (flag_any(flags, Flags::TAXON_MAPPING) && !has_taxon_id_lists())
@@ -177,8 +181,21 @@ DatabaseFile::DatabaseFile(const string& input_file, Flags flags, const ValueTra
 		init_cache();
 	}
 
-	if (flag_any(flags, Flags::ACC_TO_OID_MAPPING | Flags::OID_TO_ACC_MAPPING | Flags::NEED_LENGTH_LOOKUP))
+	const string last_volume = volume_names(file_name_).back();
+	const std::map<uint64_t, TrailerSection> trailer = read_trailer(last_volume);
+	auto it = trailer.find(AccessionIndex::Footer::MAGIC);
+	if (it != trailer.end()) {
+		accession_index_.reset(new AccessionIndex(last_volume, it->second.offset, it->second.size));
+		flags_ &= ~Flags::ACC_TO_OID_MAPPING;
+	}
+	it = trailer.find(StoredMasking::Footer::MAGIC);
+	if (it != trailer.end())
+		stored_masking_.reset(new StoredMasking(last_volume, it->second.offset, it->second.size));
+
+	if (flag_any(flags_, Flags::ACC_TO_OID_MAPPING | Flags::OID_TO_ACC_MAPPING))
 		read_seqid_list();
+	else if (flag_any(flags_, Flags::NEED_LENGTH_LOOKUP))
+		read_length_list();
 }
 
 /*DatabaseFile::DatabaseFile(TempFile& tmp_file, const ValueTraits& value_traits) :
@@ -189,6 +206,57 @@ DatabaseFile::DatabaseFile(const string& input_file, Flags flags, const ValueTra
 	init();
 }*/
 
+vector<string> DatabaseFile::volume_names(const string& file_name) {
+	vector<string> names{ file_name };
+	while (exists(file_name + '.' + std::to_string(names.size())))
+		names.push_back(file_name + '.' + std::to_string(names.size()));
+	return names;
+}
+
+std::map<uint64_t, DatabaseFile::TrailerSection> DatabaseFile::read_trailer(const string& file_name) {
+	std::map<uint64_t, TrailerSection> sections;
+	File f(file_name, "rb");
+	uint64_t end = file_size(file_name.c_str());
+	while (end >= DATA_OFFSET + 2 * sizeof(uint64_t)) {
+		uint64_t tail[2];
+		f.seek(end - sizeof(tail));
+		f.read(tail, sizeof(tail));
+		const uint64_t size = tail[0], magic = tail[1];
+		if ((magic != AccessionIndex::Footer::MAGIC && magic != StoredMasking::Footer::MAGIC) || size > end - DATA_OFFSET || sections.find(magic) != sections.end())
+			break;
+		end -= size;
+		sections[magic] = { end, size };
+	}
+	f.close();
+	return sections;
+}
+
+void DatabaseFile::init_volumes() {
+	// Sequence positions in the position array are global offsets into the concatenation of all volume files.
+	const vector<string> names = volume_names(file_name_);
+	int64_t base = 0;
+	for (size_t i = 0; i < names.size() - 1; ++i) {
+		volume_files_.emplace_back(new File(names[i], "rb"));
+		ReferenceHeader h;
+		read_header(*volume_files_.back(), h);
+		volumes_.push_back({ volume_files_.back().get(), base, base + DATA_OFFSET, base + (int64_t)h.pos_array_offset });
+		base += file_size(names[i].c_str());
+	}
+	volumes_.push_back({ &file_, base, base + DATA_OFFSET, base + (int64_t)ref_header.pos_array_offset });
+}
+
+size_t DatabaseFile::volume_of(int64_t p) const {
+	auto it = std::upper_bound(volumes_.begin(), volumes_.end(), p, [](int64_t p, const Volume& v) { return p < v.base; });
+	return it - volumes_.begin() - 1;
+}
+
+void DatabaseFile::next_volume_if_at_end() {
+	while (current_volume_ + 1 < volumes_.size() && volumes_[current_volume_].base + volume_file().tell() >= volumes_[current_volume_].data_end) {
+		++current_volume_;
+		volume_file().seek(volumes_[current_volume_].data_begin - volumes_[current_volume_].base);
+	}
+}
+
 int64_t DatabaseFile::file_count() const {
 	return 1;
 }
@@ -198,6 +266,8 @@ void DatabaseFile::close() {
 		InputFile::close_and_delete();
 	else*/
 	file_.close();
+	for (auto& f : volume_files_)
+		f->close();
 }
 
 void DatabaseFile::read_header(File &stream, ReferenceHeader &header)
@@ -221,9 +291,9 @@ bool DatabaseFile::has_taxon_scientific_names() const {
 	return header2.taxon_names_offset != 0;
 }
 
-static void push_seq(const Sequence &seq, const char *id, size_t id_len, uint64_t &offset, vector<SequenceFile::SeqInfo> &pos_array, OutputFile &out, size_t &letters, size_t &n_seqs)
+static void push_seq(const Sequence &seq, const char *id, size_t id_len, uint64_t &offset, uint64_t volume_base, vector<SequenceFile::SeqInfo> &pos_array, OutputFile &out, size_t &letters, size_t &n_seqs)
 {
-	pos_array.emplace_back(offset, seq.length());
+	pos_array.emplace_back(volume_base + offset, seq.length());
 	out.write("\xff", 1);
 	out.write(seq.data(), seq.length());
 	out.write("\xff", 1);
@@ -233,9 +303,7 @@ static void push_seq(const Sequence &seq, const char *id, size_t id_len, uint64_
 	offset += seq.length() + id_len + 3;
 }
 
-void DatabaseFile::make_db()
-{
-	config.file_buffer_size = 4 * MEGABYTES;
+static string input_file_name() {
 	if (config.input_ref_file.size() > 1)
 		throw runtime_error("Too many arguments provided for option --in.");
 	const string input_file_name = config.input_ref_file.empty() ? string() : config.input_ref_file.front();
@@ -243,6 +311,111 @@ void DatabaseFile::make_db()
 		*message_stream << "Input file parameter (--in) is missing. Input will be read from stdin." << endl;
 	else
 		*message_stream << "Database input file: " << input_file_name << endl;
+	return input_file_name;
+}
+
+// Masking algorithms of --precompute-masking.
+static vector<MaskingAlgo> precompute_masking_algos() {
+	vector<MaskingAlgo> v;
+	for (const string& s : config.precompute_masking) {
+		const MaskingAlgo algo = from_string<MaskingAlgo>(s);
+		if (algo != MaskingAlgo::TANTAN && algo != MaskingAlgo::SEG)
+			throw runtime_error("Invalid value for --precompute-masking: " + s + ". Permitted values: tantan, seg.");
+		if (std::find(v.begin(), v.end(), algo) == v.end())
+			v.push_back(algo);
+	}
+	if (!v.empty() && config.dbtype != SequenceType::amino_acid)
+		throw runtime_error("Option --precompute-masking is only supported for protein databases.");
+	return v;
+}
+
+// Accession under which a title is looked up, equivalent to the mapping built by read_seqid_list().
+static string index_key(const char* title) {
+	string id(title);
+	Util::Seq::fix_title(id);
+	return Util::Seq::seqid(id.c_str());
+}
+
+// Writes the accession index from the sorted seqids and the entries of an existing index, skipping the removed OIds.
+static void write_accession_index(OutputFile& out, ExternalSorter<pair<string, OId>>& seqids, const AccessionIndex* old, const vector<OId>& removed, Util::Table& stats) {
+	AccessionIndex::Writer writer(out);
+	seqids.init_read();
+	unique_ptr<AccessionIndex::Iterator> it(old ? new AccessionIndex::Iterator(*old) : nullptr);
+	uint64_t n = 0;
+	while (seqids.good() || (it && it->good())) {
+		if (it && it->good() && (!seqids.good() || **it < *seqids)) {
+			if (!std::binary_search(removed.begin(), removed.end(), (**it).second)) {
+				writer.push((**it).first, (**it).second);
+				++n;
+			}
+			++(*it);
+		}
+		else {
+			writer.push((*seqids).first, (*seqids).second);
+			++n;
+			++seqids;
+		}
+	}
+	writer.finish();
+	stats("Accession index entries", n);
+}
+
+// Writes the sequence records of the input file, starting at the current position of the output file.
+static void write_seqs(FastaFile& db_file, OutputFile& out, uint64_t& offset, uint64_t volume_base, OId oid_begin, vector<SequenceFile::SeqInfo>& pos_array,
+	ExternalSorter<pair<string, OId>>& accessions, ExternalSorter<pair<string, OId>>& seqids, StoredMasking::Writer* masks, Util::Seq::AccessionParsing& acc_stats, char* hash, size_t& letters, size_t& n_seqs, TaskTimer& timer)
+{
+	Block* block;
+	size_t n, total_seqs = 0;
+	while (true) {
+		timer.go("Loading sequences");
+		block = db_file.load_seqs((int64_t)1e9, 0, nullptr);
+		if (block->empty()) {
+			delete block;
+			break;
+		}
+		n = block->seqs().size();
+
+		if (masks) {
+			timer.go("Computing masking intervals");
+			masks->push(block->seqs(), config.threads_);
+		}
+
+		if (config.dbtype == SequenceType::amino_acid && config.masking_ != "0") {
+			timer.go("Masking sequences");
+			mask_seqs(block->seqs(), Masking::get(), false, MaskingAlgo::SEG);
+		}
+
+		timer.go("Writing sequences");
+		for (size_t i = 0; i < n; ++i) {
+			Sequence seq = block->seqs()[i];
+			if (seq.length() == 0)
+				throw std::runtime_error("File format error: sequence of length 0");
+			push_seq(seq, block->ids()[i], block->ids().length(i), offset, volume_base, pos_array, out, letters, n_seqs);
+			seqids.push(std::make_pair(index_key(block->ids()[i]), oid_begin + total_seqs + i));
+		}
+		if (!config.prot_accession2taxid.empty()) {
+			timer.go("Writing accessions");
+			for (size_t i = 0; i < n; ++i) {
+				vector<string> acc = Util::Seq::accession_from_title(block->ids()[i], !config.no_parse_seqids, acc_stats);
+				for (const string& s : acc)
+					accessions.push(std::make_pair(s, oid_begin + total_seqs + i));
+			}
+		}
+		timer.go("Hashing sequences");
+		for (size_t i = 0; i < n; ++i) {
+			Sequence seq = block->seqs()[i];
+			MurmurHash3_x64_128(seq.data(), (int)seq.length(), hash, hash);
+			MurmurHash3_x64_128(block->ids()[i], block->ids().length(i), hash, hash);
+		}
+		delete block;
+		total_seqs += n;
+	}
+}
+
+void DatabaseFile::make_db()
+{
+	config.file_buffer_size = 4 * MEGABYTES;
+	const string input_file_name = ::input_file_name();
 
 	TaskTimer total;
 	TaskTimer timer("Opening the database file", true);
@@ -257,7 +430,7 @@ void DatabaseFile::make_db()
     *out << header;
 	*out << header2;
 
-	size_t letters = 0, n = 0, n_seqs = 0, total_seqs = 0;
+	size_t letters = 0, n_seqs = 0;
 	uint64_t offset = out->tell();
 
 	db_file.flags() |= SequenceFile::Flags::ALL;
@@ -266,49 +439,13 @@ void DatabaseFile::make_db()
         db_file.flags() |= SequenceFile::Flags::DNA_PRESERVATION;
     }
 
-    Block* block;
 	vector<SeqInfo> pos_array;
-	ExternalSorter<pair<string, OId>> accessions;
+	ExternalSorter<pair<string, OId>> accessions, seqids;
 	Util::Seq::AccessionParsing acc_stats;
+	const vector<MaskingAlgo> mask_algos = precompute_masking_algos();
+	unique_ptr<StoredMasking::Writer> masks(mask_algos.empty() ? nullptr : new StoredMasking::Writer(mask_algos, Masking::get()));
 	try {
-		while (true) {
-			timer.go("Loading sequences");
-			block = db_file.load_seqs((int64_t)1e9, 0, nullptr);
-			if (block->empty()) {
-				delete block;
-				break;
-			}
-			n = block->seqs().size();
-
-			if (config.dbtype == SequenceType::amino_acid && config.masking_ != "0") {
-				timer.go("Masking sequences");
-				mask_seqs(block->seqs(), Masking::get(), false, MaskingAlgo::SEG);
-			}
-
-            timer.go("Writing sequences");
-			for (size_t i = 0; i < n; ++i) {
-				Sequence seq = block->seqs()[i];
-				if (seq.length() == 0)
-					throw std::runtime_error("File format error: sequence of length 0");
-				push_seq(seq, block->ids()[i], block->ids().length(i), offset, pos_array, *out, letters, n_seqs);
-			}
-			if (!config.prot_accession2taxid.empty()) {
-				timer.go("Writing accessions");
-				for (size_t i = 0; i < n; ++i) {
-					vector<string> acc = Util::Seq::accession_from_title(block->ids()[i], !config.no_parse_seqids, acc_stats);
-					for (const string& s : acc)
-						accessions.push(std::make_pair(s, total_seqs + i));
-				}
-			}
-			timer.go("Hashing sequences");
-			for (size_t i = 0; i < n; ++i) {
-				Sequence seq = block->seqs()[i];
-				MurmurHash3_x64_128(seq.data(), (int)seq.length(), header2.hash, header2.hash);
-				MurmurHash3_x64_128(block->ids()[i], block->ids().length(i), header2.hash, header2.hash);
-			}
-			delete block;
-			total_seqs += n;
-		}
+		write_seqs(db_file, *out, offset, 0, 0, pos_array, accessions, seqids, masks.get(), acc_stats, header2.hash, letters, n_seqs, timer);
 	}
 	catch (std::exception&) {
 		out->close();
@@ -350,6 +487,14 @@ void DatabaseFile::make_db()
 		serialize(*out, taxonomy.name_);
 	}
 
+	timer.go("Writing accession index");
+	write_accession_index(*out, seqids, nullptr, {}, stats);
+	if (masks) {
+		timer.go("Writing masking intervals");
+		masks->write(*out);
+		stats("Stored masked letters", masks->masked_letters());
+	}
+
 #ifdef EXTRA
     header2.db_type = config.dbtype;
 #endif
@@ -372,6 +517,275 @@ void DatabaseFile::make_db()
 	*message_stream << endl << stats;
 }
 
+static vector<OId> read_oid_list(const string& file_name, OId seqs) {
+	vector<OId> v;
+	if (file_name.empty())
+		return v;
+	File f(file_name, "rb", File::Flags::DETECT_COMPRESSION);
+	const char* l;
+	while (l = f.getline(), !f.eof() || l[0] != '\0') {
+		if (l[0] == '\0')
+			continue;
+		OId oid;
+		Util::String::Tokenizer<Util::String::CharDelimiter>(l, Util::String::CharDelimiter('\t')) >> oid;
+		if (oid >= seqs)
+			throw runtime_error("OID out of range in file " + file_name + ": " + std::to_string(oid));
+		v.push_back(oid);
+	}
+	f.close();
+	std::sort(v.begin(), v.end());
+	v.erase(std::unique(v.begin(), v.end()), v.end());
+	return v;
+}
+
+static void copy(File& in, int64_t offset, int64_t size, OutputFile& out) {
+	static const int64_t BUF_SIZE = 64 * MEGABYTES;
+	vector<char> buf((size_t)std::min(size, BUF_SIZE));
+	in.seek(offset);
+	while (size > 0) {
+		const int64_t n = std::min(size, BUF_SIZE);
+		in.read(buf.data(), n);
+		out.write(buf.data(), n);
+		size -= n;
+	}
+}
+
+void DatabaseFile::append_db()
+{
+	config.file_buffer_size = 4 * MEGABYTES;
+	const string input_file_name = ::input_file_name();
+
+	TaskTimer total;
+	TaskTimer timer("Opening the database file", true);
+	const string base = auto_append_extension_if_exists(config.database, FILE_EXTENSION);
+	DatabaseFile db(base);
+	const vector<string> volumes = volume_names(base);
+	const string volume_file_name = base + '.' + std::to_string(volumes.size());
+	int64_t volume_base = 0;
+	for (const string& v : volumes)
+		volume_base += file_size(v.c_str());
+	const OId old_seqs = (OId)db.sequence_count().value();
+	const vector<OId> removed = read_oid_list(config.remove_oids, old_seqs);
+
+	config.dbtype = db.db_version() == (int)ReferenceHeader::current_db_version_nucl ? SequenceType::nucleotide : SequenceType::amino_acid;
+	value_traits = (config.dbtype == SequenceType::amino_acid) ? amino_acid_traits : nucleotide_traits;
+	FastaFile db_file({ input_file_name }, Flags::NONE, value_traits);
+	db_file.flags() |= SequenceFile::Flags::ALL;
+	if (config.dbtype == SequenceType::nucleotide)
+		db_file.flags() |= SequenceFile::Flags::DNA_PRESERVATION;
+
+	unique_ptr<OutputFile> out(new OutputFile(volume_file_name));
+	ReferenceHeader header;
+	ReferenceHeader2 header2;
+	header.db_version = db.ref_header.db_version;
+	std::copy(db.header2.hash, db.header2.hash + sizeof(header2.hash), header2.hash);
+	*out << header;
+	*out << header2;
+
+	size_t letters = 0, n_seqs = 0, removed_letters = 0;
+	uint64_t offset = out->tell();
+	vector<SeqInfo> pos_array;
+	ExternalSorter<pair<string, OId>> accessions, seqids;
+	Util::Seq::AccessionParsing acc_stats;
+	Util::Table stats;
+	unique_ptr<StoredMasking::Writer> masks;
+	try {
+		// The stored masking of the existing database is carried over and extended to the appended sequences.
+		if (!config.precompute_masking.empty() && !db.stored_masking_)
+			throw runtime_error("The database does not contain masking intervals. Use diamond prepdb --precompute-masking after appending the sequences.");
+		if (db.stored_masking_) {
+			timer.go("Copying masking intervals");
+			const vector<MaskingAlgo> algos = db.stored_masking_->algos();
+			masks.reset(new StoredMasking::Writer(algos, Masking::get()));
+			for (size_t i = 0; i < algos.size(); ++i) {
+				const int stream = db.stored_masking_->stream(algos[i], Masking::get().fingerprint(algos[i]));
+				if (stream < 0)
+					throw runtime_error("The masking parameters differ from those of the masking intervals stored in the database.");
+				StoredMasking::Cursor cursor(*db.stored_masking_, stream);
+				for (OId oid = 0; oid < old_seqs; ++oid)
+					masks->push(i, cursor(oid));
+			}
+		}
+
+		write_seqs(db_file, *out, offset, volume_base, old_seqs, pos_array, accessions, seqids, masks.get(), acc_stats, header2.hash, letters, n_seqs, timer);
+
+		timer.go("Writing position array");
+		header.pos_array_offset = offset;
+		db.set_seqinfo_ptr(0);
+		db.init_seqinfo_access();
+		auto it = removed.cbegin();
+		for (OId oid = 0; oid < old_seqs; ++oid) {
+			SeqInfo r = db.read_seqinfo();
+			if (it != removed.cend() && *it == oid) {
+				if (!r.deleted())
+					removed_letters += r.seq_len;
+				r.flags |= SeqInfo::DELETED;
+				MurmurHash3_x64_128(&oid, sizeof(oid), header2.hash, header2.hash);
+				++it;
+			}
+			*out << r;
+		}
+		pos_array.emplace_back(volume_base + offset, 0);
+		for (const SeqInfo& r : pos_array)
+			*out << r;
+		pos_array.clear();
+		pos_array.shrink_to_fit();
+
+		const OId seqs = old_seqs + (OId)n_seqs;
+		taxonomy.init();
+		if (db.has_taxon_id_lists() || !config.prot_accession2taxid.empty()) {
+			timer.go("Writing taxon id list");
+			header2.taxon_array_offset = out->tell();
+			if (db.has_taxon_id_lists())
+				copy(db.file_, db.header2.taxon_array_offset, db.header2.taxon_array_size, *out);
+			else
+				for (OId i = 0; i < old_seqs; ++i)
+					write_varint(*out, 0);
+			if (!config.prot_accession2taxid.empty())
+				TaxonList::build(*out, accessions, seqs, stats, old_seqs);
+			else
+				for (OId i = old_seqs; i < seqs; ++i)
+					write_varint(*out, 0);
+			header2.taxon_array_size = out->tell() - header2.taxon_array_offset;
+		}
+		if (!config.nodesdmp.empty() || db.has_taxon_nodes()) {
+			timer.go("Writing taxonomy nodes");
+			unique_ptr<TaxonomyNodes> nodes;
+			if (config.nodesdmp.empty()) {
+				db.file_.seek(db.header2.taxon_nodes_offset);
+				nodes.reset(new TaxonomyNodes(db.file_, db.ref_header.build));
+			}
+			else
+				nodes.reset(new TaxonomyNodes(config.nodesdmp));
+			header2.taxon_nodes_offset = out->tell();
+			nodes->save(*out);
+		}
+		if (!config.namesdmp.empty()) {
+			header2.taxon_names_offset = out->tell();
+			serialize(*out, taxonomy.name_);
+		}
+		else if (db.has_taxon_scientific_names()) {
+			vector<string> names;
+			db.file_.seek(db.header2.taxon_names_offset);
+			deserialize(db.file_, names);
+			header2.taxon_names_offset = out->tell();
+			serialize(*out, names);
+		}
+		// Without an index for the existing volumes, prepdb needs to be run on the combined database.
+		if (db.accession_index_) {
+			timer.go("Writing accession index");
+			write_accession_index(*out, seqids, db.accession_index_.get(), removed, stats);
+		}
+		if (masks) {
+			timer.go("Writing masking intervals");
+			masks->write(*out);
+		}
+	}
+	catch (std::exception&) {
+		out->close();
+		out->remove();
+		throw;
+	}
+
+#ifdef EXTRA
+	header2.db_type = config.dbtype;
+#endif
+
+	timer.go("Closing the database file");
+	db_file.close();
+	header.letters = db.ref_header.letters - removed_letters + letters;
+	header.sequences = old_seqs + n_seqs;
+	out->seek(0);
+	*out << header;
+	*out << header2;
+	out->close();
+	db.close();
+	timer.finish();
+
+	stats("Database volume", volume_file_name);
+	stats("Appended sequences", n_seqs);
+	stats("Appended letters", letters);
+	stats("Removed sequences", removed.size());
+	stats("Database sequences", header.sequences);
+	stats("Database letters", header.letters);
+	stats("Database hash", hex_print(header2.hash, 16));
+	stats("Total time", total.get(), "s");
+
+	*message_stream << endl << stats;
+}
+
+void DatabaseFile::prep_db()
+{
+	TaskTimer total;
+	TaskTimer timer("Opening the database file", true);
+	const string base = auto_append_extension_if_exists(config.database, FILE_EXTENSION);
+	const string last_volume = volume_names(base).back();
+	DatabaseFile db(base);
+	config.dbtype = db.db_version() == (int)ReferenceHeader::current_db_version_nucl ? SequenceType::nucleotide : SequenceType::amino_acid;
+	const bool index = !db.accession_index_;
+	const vector<MaskingAlgo> mask_algos = db.stored_masking_ ? vector<MaskingAlgo>() : precompute_masking_algos();
+	if (!index && mask_algos.empty()) {
+		timer.finish();
+		*message_stream << "Database already contains an accession index" << (db.stored_masking_ ? " and masking intervals" : "") << ". No action was taken." << endl;
+		return;
+	}
+	const OId seqs = (OId)db.sequence_count().value();
+
+	timer.go("Reading position array");
+	vector<OId> deleted;
+	db.set_seqinfo_ptr(0);
+	db.init_seqinfo_access();
+	for (OId oid = 0; oid < seqs; ++oid)
+		if (db.read_seqinfo().deleted())
+			deleted.push_back(oid);
+
+	timer.go("Reading sequences");
+	ExternalSorter<pair<string, OId>> seqids;
+	unique_ptr<StoredMasking::Writer> masks(mask_algos.empty() ? nullptr : new StoredMasking::Writer(mask_algos, Masking::get()));
+	static const int64_t BATCH_LETTERS = 256 * MEGABYTES;
+	SequenceSet batch;
+	vector<Letter> seq;
+	string id;
+	db.init_seq_access();
+	for (OId oid = 0; oid < seqs; ++oid) {
+		db.read_seq(seq, id);
+		if (index && !std::binary_search(deleted.begin(), deleted.end(), oid))
+			seqids.push(std::make_pair(index_key(id.c_str()), oid));
+		if (masks) {
+			Masking::get().remove_bit_mask(seq.data(), seq.size());
+			batch.push_back(seq.begin(), seq.end());
+			if (batch.raw_len() >= BATCH_LETTERS || oid + 1 == seqs) {
+				timer.go("Computing masking intervals");
+				batch.finish_reserve();
+				masks->push(batch, config.threads_);
+				batch.clear();
+				timer.go("Reading sequences");
+			}
+		}
+	}
+	db.close();
+
+	// The sections are appended to the last volume, behind the data referenced by the database header.
+	Util::Table stats;
+	OutputFile out(last_volume, Compressor::NONE, "r+b");
+	out.seek(0, SEEK_END);
+	if (index) {
+		timer.go("Writing accession index");
+		write_accession_index(out, seqids, nullptr, {}, stats);
+	}
+	if (masks) {
+		timer.go("Writing masking intervals");
+		masks->write(out);
+		stats("Stored masked letters", masks->masked_letters());
+	}
+	out.close();
+	timer.finish();
+
+	stats("Database volume", last_volume);
+	stats("Total time", total.get(), "s");
+	*message_stream << endl << stats;
+}
+
 void DatabaseFile::set_seqinfo_ptr(OId i) {
 	pos_array_offset = ref_header.pos_array_offset + SeqInfo::SIZE * i;
 }
@@ -385,27 +799,39 @@ bool DatabaseFile::eof() const {
 }
 
 void DatabaseFile::init_seq_access() {
-	file_.seek(sizeof(ReferenceHeader) + sizeof(ReferenceHeader2) + 8);
+	current_volume_ = 0;
+	volume_file().seek(DATA_OFFSET);
 }
 
 bool DatabaseFile::read_seq(vector<Letter>& seq, string &id, std::vector<char>* quals)
 {
+	if (volumes_.size() > 1)
+		next_volume_if_at_end();
+	File& f = volume_file();
 	char c;
-	file_.read(c);
+	f.read(c);
 	seq.clear();
 	id.clear();
-	file_.read_to(std::back_inserter(seq), '\xff');
-	file_.read_to(std::back_inserter(id), '\0');
+	f.read_to(std::back_inserter(seq), '\xff');
+	f.read_to(std::back_inserter(id), '\0');
+	// File::read_to() keeps the delimiters.
+	if (!seq.empty() && seq.back() == '\xff')
+		seq.pop_back();
+	if (!id.empty() && id.back() == '\0')
+		id.pop_back();
 	return false;
 }
 
 void DatabaseFile::skip_seq()
 {
+	if (volumes_.size() > 1)
+		next_volume_if_at_end();
+	File& f = volume_file();
 	char c;
-	if(file_.read_max(&c, 1) != 1)
+	if(f.read_max(&c, 1) != 1)
 		throw std::runtime_error("Unexpected end of file.");
-	file_.getdelim('\xff');
-	file_.getdelim('\0');
+	f.getdelim('\xff');
+	f.getdelim('\0');
 }
 
 bool DatabaseFile::is_diamond_db(const string &file_name) {
@@ -521,27 +947,32 @@ void DatabaseFile::seek_chunk(const Chunk& chunk) {
 }
 
 size_t DatabaseFile::id_len(const SeqInfo& seq_info, const SeqInfo& seq_info_next) {
-	return seq_info_next.pos - seq_info.pos - seq_info.seq_len - 3;
+	// the next sequence may start in the following volume
+	const int64_t end = volumes_.size() > 1 ? std::min((int64_t)seq_info_next.pos, volumes_[volume_of(seq_info.pos)].data_end) : seq_info_next.pos;
+	return end - seq_info.pos - seq_info.seq_len - 3;
 }
 
 void DatabaseFile::seek_offset(size_t p) {
-	file_.seek(p);
+	current_volume_ = volume_of(p);
+	volume_file().seek(p - volumes_[current_volume_].base);
 }
 
 void DatabaseFile::read_seq_data(Letter* dst, size_t len, size_t& pos, bool seek) {
 	if (seek)
-		file_.seek(pos);
-	file_.read(dst - 1, len + 2);
+		seek_offset(pos);
+	else if (volumes_.size() > 1)
+		next_volume_if_at_end();
+	volume_file().read(dst - 1, len + 2);
 	*(dst - 1) = Sequence::DELIMITER;
 	*(dst + len) = Sequence::DELIMITER;
 }
 
 void DatabaseFile::read_id_data(const int64_t oid, char* dst, size_t len, bool all, bool full_titles) {
-	file_.read(dst, len + 1);
+	volume_file().read(dst, len + 1);
 }
 
 void DatabaseFile::skip_id_data() {
-	file_.getdelim('\0');
+	volume_file().getdelim('\0');
 }
 
 optional<uint64_t> DatabaseFile::sequence_count() const {
@@ -577,13 +1008,78 @@ DatabaseFile::~DatabaseFile()
 
 DbFilter* DatabaseFile::filter_by_accession(const std::string& file_name)
 {
-	throw std::runtime_error("The .dmnd database format does not support filtering by accession.");
-	return nullptr;
+	if (!accession_index_)
+		throw std::runtime_error("The database does not contain an accession index, which is required for filtering by accession. Use diamond prepdb to build the index.");
+	vector<string> accs;
+	File in(file_name, "rb", File::Flags::DETECT_COMPRESSION);
+	const char* l;
+	while (l = in.getline(), !in.eof() || l[0] != '\0')
+		if (l[0] != '\0')
+			accs.emplace_back(l);
+	in.close();
+
+	const vector<OId> oids = accession_index_->find(accs, config.threads_);
+	vector<OId> selected;
+	selected.reserve(oids.size());
+	for (size_t i = 0; i < accs.size(); ++i) {
+		if (oids[i] != AccessionIndex::NOT_FOUND)
+			selected.push_back(oids[i]);
+		else if (!config.skip_missing_seqids)
+			throw runtime_error("Accession not found in database: " + accs[i] + ". Use --skip-missing-seqids to ignore.");
+	}
+	std::sort(selected.begin(), selected.end());
+	selected.erase(std::unique(selected.begin(), selected.end()), selected.end());
+
+	DbFilter* v = new DbFilter(sequence_count().value());
+	set_seqinfo_ptr(0);
+	init_seqinfo_access();
+	OId oid = 0;
+	for (OId i : selected) {
+		if (i - oid > 256) {
+			set_seqinfo_ptr(i);
+			init_seqinfo_access();
+			oid = i;
+		}
+		for (; oid < i; ++oid)
+			read_seqinfo();
+		v->oid_filter.set(i);
+		v->letter_count += read_seqinfo().seq_len;
+		++oid;
+	}
+	return v;
+}
+
+vector<OId> DatabaseFile::accession_to_oid(const string& acc) const
+{
+	if (!accession_index_)
+		return SequenceFile::accession_to_oid(acc);
+	const vector<OId> r = accession_index_->find(acc);
+	if (r.empty())
+		throw runtime_error("Accession not found in database: " + acc);
+	return r;
+}
+
+bool DatabaseFile::has_accession_index() const {
+	return accession_index_ != nullptr;
+}
+
+bool DatabaseFile::has_stored_masking(MaskingAlgo algo) const {
+	return stored_masking_ && ref_header.db_version == ReferenceHeader::current_db_version_prot && stored_masking_->stream(algo, Masking::get().fingerprint(algo)) >= 0;
+}
+
+MaskingStat DatabaseFile::apply_stored_masking(Block& block, MaskingAlgo algo) {
+	const int stream = stored_masking_->stream(algo, Masking::get().fingerprint(algo));
+	if (stream < 0)
+		throw runtime_error("Missing stored masking intervals.");
+	MaskingStat stats;
+	stats.add(algo, stored_masking_->apply(block, stream, config.threads_));
+	block.set_masked();
+	return stats;
 }
 
 std::string DatabaseFile::file_name()
 {
-	return file_.name();
+	return file_name_;
 }
 
 std::vector<TaxId> DatabaseFile::taxids(size_t oid) const
@@ -642,6 +1138,14 @@ void DatabaseFile::read_seqid_list() {
 	}
 }
 
+void DatabaseFile::read_length_list() {
+	seq_length_.reserve(sequence_count().value());
+	set_seqinfo_ptr(0);
+	init_seqinfo_access();
+	for (uint64_t n = 0; n < sequence_count().value(); ++n)
+		seq_length_.push_back((Loc)read_seqinfo().seq_len);
+}
+
 TaxId DatabaseFile::max_taxid() const {
 	return taxon_nodes_->max();
 }
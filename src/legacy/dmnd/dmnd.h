@@ -18,12 +18,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #pragma once
+#include <map>
 #include <memory>
 #include <string>
 #include <stdint.h>
 #include "data/sequence_file.h"
 #include "data/taxon_list.h"
 #include "data/taxonomy_nodes.h"
+#include "accession_index.h"
+#include "stored_masking.h"
 
 struct ReferenceHeader
 {
@@ -101,6 +104,21 @@ struct DatabaseFile : public SequenceFile
 	virtual bool eof() const override;
 	virtual void init_seq_access() override;
 	static void make_db();
+	// Appends the sequences of --in to an existing database as a new volume, see volume_names().
+	static void append_db();
+	// Adds the accession index and the masking intervals of --precompute-masking to an existing database.
+	static void prep_db();
+	// A database consists of the base file and the delta volumes <base>.1, <base>.2, ... written by append_db().
+	// The last volume holds the position array, taxon list and taxonomy of the combined database.
+	static std::vector<std::string> volume_names(const std::string& file_name);
+
+	// Optional sections appended to the last volume behind the data referenced by the header, see AccessionIndex and
+	// StoredMasking. Each section ends with its total size and a magic number, so that the sections are located by
+	// walking back from the end of the file. Older versions ignore them.
+	struct TrailerSection {
+		uint64_t offset, size;
+	};
+	static std::map<uint64_t, TrailerSection> read_trailer(const std::string& file_name);
 
 	enum { min_build_required = 74, MIN_DB_VERSION = 2 };
 
@@ -141,6 +159,10 @@ struct DatabaseFile : public SequenceFile
 	virtual int build_version() override;
 	virtual ~DatabaseFile();
 	virtual DbFilter* filter_by_accession(const std::string& file_name) override;
+	virtual std::vector<OId> accession_to_oid(const std::string& acc) const override;
+	virtual bool has_accession_index() const override;
+	virtual bool has_stored_masking(MaskingAlgo algo) const override;
+	virtual MaskingStat apply_stored_masking(Block& block, MaskingAlgo algo) override;
 	virtual std::string file_name() override;
 	virtual std::vector<TaxId> taxids(size_t oid) const override;
 	virtual void seq_data(size_t oid, std::vector<Letter>& dst) override;
@@ -151,16 +173,36 @@ struct DatabaseFile : public SequenceFile
 	virtual void print_info() const override;
 
 	static const char* FILE_EXTENSION;
+	static constexpr int64_t DATA_OFFSET = sizeof(ReferenceHeader) + sizeof(ReferenceHeader2) + 8;
 
 private:
 
+	struct Volume {
+		File* file;
+		int64_t base, data_begin, data_end;
+	};
+
 	File file_;
+	const std::string file_name_;
+	std::vector<std::unique_ptr<File>> volume_files_;
+	std::vector<Volume> volumes_;
+	size_t current_volume_;
+
+	void init_volumes();
+	File& volume_file() {
+		return *volumes_[current_volume_].file;
+	}
+	size_t volume_of(int64_t p) const;
+	void next_volume_if_at_end();
 
 	void init(Flags flags = Flags::NONE);
 	void read_seqid_list();
+	void read_length_list();
 
 	std::unique_ptr<TaxonList> taxon_list_;
 	std::vector<std::string> taxon_scientific_names_;
 	std::unique_ptr<TaxonomyNodes> taxon_nodes_;
+	std::unique_ptr<AccessionIndex> accession_index_;
+	std::unique_ptr<StoredMasking> stored_masking_;
 
 };
\ No newline at end of file
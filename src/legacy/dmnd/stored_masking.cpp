@@ -0,0 +1,206 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "stored_masking.h"
+#include "masking/masking.h"
+#include "data/block/block.h"
+#include "util/algo/varint.h"
+#include "mio/mmap.hpp"
+
+using std::string;
+using std::vector;
+using std::runtime_error;
+
+static void put(vector<char>& buf, uint32_t x) {
+	char tmp[5];
+	buf.insert(buf.end(), tmp, write_varuint32(x, tmp));
+}
+
+static uint32_t get(const char*& ptr) {
+	const std::pair<uint32_t, const char*> r = read_varuint32(ptr);
+	ptr = r.second;
+	return r.first;
+}
+
+StoredMasking::Writer::Writer(const vector<MaskingAlgo>& algos, const Masking& masking):
+	masking_(masking),
+	masked_letters_(0)
+{
+	for (MaskingAlgo algo : algos)
+		streams_.push_back({ algo, masking.fingerprint(algo), 0 });
+}
+
+void StoredMasking::Writer::push(size_t stream, const Intervals& intervals) {
+	StreamData& s = streams_[stream];
+	if (s.seqs % SAMPLE == 0)
+		s.samples.push_back(s.data.size());
+	put(s.data, (uint32_t)intervals.size());
+	Loc end = 0;
+	for (const auto& i : intervals) {
+		put(s.data, i.first - end);
+		put(s.data, i.second - i.first);
+		end = i.second;
+		masked_letters_ += i.second - i.first;
+	}
+	++s.seqs;
+}
+
+void StoredMasking::Writer::push(const SequenceSet& seqs, int threads) {
+	const BlockId n = seqs.size();
+	vector<Intervals> intervals(n);
+	for (size_t stream = 0; stream < streams_.size(); ++stream) {
+		std::atomic<BlockId> next(0);
+		auto worker = [&]() {
+			BlockId i;
+			while ((i = next.fetch_add(1, std::memory_order_relaxed)) < n) {
+				const Mask::Ranges r = masking_.intervals(seqs.ptr(i), seqs.length(i), streams_[stream].algo);
+				intervals[i].assign(r.begin(), r.end());
+			}
+		};
+		vector<std::thread> t;
+		for (int i = 0; i < threads; ++i)
+			t.emplace_back(worker);
+		for (auto& i : t)
+			i.join();
+		for (BlockId i = 0; i < n; ++i)
+			push(stream, intervals[i]);
+	}
+}
+
+void StoredMasking::Writer::write(OutputFile& out) {
+	vector<Stream> dir;
+	uint64_t size = 0;
+	for (StreamData& s : streams_) {
+		if (s.seqs != streams_.front().seqs)
+			throw runtime_error("Masking streams differ in sequence count.");
+		out.write(s.data.data(), s.data.size());
+		out.write(s.samples.data(), s.samples.size());
+		dir.push_back({ (uint64_t)s.algo, s.fingerprint, size, size + s.data.size() });
+		size += s.data.size() + s.samples.size() * sizeof(uint64_t);
+		s.data.clear();
+		s.data.shrink_to_fit();
+		s.samples.clear();
+		s.samples.shrink_to_fit();
+	}
+	out.write(dir.data(), dir.size());
+	size += dir.size() * sizeof(Stream) + sizeof(Footer);
+	const Footer footer{ streams_.empty() ? 0 : streams_.front().seqs, streams_.size(), size, Footer::MAGIC };
+	out.write(&footer, 1);
+}
+
+StoredMasking::Cursor::Cursor(const StoredMasking& masking, size_t stream):
+	masking_(masking),
+	stream_(masking.stream_info(stream)),
+	oid_(0),
+	ptr_(nullptr)
+{}
+
+const StoredMasking::Intervals& StoredMasking::Cursor::operator()(OId oid) {
+	if (oid >= masking_.footer_.seqs)
+		throw runtime_error("OId out of range for stored masking.");
+	if (ptr_ == nullptr || oid < oid_ || oid - oid_ >= SAMPLE) {
+		uint64_t offset;
+		memcpy(&offset, masking_.data_ + stream_.samples_offset + oid / SAMPLE * sizeof(uint64_t), sizeof(offset));
+		ptr_ = masking_.data_ + stream_.data_offset + offset;
+		oid_ = oid / SAMPLE * SAMPLE;
+	}
+	for (; oid_ < oid; ++oid_)
+		for (uint32_t n = get(ptr_) * 2; n > 0; --n)
+			get(ptr_);
+	intervals_.clear();
+	Loc end = 0;
+	for (uint32_t n = get(ptr_); n > 0; --n) {
+		const Loc begin = end + (Loc)get(ptr_);
+		end = begin + (Loc)get(ptr_);
+		intervals_.emplace_back(begin, end);
+	}
+	++oid_;
+	return intervals_;
+}
+
+StoredMasking::StoredMasking(const string& file_name, uint64_t offset, uint64_t size):
+	mmap_(new mio::mmap_source(file_name, offset, size)),
+	data_(mmap_->data())
+{
+	memcpy(&footer_, data_ + size - sizeof(Footer), sizeof(Footer));
+	if (footer_.magic != Footer::MAGIC || footer_.size != size)
+		throw runtime_error("Invalid masking section in database file: " + file_name);
+}
+
+StoredMasking::~StoredMasking() {}
+
+StoredMasking::Stream StoredMasking::stream_info(size_t i) const {
+	Stream s;
+	memcpy(&s, data_ + footer_.size - sizeof(Footer) - (footer_.streams - i) * sizeof(Stream), sizeof(Stream));
+	return s;
+}
+
+int StoredMasking::stream(MaskingAlgo algo, uint64_t fingerprint) const {
+	for (size_t i = 0; i < footer_.streams; ++i) {
+		const Stream s = stream_info(i);
+		if (s.algo == (uint64_t)algo && s.fingerprint == fingerprint)
+			return (int)i;
+	}
+	return -1;
+}
+
+vector<MaskingAlgo> StoredMasking::algos() const {
+	vector<MaskingAlgo> v;
+	for (size_t i = 0; i < footer_.streams; ++i)
+		v.push_back((MaskingAlgo)stream_info(i).algo);
+	return v;
+}
+
+uint64_t StoredMasking::apply(Block& block, size_t stream, int threads, MaskingTable* table) const {
+	// Block ids in OId order, so that each thread decodes a contiguous part of the stream.
+	const BlockId n = block.seqs().size();
+	vector<std::pair<OId, BlockId>> order;
+	order.reserve(n);
+	for (BlockId i = 0; i < n; ++i)
+		order.emplace_back(block.block_id2oid(i), i);
+	std::sort(order.begin(), order.end());
+	std::atomic<uint64_t> letters(0);
+	auto worker = [&](BlockId begin, BlockId end) {
+		Cursor cursor(*this, stream);
+		uint64_t l = 0;
+		for (BlockId i = begin; i < end; ++i) {
+			const BlockId block_id = order[i].second;
+			Letter* seq = block.seqs().ptr(block_id);
+			for (const auto& r : cursor(order[i].first)) {
+				if (table)
+					table->add(block_id, r.first, r.second, seq);
+				else
+					std::fill(seq + r.first, seq + r.second, value_traits.mask_char);
+				l += r.second - r.first;
+			}
+		}
+		letters += l;
+	};
+	const BlockId t = std::max(std::min((BlockId)threads, n / (BlockId)SAMPLE), (BlockId)1);
+	vector<std::thread> workers;
+	for (BlockId i = 0; i < t; ++i)
+		workers.emplace_back(worker, (BlockId)((int64_t)n * i / t), (BlockId)((int64_t)n * (i + 1) / t));
+	for (auto& w : workers)
+		w.join();
+	return letters;
+}
@@ -0,0 +1,111 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "basic/value.h"
+#include "masking/def.h"
+#include "util/io/output_file.h"
+#include "mio/forward.h"
+
+struct Masking;
+struct MaskingTable;
+struct SequenceSet;
+struct Block;
+
+// Precomputed masking intervals of the database sequences, stored as a trailer section of the last volume of a .dmnd
+// database, see DatabaseFile::read_trailer(). The section holds one stream per masking algorithm, tagged with a
+// fingerprint of the masking parameters. A stream contains the varint coded intervals of all OIds in OId order and the
+// stream offset of every SAMPLE-th OId.
+struct StoredMasking {
+
+	struct Footer {
+		uint64_t seqs, streams, size, magic;
+		static constexpr uint64_t MAGIC = 0x5e0b3a1c7d2f4869llu;
+	};
+
+	struct Stream {
+		uint64_t algo, fingerprint, data_offset, samples_offset;
+	};
+
+	using Intervals = std::vector<std::pair<Loc, Loc>>;
+
+	struct Writer {
+		Writer(const std::vector<MaskingAlgo>& algos, const Masking& masking);
+		// Computes the intervals of the next sequences in OId order.
+		void push(const SequenceSet& seqs, int threads);
+		// Appends the intervals of the next OId to a stream.
+		void push(size_t stream, const Intervals& intervals);
+		size_t stream_count() const {
+			return streams_.size();
+		}
+		uint64_t masked_letters() const {
+			return masked_letters_;
+		}
+		void write(OutputFile& out);
+	private:
+		struct StreamData {
+			MaskingAlgo algo;
+			uint64_t fingerprint, seqs;
+			std::vector<char> data;
+			std::vector<uint64_t> samples;
+		};
+		const Masking& masking_;
+		std::vector<StreamData> streams_;
+		uint64_t masked_letters_;
+	};
+
+	// Sequential decoding of the intervals of a stream. Access is fastest for ascending OIds.
+	struct Cursor {
+		Cursor(const StoredMasking& masking, size_t stream);
+		const Intervals& operator()(OId oid);
+	private:
+		const StoredMasking& masking_;
+		const Stream stream_;
+		OId oid_;
+		const char* ptr_;
+		Intervals intervals_;
+	};
+
+	static constexpr OId SAMPLE = 64;
+
+	// Maps the section at the given file offset.
+	StoredMasking(const std::string& file_name, uint64_t offset, uint64_t size);
+	~StoredMasking();
+	// Returns the stream computed with the given algorithm and parameter fingerprint or -1.
+	int stream(MaskingAlgo algo, uint64_t fingerprint) const;
+	std::vector<MaskingAlgo> algos() const;
+	uint64_t seqs() const {
+		return footer_.seqs;
+	}
+	// Hard masks the sequences of a block. If a table is given, the masked letters are recorded to allow restoring them.
+	uint64_t apply(Block& block, size_t stream, int threads, MaskingTable* table = nullptr) const;
+
+private:
+
+	Stream stream_info(size_t i) const;
+
+	Footer footer_;
+	std::unique_ptr<mio::mmap_source> mmap_;
+	const char* data_;
+
+};
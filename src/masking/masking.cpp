@@ -15,6 +15,7 @@ limitations under the License.
 ****/
 // SPDX-License-Identifier: Apache-2.0
 
+#include <algorithm>
 #include <atomic>
 #include <numeric>
 #include <thread>
@@ -24,6 +25,7 @@ limitations under the License.
 #include "blast/blast_filter.h"
 #include "data/sequence_set.h"
 #include "basic/config.h"
+#include "murmurhash/MurmurHash3.h"
 
 using std::unique_ptr;
 using std::atomic;
@@ -217,6 +219,40 @@ void Masking::remove_bit_mask(Letter *seq, size_t len) const
 			seq[i] &= ~bit_mask;
 }
 
+Mask::Ranges Masking::intervals(const Letter* seq, size_t len, const MaskingAlgo algo) const {
+	Mask::Ranges r;
+	if (algo == MaskingAlgo::TANTAN)
+		r = Util::tantan::mask(const_cast<Letter*>(seq), (int)len, (const float**)probMatrixPointersf_, 0.005f, 0.05f, 1.0f / 0.9f, (float)config.tantan_minMaskProb, 0);
+	else if (algo == MaskingAlgo::SEG) {
+		BlastSeqLoc* seg_locs;
+		SeqBufferSeg((uint8_t*)seq, (uint32_t)len, 0u, blast_seg_, &seg_locs);
+		vector<pair<Loc, Loc>> v;
+		for (BlastSeqLoc* l = seg_locs; l; l = l->next)
+			v.emplace_back(l->ssr->left, l->ssr->right + 1);
+		BlastSeqLocFree(seg_locs);
+		std::sort(v.begin(), v.end());
+		for (const auto& i : v)
+			if (r.empty() || i.first > r.back().second)
+				r.push_back(i.first, i.second);
+			else
+				r.back().second = std::max(r.back().second, i.second);
+	}
+	else
+		throw std::runtime_error("Masking::intervals: unsupported algorithm.");
+	return r;
+}
+
+uint64_t Masking::fingerprint(const MaskingAlgo algo) const {
+	uint64_t h[2] = { (uint64_t)algo, 0 };
+	if (algo == MaskingAlgo::TANTAN) {
+		const double p = config.tantan_minMaskProb;
+		MurmurHash3_x64_128(&p, sizeof(p), (const char*)h, h);
+		for (unsigned i = 0; i < value_traits.alphabet_size; ++i)
+			MurmurHash3_x64_128(likelihoodRatioMatrixf_[i], (int)(value_traits.alphabet_size * sizeof(float)), (const char*)h, h);
+	}
+	return h[0];
+}
+
 MaskingStat mask_seqs(SequenceSet &seqs, const Masking &masking, bool hard_mask, const MaskingAlgo algo, MaskingTable* table)
 {
 	MaskingStat stats_all;
@@ -43,6 +43,10 @@ struct Masking
 	void mask_bit(Letter *seq, size_t len) const;
 	void bit_to_hard_mask(Letter *seq, size_t len, size_t &n) const;
 	void remove_bit_mask(Letter *seq, size_t len) const;
+	// Returns the intervals that operator() masks, without modifying the sequence.
+	Mask::Ranges intervals(const Letter* seq, size_t len, const MaskingAlgo algo) const;
+	// Identifies the parameters that determine the intervals of an algorithm.
+	uint64_t fingerprint(const MaskingAlgo algo) const;
 	static const Masking& get()
 	{
 		return *instance;
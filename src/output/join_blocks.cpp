@@ -17,7 +17,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ****/
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include "output.h"
 #include "util/io/temp_file.h"
@@ -28,6 +32,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "legacy/util/task_queue.h"
 #include "data/taxonomy_nodes.h"
 #include "util/parallel/simple_thread_pool.h"
+#include "util/data_structures/loser_tree.h"
 
 using std::thread;
 using std::unique_ptr;
@@ -35,6 +40,103 @@ using std::set;
 using std::string;
 using std::vector;
 
+// Reads the records of one reference block file on a background thread, keeping up to
+// READ_AHEAD bytes queued ahead of the merge.
+struct BlockReader
+{
+	BlockReader(File* file):
+		file_(file),
+		queued_bytes_(0),
+		stop_(false),
+		thread_(&BlockReader::read_loop, this)
+	{}
+
+	~BlockReader()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mtx_);
+			stop_ = true;
+		}
+		not_full_.notify_one();
+		thread_.join();
+	}
+
+	uint32_t query_id()
+	{
+		std::unique_lock<std::mutex> lock(mtx_);
+		not_empty_.wait(lock, [this] { return !queue_.empty() || error_; });
+		if (error_)
+			std::rethrow_exception(error_);
+		return queue_.front().query_id;
+	}
+
+	void pop(BinaryBuffer& dst)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mtx_);
+			dst.swap(queue_.front().data);
+			queued_bytes_ -= dst.size();
+			queue_.pop_front();
+		}
+		not_full_.notify_one();
+	}
+
+private:
+
+	static const size_t READ_AHEAD = 4 * MEGABYTES;
+
+	struct Record {
+		uint32_t query_id;
+		BinaryBuffer data;
+	};
+
+	void read_loop()
+	{
+		try {
+			uint32_t query_id, size;
+			file_->read(&query_id, sizeof(uint32_t));
+			while (true) {
+				Record r{ query_id, BinaryBuffer() };
+				if (query_id != IntermediateRecord::FINISHED) {
+					file_->read(&size, sizeof(uint32_t));
+					r.data.resize(size);
+					file_->read(r.data.data(), size);
+					file_->read(&query_id, sizeof(uint32_t));
+				}
+				const bool finished = r.query_id == IntermediateRecord::FINISHED;
+				{
+					std::unique_lock<std::mutex> lock(mtx_);
+					not_full_.wait(lock, [this] { return stop_ || queued_bytes_ < READ_AHEAD; });
+					if (stop_)
+						return;
+					queued_bytes_ += r.data.size();
+					queue_.push_back(std::move(r));
+				}
+				not_empty_.notify_one();
+				if (finished)
+					return;
+			}
+		}
+		catch (...) {
+			{
+				std::lock_guard<std::mutex> lock(mtx_);
+				error_ = std::current_exception();
+			}
+			not_empty_.notify_one();
+		}
+	}
+
+	File* file_;
+	std::deque<Record> queue_;
+	size_t queued_bytes_;
+	bool stop_;
+	std::exception_ptr error_;
+	std::mutex mtx_;
+	std::condition_variable not_empty_, not_full_;
+	std::thread thread_;
+
+};
+
 struct JoinFetcher
 {
 	static void init(const vector<File*> &tmp_file)
@@ -42,48 +144,34 @@ struct JoinFetcher
 		for (vector<File*>::const_iterator i = tmp_file.begin(); i != tmp_file.end(); ++i) {
 			(*i)->rewind();
 			files.push_back(*i);
-			query_ids.push_back(0);
-			files.back()->read(&query_ids.back(), sizeof(uint32_t));
-
 		}
-		query_last = (unsigned)-1;
+		init_readers();
 	}
 
 	static void init(const vector<string> & tmp_file_names)
 	{
-		for (auto file_name : tmp_file_names) {
+		for (auto file_name : tmp_file_names)
 			files.push_back(new File(file_name, "rb"));
-			query_ids.push_back(0);
-			files.back()->read(&query_ids.back(), sizeof(uint32_t));
-		}
-		query_last = (unsigned)-1;
+		init_readers();
 	}
 
 	static void finish()
 	{
+		tree.reset();
+		readers.clear();
 		for (vector<File*>::iterator i = files.begin(); i != files.end(); ++i) {
 			(*i)->close();
 			delete* i;
 		}
 		files.clear();
-		query_ids.clear();
 	}
 	static uint32_t next()
 	{
-		return *std::min_element(query_ids.begin(), query_ids.end());
+		return tree->min();
 	}
 	static size_t block_count() {
 		return files.size();
 	}
-	void fetch(unsigned b)
-	{
-		uint32_t size;
-		files[b]->read(&size, sizeof(uint32_t));
-		buf[b].clear();
-		buf[b].resize(size);
-		files[b]->read(buf[b].data(), size);
-		files[b]->read(&query_ids[b], sizeof(uint32_t));
-	}
 	JoinFetcher(size_t blocks):
 		buf(blocks)
 	{}
@@ -92,22 +180,40 @@ struct JoinFetcher
 		query_id = next();
 		unaligned_from = query_last + 1;
 		query_last = query_id;
-		for (unsigned i = 0; i < buf.size(); ++i)
-			if (query_ids[i] == query_id && query_id != IntermediateRecord::FINISHED)
-				fetch(i);
-			else
-				buf[i].clear();
+		for (BinaryBuffer& b : buf)
+			b.clear();
+		while (query_id != IntermediateRecord::FINISHED && tree->min() == query_id) {
+			const size_t b = tree->min_index();
+			readers[b]->pop(buf[b]);
+			tree->replace_min(readers[b]->query_id());
+		}
 		return next() != IntermediateRecord::FINISHED;
 	}
 	static vector<File*> files;
-	static vector<uint32_t> query_ids;
+	static vector<unique_ptr<BlockReader>> readers;
+	static unique_ptr<LoserTree<uint32_t>> tree;
 	static unsigned query_last;
 	vector<BinaryBuffer> buf;
 	uint32_t query_id, unaligned_from;
+
+private:
+
+	static void init_readers()
+	{
+		vector<uint32_t> query_ids;
+		for (File* f : files)
+			readers.emplace_back(new BlockReader(f));
+		for (auto& r : readers)
+			query_ids.push_back(r->query_id());
+		tree.reset(new LoserTree<uint32_t>(query_ids));
+		query_last = (unsigned)-1;
+	}
+
 };
 
 vector<File*> JoinFetcher::files;
-vector<unsigned> JoinFetcher::query_ids;
+vector<unique_ptr<BlockReader>> JoinFetcher::readers;
+unique_ptr<LoserTree<uint32_t>> JoinFetcher::tree;
 unsigned JoinFetcher::query_last;
 
 struct JoinWriter
@@ -339,7 +445,7 @@ void join_blocks(int64_t ref_blocks, File &master_out, const vector<File*> &tmp_
 	const vector<string> tmp_file_names)
 {
 	if (*cfg.output_format != OutputFormat::daa)
-		cfg.db->init_random_access(cfg.current_query_block, config.multiprocessing ? tmp_file_names.size() : tmp_file.size());
+		cfg.db->init_random_access(cfg.current_query_block, tmp_file_names.empty() ? tmp_file.size() : tmp_file_names.size());
 	TaskTimer timer("Joining output blocks");
 
 	if (tmp_file_names.size() > 0) {
@@ -0,0 +1,201 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include "checkpoint.h"
+#include "config.h"
+#include "basic/config.h"
+#include "basic/const.h"
+#include "data/sequence_file.h"
+#include "output/output_format.h"
+#include "util/log_stream.h"
+#include "util/parallel/multiprocessing.h"
+#include "util/system/system.h"
+
+using std::string;
+using std::vector;
+using std::set;
+using std::pair;
+using std::endl;
+using std::runtime_error;
+
+namespace Search { namespace Checkpoint {
+
+static const char* const MANIFEST = "manifest";
+// Options that do not change the results, so that a run can be resumed with different resources.
+static const set<string> IGNORED_OPTIONS = { "--checkpoint", "--threads", "-p", "--tmpdir", "-t", "--memory-limit", "-M", "--trace-events" };
+static const set<string> IGNORED_FLAGS = { "--log", "--verbose", "-v", "--quiet", "--perf-counters" };
+
+// Block pairs whose files are deleted by finish().
+static set<pair<int64_t, int64_t>> pairs_;
+
+bool enabled() {
+	return !config.checkpoint.empty();
+}
+
+// 64 bit FNV-1a hash.
+static uint64_t hash(const string& s, uint64_t h = 0xcbf29ce484222325ULL) {
+	for (char c : s) {
+		h ^= (unsigned char)c;
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+static string hex(uint64_t h) {
+	std::ostringstream s;
+	s << std::hex << std::setw(16) << std::setfill('0') << h;
+	return s.str();
+}
+
+static string parameters() {
+	std::istringstream in(config.invocation);
+	string token, s;
+	in >> token;
+	while (in >> token) {
+		if (IGNORED_OPTIONS.find(token) != IGNORED_OPTIONS.end())
+			in >> token;
+		else if (IGNORED_FLAGS.find(token) == IGNORED_FLAGS.end())
+			s += token + ' ';
+	}
+	return s;
+}
+
+static string database(const Config& cfg) {
+	std::ostringstream s;
+	const string file_name = cfg.db->file_name();
+	s << file_name << ' ' << (exists(file_name) ? file_size(file_name.c_str()) : 0) << ' ' << cfg.db->sequence_count().value_or(0) << ' '
+		<< cfg.db->letters().value_or(0) << ' ' << config.chunk_size;
+	if (cfg.db_filter)
+		s << ' ' << cfg.db_filter->oid_filter.one_count() << ' ' << cfg.db_filter->letter_count;
+	return s.str();
+}
+
+static string query(const Config& cfg) {
+	if (cfg.self)
+		return "self";
+	std::ostringstream s;
+	for (const string& f : config.query_file)
+		s << f << ' ' << file_size(f.c_str()) << ' ';
+	return s.str();
+}
+
+static string marker(int64_t query_block, int64_t ref_block) {
+	return join_path(config.checkpoint, append_label("block_", query_block) + append_label("_", ref_block) + ".done");
+}
+
+// Writes the file under a temporary name and renames it, so that it either exists completely or not at all.
+static void write_atomic(const string& file_name, const string& content) {
+	const string tmp = file_name + ".tmp";
+	{
+		std::ofstream f(tmp);
+		f << content;
+		f.close();
+		if (!f)
+			throw runtime_error("Error writing file " + tmp);
+	}
+	if (std::rename(tmp.c_str(), file_name.c_str()) != 0)
+		throw runtime_error("Error renaming file " + tmp);
+}
+
+void open(const Config& cfg) {
+	if (config.multiprocessing)
+		throw runtime_error("--checkpoint is not compatible with --multiprocessing.");
+	if (config.global_ranking_targets)
+		throw runtime_error("--checkpoint is not compatible with --global-ranking.");
+	if (config.stream_queries)
+		throw runtime_error("--checkpoint is not compatible with --stream.");
+	if (*cfg.output_format == OutputFormat::daa)
+		throw runtime_error("--checkpoint is not compatible with the DAA format.");
+	if (cfg.track_aligned_queries)
+		throw runtime_error("--checkpoint is not compatible with --un, --al and iterated searches.");
+	if (!cfg.self && (config.query_file.empty() || config.query_file.front().empty()))
+		throw runtime_error("--checkpoint requires a query file (--query).");
+
+	mkdir(config.checkpoint);
+	const vector<string> manifest{ string("version ") + Const::version_string,
+		"parameters " + hex(hash(parameters())),
+		"database " + hex(hash(database(cfg))),
+		"query " + hex(hash(query(cfg))) };
+	const string file_name = join_path(config.checkpoint, MANIFEST);
+	if (!exists(file_name)) {
+		std::ostringstream s;
+		for (const string& line : manifest)
+			s << line << endl;
+		write_atomic(file_name, s.str());
+		*message_stream << "Checkpoint directory: " << config.checkpoint << endl;
+		return;
+	}
+	std::ifstream f(file_name);
+	string line;
+	for (const string& expected : manifest) {
+		if (!std::getline(f, line))
+			throw runtime_error("Checkpoint manifest is corrupted: " + file_name);
+		if (line != expected)
+			throw runtime_error("The checkpoint in " + config.checkpoint + " was written by a different run (mismatch of "
+				+ expected.substr(0, expected.find(' ')) + "). Use a new directory or delete it to start over.");
+	}
+	*message_stream << "Resuming from checkpoint directory: " << config.checkpoint << endl;
+}
+
+bool done(int64_t query_block, int64_t ref_block) {
+	std::ifstream f(marker(query_block, ref_block));
+	if (!f)
+		return false;
+	uint64_t size;
+	string file_name;
+	while (f >> size && f.get() == ' ' && std::getline(f, file_name))
+		if (!exists(file_name) || file_size(file_name.c_str()) != size)
+			return false;
+	if (!f.eof())
+		return false;
+	pairs_.emplace(query_block, ref_block);
+	return true;
+}
+
+void commit(int64_t query_block, int64_t ref_block, const vector<string>& files) {
+	std::ostringstream s;
+	for (const string& f : files)
+		s << file_size(f.c_str()) << ' ' << f << endl;
+	write_atomic(marker(query_block, ref_block), s.str());
+	pairs_.emplace(query_block, ref_block);
+}
+
+void finish() {
+	for (const auto& p : pairs_) {
+		const string m = marker(p.first, p.second);
+		std::ifstream f(m);
+		uint64_t size;
+		string file_name;
+		while (f >> size && f.get() == ' ' && std::getline(f, file_name))
+			remove_tmp_file(file_name);
+		f.close();
+		remove_tmp_file(m);
+	}
+	pairs_.clear();
+	remove_tmp_file(join_path(config.checkpoint, MANIFEST));
+	rmdir(config.checkpoint);
+}
+
+}}
@@ -0,0 +1,45 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// Resumable blocked runs (--checkpoint). The intermediate output and the dictionary of every (query block, reference block)
+// pair are written to the checkpoint directory and committed by a marker file that is renamed into place after both files
+// have been closed. The marker lists the committed files with their sizes, so that a pair is only skipped if its files are
+// complete. A manifest identifies the parameters, database and query input of the run; a restarted run verifies it, skips
+// the committed pairs and resumes with the remaining reference blocks and the joins.
+namespace Search {
+
+struct Config;
+
+namespace Checkpoint {
+
+bool enabled();
+// Checks the compatibility of the run with checkpointing and writes or verifies the manifest.
+void open(const Config& cfg);
+// Returns true if the pair has been committed by a previous run and its files are intact.
+bool done(int64_t query_block, int64_t ref_block);
+void commit(int64_t query_block, int64_t ref_block, const std::vector<std::string>& files);
+// Deletes the checkpoint after the output has been completed.
+void finish();
+
+}}
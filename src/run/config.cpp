@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ****/
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <thread>
 #include "config.h"
 #include "basic/config.h"
 #include "data/block/block.h"
@@ -30,6 +31,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "search/search.h"
 #include "masking/masking.h"
 #include "align/def.h"
+#include "util/system/numa.h"
 
 #ifdef WITH_DNA
 #include "../dna/extension.h"
@@ -173,8 +175,39 @@ Config::~Config() {
 
 }
 
+void Config::replicate_target() {
+	const int n = Util::Numa::nodes();
+	target_replicas.clear();
+	target_replicas.resize(n);
+	std::vector<std::exception_ptr> exceptions(n);
+	std::vector<std::thread> threads;
+	for (int i = 0; i < n; ++i)
+		threads.emplace_back([this, i, &exceptions] {
+		try {
+			// the copy is first touched by a thread running on the node, so its pages are allocated there
+			Util::Numa::pin_thread(i);
+			target_replicas[i].reset(new SequenceSet(target->seqs()));
+		}
+		catch (...) {
+			exceptions[i] = std::current_exception();
+		}
+		});
+	for (auto& t : threads)
+		t.join();
+	for (const auto& e : exceptions)
+		if (e)
+			std::rethrow_exception(e);
+}
+
+const SequenceSet& Config::target_seqs(int numa_node) const {
+	if (numa_node >= 0 && numa_node < (int)target_replicas.size() && target_replicas[numa_node])
+		return *target_replicas[numa_node];
+	return target->seqs();
+}
+
 void Config::free()
 {
+	resident_target.reset();
 }
 
 }
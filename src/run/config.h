@@ -34,6 +34,7 @@ struct SequenceFile;
 struct Consumer;
 struct TextInputFile;
 struct Block;
+struct SequenceSet;
 struct TaxonomyNodes;
 struct ThreadPool;
 struct OutputFormat;
@@ -45,9 +46,6 @@ namespace Search {
 	struct HitBuffer;
 }
 
-struct Async;
-template<typename T, size_t E, typename Sync> struct Deque;
-
 namespace Extension {
 	enum class Mode;
 	namespace GlobalRanking {
@@ -86,7 +84,6 @@ struct Hit;
 struct Config {
 
 	using RankingTable = std::vector<Extension::GlobalRanking::Hit>;
-	using RankingBuffer = Deque<Search::Hit, 28, Async>;
 
 	Config(std::unique_ptr<std::vector<BitVector>>& target_seed_hits);
 	void free();
@@ -123,9 +120,10 @@ struct Config {
 	std::shared_ptr<DbFilter>                  db_filter;
 
 	std::shared_ptr<Block>                     query, target;
+	// Reference block kept in memory across streamed query micro-batches (--stream).
+	std::shared_ptr<Block>                     resident_target;
 	std::unique_ptr<std::vector<bool>>         query_skip;
 	std::unique_ptr<HitBuffer>                 seed_hit_buf;
-	std::unique_ptr<RankingBuffer>             global_ranking_buffer;
 	std::unique_ptr<RankingTable>              ranking_table;
 	std::unique_ptr<std::vector<BitVector>>&   target_seed_hits;
 	
@@ -158,6 +156,12 @@ struct Config {
 	std::unique_ptr<ThreadPool>                thread_pool;
 	SimpleThreadPool                           search_pool;
 
+	// Per-NUMA node copies of the reference sequences used by the seed search (--numa).
+	std::vector<std::unique_ptr<SequenceSet>>  target_replicas;
+
+	void replicate_target();
+	const SequenceSet& target_seqs(int numa_node) const;
+
 	bool iterated() const {
 		return sensitivity.size() > 1;
 	}
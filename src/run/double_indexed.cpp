@@ -32,15 +32,19 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util/parallel/multiprocessing.h"
 #include "util/parallel/parallelizer.h"
 #include "util/system/system.h"
+#include "util/memory/governor.h"
 #include "data/seed_set.h"
 #include "align/global_ranking/global_ranking.h"
 #include "align/align.h"
 #include "search/hit_buffer.h"
 #include "config.h"
+#include "checkpoint.h"
 #include "search/seed_array/seed_array.h"
 #include "data/fasta/fasta_file.h"
 #include "legacy/dmnd/dmnd.h"
 #include "data/blastdb/blastdb.h"
+#include "data/query_stream.h"
+#include "util/string/string.h"
 
 #ifdef WITH_DNA
 #include "../dna/dna_index.h"
@@ -62,6 +66,7 @@ namespace Search {
 static const int64_t MAX_INDEX_QUERY_SIZE = 32 * MEGABYTES;
 static const size_t MAX_HASH_SET_SIZE = 8 * MEGABYTES;
 static const size_t MIN_QUERY_INDEXED_DB_SIZE = 256 * MEGABYTES;
+static const unsigned MAX_INDEX_CHUNKS = 64;
 
 static const string label_align = "align";
 static const string stack_align_todo = label_align + "_todo";
@@ -87,16 +92,74 @@ static string get_ref_part_file_name(const string & prefix, size_t query, string
 
 static string get_ref_block_tmpfile_name(size_t query, size_t block) {
 	const string file_name = append_label("ref_block_", query) + append_label("_", block);
-	return join_path(config.parallel_tmpdir, file_name);
+	return join_path(Checkpoint::enabled() ? config.checkpoint : config.parallel_tmpdir, file_name);
+}
+
+// Boundaries of the shape batches whose seed arrays are built in one pass over the sequences (--shape-batch). Batching needs
+// the full seed partition range in one index chunk, and the seed arrays of a batch have to fit into a quarter of --memory-limit.
+static vector<int> shape_batches(const Config& cfg) {
+	const int n = shapes.count(), max_batch = config.shape_batch == 0 ? n : config.shape_batch;
+	vector<int> batches{ 0 };
+	if (max_batch <= 1 || cfg.index_chunks > 1 || config.target_indexed) {
+		for (int i = 1; i <= n; ++i)
+			batches.push_back(i);
+		return batches;
+	}
+	const size_t entry = Search::keep_target_id(cfg) ? sizeof(ARCH_GENERIC::SeedArray<PackedLocId>::Entry) : sizeof(ARCH_GENERIC::SeedArray<PackedLoc>::Entry);
+	const size_t budget = Util::Memory::limit() / 4;
+	const SeedPartitionRange range(0, (SeedPartition)seedp_count(cfg.seedp_bits));
+	size_t bytes = 0;
+	for (int i = 0; i < n; ++i) {
+		const size_t b = entry * (hst_size(cfg.target->hst().get(i), range) + hst_size(cfg.query->hst().get(i), range));
+		if (i > batches.back() && (i - batches.back() >= max_batch || bytes + b > budget)) {
+			batches.push_back(i);
+			bytes = 0;
+		}
+		bytes += b;
+	}
+	batches.push_back(n);
+	return batches;
+}
+
+static int64_t seed_array_size(const Config& cfg, const vector<int>& batches) {
+	const size_t entry = Search::keep_target_id(cfg) ? sizeof(ARCH_GENERIC::SeedArray<PackedLocId>::Entry) : sizeof(ARCH_GENERIC::SeedArray<PackedLoc>::Entry);
+	return int64_t(entry * (cfg.target->hst().max_chunk_size(cfg.index_chunks, batches)
+		+ (config.target_indexed ? 0 : cfg.query->hst().max_chunk_size(cfg.index_chunks, batches))));
+}
+
+// Increases the number of index chunks until the seed arrays of one chunk fit into the memory headroom. Returns true if
+// the number was changed.
+static bool fit_index_chunks(Config& cfg, vector<int>& batches) {
+	const unsigned max_chunks = std::min((unsigned)seedp_count(cfg.seedp_bits), MAX_INDEX_CHUNKS), chunks = cfg.index_chunks;
+	if (config.algo != ::Config::Algo::DOUBLE_INDEXED)
+		return false;
+	while (cfg.index_chunks < max_chunks && seed_array_size(cfg, batches) > Util::Memory::available(Util::Memory::Pool::SEED_ARRAYS)) {
+		cfg.index_chunks = std::min(cfg.index_chunks * 2, max_chunks);
+		batches = shape_batches(cfg);
+	}
+	return cfg.index_chunks != chunks;
 }
 
-static pair<char*, char*> alloc_buffers(Config& cfg) {
+static pair<char*, char*> alloc_buffers(Config& cfg, const vector<int>& batches) {
 	if (Search::keep_target_id(cfg))
-		return { ARCH_GENERIC::SeedArray<PackedLocId>::alloc_buffer(cfg.target->hst(), cfg.index_chunks),
-		config.target_indexed ? nullptr : ARCH_GENERIC::SeedArray<PackedLocId>::alloc_buffer(cfg.query->hst(), cfg.index_chunks) };
+		return { ARCH_GENERIC::SeedArray<PackedLocId>::alloc_buffer(cfg.target->hst(), cfg.index_chunks, batches),
+		config.target_indexed ? nullptr : ARCH_GENERIC::SeedArray<PackedLocId>::alloc_buffer(cfg.query->hst(), cfg.index_chunks, batches) };
 	else
-		return { ARCH_GENERIC::SeedArray<PackedLoc>::alloc_buffer(cfg.target->hst(), cfg.index_chunks),
-		config.target_indexed ? nullptr : ARCH_GENERIC::SeedArray<PackedLoc>::alloc_buffer(cfg.query->hst(), cfg.index_chunks) };
+		return { ARCH_GENERIC::SeedArray<PackedLoc>::alloc_buffer(cfg.target->hst(), cfg.index_chunks, batches),
+		config.target_indexed ? nullptr : ARCH_GENERIC::SeedArray<PackedLoc>::alloc_buffer(cfg.query->hst(), cfg.index_chunks, batches) };
+}
+
+// Intermediate output of the reference blocks is kept in memory-backed files as long as it is projected
+// to fit into a quarter of --memory-limit.
+static bool intermediate_in_memory(const vector<File*>& tmp_file) {
+	if (config.memory_limit.blank())
+		return false;
+	int64_t bytes = 0;
+	for (File* f : tmp_file)
+		bytes += f->tell();
+	if (!tmp_file.empty())
+		bytes += tmp_file.back()->tell();
+	return bytes <= Util::Memory::limit() / 4;
 }
 
 static void run_ref_chunk(SequenceFile &db_file,
@@ -105,28 +168,40 @@ static void run_ref_chunk(SequenceFile &db_file,
 	vector<File*> &tmp_file,
 	Config& cfg)
 {
+	Trace::set_blocks(cfg.current_query_block, cfg.current_ref_block);
 	TaskTimer timer;
 	log_rss();
 	auto& query_seqs = cfg.query->seqs();
+	// A resident reference block has already been sorted, masked and scored for an earlier micro-batch.
+	const bool resident = cfg.resident_target && cfg.target == cfg.resident_target;
+	Util::Memory::Reservation target_mem(Util::Memory::Pool::SEQUENCES, cfg.target == cfg.query ? 0 : (int64_t)cfg.target->mem_size());
 
 	if ((cfg.lin_stage1_target || cfg.min_length_ratio > 0.0) && !config.kmer_ranking && cfg.target.use_count() == 1) {
 		timer.go("Length sorting reference");
 		cfg.target.reset(cfg.target->length_sorted(config.threads_));
 	}	
 
+	if (!query_seqs.has_position_index())
+		query_seqs.init_position_index();
+	if (!cfg.target->seqs().has_position_index())
+		cfg.target->seqs().init_position_index();
+
 	//if (config.comp_based_stats == Stats::CBS::COMP_BASED_STATS_AND_MATRIX_ADJUST || flag_any(cfg.output_format->flags, Output::Flags::TARGET_SEQS)) {
-	if (flag_any(cfg.output_format->flags, Output::Flags::TARGET_SEQS)) {
+	if (flag_any(cfg.output_format->flags, Output::Flags::TARGET_SEQS) && !resident) {
 		cfg.target->unmasked_seqs() = cfg.target->seqs();
 	}
 
-	if (cfg.target_masking != MaskingAlgo::NONE && !cfg.lazy_masking) {
+	// Stored masking intervals are applied at the cost of a copy, so that they also take the place of lazy masking.
+	const bool stored_masking = cfg.target_masking != MaskingAlgo::NONE && db_file.has_stored_masking(cfg.target_masking);
+	if (cfg.target_masking != MaskingAlgo::NONE && (!cfg.lazy_masking || stored_masking) && !resident) {
 		timer.go("Masking reference");
-		const MaskingStat stats = mask_seqs(cfg.target->seqs(), Masking::get(), true, cfg.target_masking);
+		const MaskingStat stats = stored_masking ? db_file.apply_stored_masking(*cfg.target, cfg.target_masking)
+			: mask_seqs(cfg.target->seqs(), Masking::get(), true, cfg.target_masking);
 		timer.finish();
 		stats.print(*log_stream);
 	}
 
-	if (flag_any(cfg.output_format->flags, Output::Flags::SELF_ALN_SCORES)) {
+	if (flag_any(cfg.output_format->flags, Output::Flags::SELF_ALN_SCORES) && !resident) {
 		timer.go("Computing self alignment scores");
 		cfg.target->compute_self_aln();
 	}
@@ -135,16 +210,14 @@ static void run_ref_chunk(SequenceFile &db_file,
 	const bool persist_dict = daa || cfg.iterated();
 	if(((cfg.blocked_processing || daa) && !config.global_ranking_targets) || cfg.iterated()) {
 		timer.go("Initializing dictionary");
-		if (config.multiprocessing || (cfg.current_ref_block == 0 && (!daa || cfg.current_query_block == 0) && query_iteration == 0))
+		if (SequenceFile::block_dictionaries() || (cfg.current_ref_block == 0 && (!daa || cfg.current_query_block == 0) && query_iteration == 0))
 			db_file.init_dict(cfg.current_query_block, cfg.current_ref_block);
 		if(!config.global_ranking_targets)
 			db_file.init_dict_block(cfg.current_ref_block, cfg.target->seqs().size(), persist_dict);
 	}
 
 	timer.go("Initializing temporary storage");
-	if (config.global_ranking_targets)
-		cfg.global_ranking_buffer.reset(new Config::RankingBuffer());
-	else
+	if (!config.global_ranking_targets)
 		cfg.seed_hit_buf.reset(new Search::HitBuffer(query_seqs.partition(cfg.query_bins, true, true),
 			config.tmpdir,
 			cfg.target->long_offsets(), align_mode.query_contexts, config.threads_, cfg));
@@ -171,10 +244,30 @@ static void run_ref_chunk(SequenceFile &db_file,
 		}
 
 		timer.go("Allocating buffers");
+		vector<int> batches = shape_batches(cfg);
+		const bool chunks_increased = fit_index_chunks(cfg, batches);
+		const Util::Memory::Reservation seed_array_mem(Util::Memory::Pool::SEED_ARRAYS, seed_array_size(cfg, batches));
 		char* ref_buffer, * query_buffer;
-		tie(ref_buffer, query_buffer) = alloc_buffers(cfg);
+		tie(ref_buffer, query_buffer) = alloc_buffers(cfg, batches);
 		timer.finish();
+		if (chunks_increased)
+			*message_stream << "Increased the number of index chunks to " << cfg.index_chunks << " to stay within the memory limit." << endl;
 		*log_stream << "Query bins = " << cfg.query_bins << endl;
+		if (batches.size() < (size_t)shapes.count() + 1)
+			*log_stream << "Shape batches = " << batches.size() - 1 << endl;
+
+		if (Util::Numa::active()) {
+			timer.go("Replicating reference on NUMA nodes");
+			cfg.replicate_target();
+			SequenceSet& ref_seqs = cfg.target->seqs();
+			Util::Numa::interleave(ref_seqs.ptr(0), ref_seqs.raw_len());
+			timer.finish();
+			for (size_t i = 0; i < cfg.target_replicas.size(); ++i) {
+				const SequenceSet& s = *cfg.target_replicas[i];
+				*log_stream << "NUMA reference replica " << i << ": " << Util::Numa::placement_str(s.ptr(0), s.raw_len()) << endl;
+			}
+			*log_stream << "NUMA reference sequences (interleaved): " << Util::Numa::placement_str(ref_seqs.ptr(0), ref_seqs.raw_len()) << endl;
+		}
 
 		::HashedSeedSet* target_seeds = nullptr;
 		if (config.target_indexed) {
@@ -183,13 +276,8 @@ static void run_ref_chunk(SequenceFile &db_file,
 			timer.finish();
 		}
 		if ((config.command != ::Config::blastn)) {
-			for (int i = 0; i < shapes.count(); ++i) {
-				if (config.global_ranking_targets)
-					cfg.global_ranking_buffer.reset(new Config::RankingBuffer());
-				search_shape(i, cfg.current_query_block, query_iteration, query_buffer, ref_buffer, cfg, target_seeds); //index_targets(0,cfg,ref_buffer,target_seeds);
-				if (config.global_ranking_targets)
-					Extension::GlobalRanking::update_table(cfg);
-			}
+			for (size_t i = 0; i + 1 < batches.size(); ++i)
+				search_shapes(batches[i], batches[i + 1], cfg.current_query_block, query_iteration, query_buffer, ref_buffer, cfg, target_seeds); //index_targets(0,cfg,ref_buffer,target_seeds);
 			if (!config.global_ranking_targets)
 				cfg.seed_hit_buf->finish_writing();
 		}
@@ -200,13 +288,15 @@ static void run_ref_chunk(SequenceFile &db_file,
 #endif
 
         log_rss();
+        Util::Memory::log_huge_pages();
         timer.go("Deallocating buffers");
 #ifdef WITH_DNA
         if(config.command != ::Config::blastn)
 #endif
-		Util::Memory::aligned_free(query_buffer);
-		Util::Memory::aligned_free(ref_buffer);
+		Util::Memory::huge_free(query_buffer);
+		Util::Memory::huge_free(ref_buffer);
 		delete target_seeds;
+		cfg.target_replicas.clear();
 
 		timer.go("Clearing query masking");
 		FrequentSeeds::clear_masking(query_seqs);
@@ -215,16 +305,21 @@ static void run_ref_chunk(SequenceFile &db_file,
 	}
 
     File* out;
+	unique_ptr<File> checkpoint_out;
 	const bool temp_output = (cfg.blocked_processing || cfg.iterated()) && !config.global_ranking_targets;
 	if (temp_output) {
 		timer.go("Opening temporary output file");
-		if (config.multiprocessing) {
+		if (Checkpoint::enabled())
+			checkpoint_out.reset(new File(get_ref_block_tmpfile_name(cfg.current_query_block, cfg.current_ref_block), "wb"));
+		else if (config.multiprocessing) {
 			const string file_name = get_ref_block_tmpfile_name(cfg.current_query_block, cfg.current_ref_block);
 			tmp_file.push_back(new File(file_name, "wb"));
 		} else {
-			tmp_file.push_back(new File(Temporary()));
+			Temporary t;
+			t.in_memory = intermediate_in_memory(tmp_file);
+			tmp_file.push_back(new File(t));
 		}
-		out = tmp_file.back();
+		out = checkpoint_out ? checkpoint_out.get() : tmp_file.back();
 	}
 	else
 		out = &master_out;
@@ -243,10 +338,23 @@ static void run_ref_chunk(SequenceFile &db_file,
 	if (temp_output)
 		IntermediateRecord::finish_file(*out);
 
+	if (config.stream_queries && !cfg.blocked_processing && !config.self && !resident) {
+		*log_stream << "Keeping reference block resident for streamed queries" << endl;
+		cfg.resident_target = cfg.target;
+	}
+
 	timer.go("Deallocating reference");
 	cfg.target.reset();
+	target_mem.release();
 	cfg.db->close_dict_block(persist_dict);
 
+	if (checkpoint_out) {
+		timer.go("Committing checkpoint");
+		checkpoint_out.reset();
+		Checkpoint::commit(cfg.current_query_block, cfg.current_ref_block, { get_ref_block_tmpfile_name(cfg.current_query_block, cfg.current_ref_block),
+			SequenceFile::dict_file_name(cfg.current_query_block, cfg.current_ref_block) });
+	}
+
 	timer.finish();
 }
 
@@ -297,7 +405,7 @@ static void run_query_iteration(const unsigned query_iteration,
 	::Config::set_option(options.index_chunks, config.lowmem_, 0u, config.algo == ::Config::Algo::DOUBLE_INDEXED ? sensitivity_traits.at(sens).index_chunks : 1u);
 	options.seedp_bits = Search::seedp_bits(shapes[0].weight_, config.threads_, options.index_chunks);
 	*log_stream << "Seed partition bits = " << options.seedp_bits << endl;
-	options.lazy_masking = config.algo != ::Config::Algo::DOUBLE_INDEXED && options.target_masking != MaskingAlgo::NONE && config.frame_shift == 0;
+	options.lazy_masking = config.algo != ::Config::Algo::DOUBLE_INDEXED && options.target_masking != MaskingAlgo::NONE;
 	if (config.command != ::Config::blastn && options.gapped_filter_evalue != 0.0) {
 		options.cutoff_gapped1 = { config.gapped_filter_evalue1 };
 		options.cutoff_gapped2 = { options.gapped_filter_evalue };
@@ -312,9 +420,11 @@ static void run_query_iteration(const unsigned query_iteration,
 		*log_stream << "Shape configuration: " << ::shapes << endl;
 	}
 
+	Util::Memory::Reservation ranking_table_mem;
 	if (config.global_ranking_targets) {
 		timer.go("Allocating global ranking table");
 		options.ranking_table.reset(new Search::Config::RankingTable(query_seqs.size() * config.global_ranking_targets / align_mode.query_contexts));
+		ranking_table_mem = Util::Memory::Reservation(Util::Memory::Pool::GLOBAL_RANKING, int64_t(options.ranking_table->size() * sizeof(Search::Config::RankingTable::value_type)));
 	}
 
 	if (!config.swipe_all && !config.target_indexed) {
@@ -399,13 +509,18 @@ static void run_query_iteration(const unsigned query_iteration,
 			db_file.set_seqinfo_ptr(options.query->oid_end());
 		else if (!config.self || options.current_query_block != 0 || !db_file.eof())
 			db_file.set_seqinfo_ptr(0);*/
-		timer.go("Seeking in database");
-		const bool lin_self_first_query_block = config.self && (0 == options.current_query_block) && config.lin_stage1_query;
-		if (!lin_self_first_query_block)
-			db_file.set_seqinfo_ptr((config.self && !config.lin_stage1_query) ? options.query->oid_end() : 0);
-		timer.finish();
+		const bool resident = (bool)options.resident_target;
+		if (!resident) {
+			timer.go("Seeking in database");
+			const bool lin_self_first_query_block = config.self && (0 == options.current_query_block) && config.lin_stage1_query;
+			if (!lin_self_first_query_block)
+				db_file.set_seqinfo_ptr((config.self && !config.lin_stage1_query) ? options.query->oid_end() : 0);
+			timer.finish();
+		}
 		for (options.current_ref_block = 0; ; ++options.current_ref_block) {
-			if (config.self && ((config.lin_stage1_query && options.current_ref_block == options.current_query_block) || (!config.lin_stage1_query && options.current_ref_block == 0))) {
+			if (resident)
+				options.target = options.resident_target;
+			else if (config.self && ((config.lin_stage1_query && options.current_ref_block == options.current_query_block) || (!config.lin_stage1_query && options.current_ref_block == 0))) {
 				options.target = options.query;
 				if (config.lin_stage1_query) {
 					timer.go("Seeking in database");
@@ -422,11 +537,17 @@ static void run_query_iteration(const unsigned query_iteration,
 			}
 			if (options.current_ref_block == 0) {
 				//const int64_t db_seq_count = options.db_filter ? options.db_filter->oid_filter.one_count() : options.db->sequence_count();
-				options.blocked_processing = config.global_ranking_targets || !options.db->eof(); // options.target->seqs().size() < db_seq_count;
+				options.blocked_processing = config.global_ranking_targets || !options.db->eof() || Checkpoint::enabled(); // options.target->seqs().size() < db_seq_count;
 			}
 			if (options.target->empty()) break;
 			timer.finish();
+			if (Checkpoint::enabled() && Checkpoint::done(options.current_query_block, options.current_ref_block)) {
+				*message_stream << "Reference block " << options.current_ref_block + 1 << " of query block " << options.current_query_block + 1 << " restored from checkpoint." << endl;
+				continue;
+			}
 			run_ref_chunk(db_file, query_iteration, master_out, tmp_file, options);
+			if (resident)
+				break;
 		}
 		log_rss();
 	}
@@ -456,10 +577,12 @@ static void run_query_chunk(File &master_out,
 	OutputFile *aligned_file,
 	Config &options)
 {
+	Trace::set_blocks(options.current_query_block, -1);
 	auto P = Parallelizer::get();
 	TaskTimer timer;
 	auto& db_file = *options.db;
 	auto& query_seqs = options.query->seqs();
+	const Util::Memory::Reservation query_mem(Util::Memory::Pool::SEQUENCES, (int64_t)options.query->mem_size());
 
 	vector<File*> tmp_file;
 	if (options.track_aligned_queries) {
@@ -496,6 +619,7 @@ static void run_query_chunk(File &master_out,
 	}
 
 	log_rss();
+	Trace::set_blocks(options.current_query_block, -1);
 
 	if (options.blocked_processing || config.multiprocessing || options.iterated()) {
 		if(!config.global_ranking_targets) timer.go("Joining output blocks");
@@ -555,6 +679,11 @@ static void run_query_chunk(File &master_out,
 				P->log("JOIN END " + std::to_string(options.current_query_block));
 			}
 			P->delete_stack(stack_join_todo);
+		} else if (Checkpoint::enabled() && options.current_ref_block > 0) {
+			vector<string> tmp_file_names;
+			for (int64_t i = 0; i < options.current_ref_block; ++i)
+				tmp_file_names.push_back(get_ref_block_tmpfile_name(options.current_query_block, i));
+			join_blocks(options.current_ref_block, master_out, tmp_file, options, db_file, tmp_file_names);
 		} else {
 			if (!tmp_file.empty())
 				join_blocks(options.current_ref_block, master_out, tmp_file, options, db_file);
@@ -585,9 +714,9 @@ static void master_thread(TaskTimer &total_timer, Config &options)
 			if (! file_exists(file_align_todo)) {
 				break;
 			} else {
-				FileStack stack_todo(file_align_todo);
+				FileStack stack_todo(file_align_todo, FileStack::Backend::SYNC);
 				const string file_align_wip = get_ref_part_file_name(stack_align_wip, i);
-				FileStack stack_wip(file_align_wip);
+				FileStack stack_wip(file_align_wip, FileStack::Backend::SYNC);
 				string buf;
 				int j = 0;
 				while (stack_wip.pop_exclusive(buf)) {
@@ -598,10 +727,10 @@ static void master_thread(TaskTimer &total_timer, Config &options)
 					*message_stream << "Restored " << j << " align chunks for query " << i << endl;
 			}
 			const string file_join_wip = get_ref_part_file_name(stack_join_wip, i);
-			FileStack stack_wip(file_join_wip);
+			FileStack stack_wip(file_join_wip, FileStack::Backend::SYNC);
 			if (stack_wip.size() > 0) {
 				const string file_join_todo = get_ref_part_file_name(stack_join_todo, i);
-				FileStack stack_todo(file_join_todo);
+				FileStack stack_todo(file_join_todo, FileStack::Backend::SYNC);
 				string buf;
 				int j = 0;
 				while (stack_wip.pop_exclusive(buf)) {
@@ -682,10 +811,11 @@ static void master_thread(TaskTimer &total_timer, Config &options)
 	}
 
 	timer.go("Opening the output file");
+	const bool daa = *options.output_format == OutputFormat::daa;
 	if (!options.out)
-		options.out.reset(new File(config.output_file, "wb", File::Flags::TREAT_BLANK_AS_STDOUT, config.compressor()));
-	if (*options.output_format == OutputFormat::daa)
-		init_daa(*options.out.get());
+		options.out.reset(new File(config.output_file, "wb", File::Flags::TREAT_BLANK_AS_STDOUT, daa ? CompressionLib::NONE : config.compressor()));
+	if (daa)
+		init_daa(*options.out.get(), config.compressor());
 	unique_ptr<OutputFile> unaligned_file, aligned_file;
 	if (!config.unaligned.empty())
 		unaligned_file = unique_ptr<OutputFile>(new OutputFile(config.unaligned));
@@ -693,6 +823,15 @@ static void master_thread(TaskTimer &total_timer, Config &options)
 		aligned_file = unique_ptr<OutputFile>(new OutputFile(config.aligned_file));
 	timer.finish();
 
+	unique_ptr<QueryStream> query_stream;
+	if (config.stream_queries) {
+		if (options.self || config.multiprocessing)
+			throw runtime_error("--stream is not compatible with self-alignment or --multiprocessing.");
+		query_stream.reset(new QueryStream(*options.query_file, config.stream_batch, config.stream_deadline));
+		*log_stream << "Streaming queries in micro-batches of " << config.stream_batch << " letters, deadline " << config.stream_deadline << "s" << endl;
+	}
+
+	bool complete = true;
 	//for (;query_file_offset < db_file->sequence_count(); ++options.current_query_block) { TODO
 	for (;; ++options.current_query_block) {
 		log_rss();
@@ -709,6 +848,11 @@ static void master_thread(TaskTimer &total_timer, Config &options)
 			options.query->load_stats(*message_stream, t);
 			query_file_offset = db_file->tell_seq();
 		}
+		else if (query_stream) {
+			timer.go("Waiting for query micro-batch");
+			options.query.reset(query_stream->next());
+			timer.finish();
+		}
 		else {
 			timer.go("Loading query sequences");
 			options.query.reset(options.query_file->load_seqs(config.block_size(), 0, nullptr));
@@ -742,12 +886,26 @@ static void master_thread(TaskTimer &total_timer, Config &options)
 
 		run_query_chunk(*options.out, unaligned_file.get(), aligned_file.get(), options);
 
+		if (query_stream) {
+			options.out->flush();
+			if (unaligned_file)
+				unaligned_file->flush();
+			if (aligned_file)
+				aligned_file->flush();
+		}
+
 		if (file_exists("stop")) {
 			*message_stream << "Encountered \'stop\' file, shutting down run" << endl;
+			complete = false;
 			break;
 		}
 	}
 
+	if (query_stream) {
+		*log_stream << "Streamed micro-batches: " << query_stream->batches() << endl;
+		query_stream.reset();
+	}
+
 	if (options.query_file.use_count() == 1) {
 		timer.go("Closing the input file");
 		options.query_file->close();
@@ -767,6 +925,11 @@ static void master_thread(TaskTimer &total_timer, Config &options)
 	if (aligned_file.get())
 		aligned_file->close();
 
+	if (Checkpoint::enabled() && complete) {
+		timer.go("Deleting checkpoint");
+		Checkpoint::finish();
+	}
+
 	timer.go("Closing the database");
 	options.db.reset();
 
@@ -777,6 +940,8 @@ static void master_thread(TaskTimer &total_timer, Config &options)
 	log_rss();
 	*message_stream << "Total time = " << total_timer.get() << "s" << endl;
 	statistics.print();
+	Util::Memory::log_peak_usage();
+	Util::Perf::print();
 	//print_warnings();
 }
 
@@ -788,6 +953,8 @@ void run(unique_ptr<vector<BitVector>>& target_seed_hits, const shared_ptr<Seque
 	(align_mode.sequence_type == SequenceType::amino_acid) ? value_traits = amino_acid_traits : value_traits = nucleotide_traits;
 
 	*message_stream << "Temporary directory: " << TempFile::get_temp_dir() << endl;
+	if (config.numa)
+		Util::Numa::log_topology();
 
 	if (config.sensitivity >= Sensitivity::VERY_SENSITIVE)
 		::Config::set_option(config.chunk_size, 0.4);
@@ -904,6 +1071,9 @@ void run(unique_ptr<vector<BitVector>>& target_seed_hits, const shared_ptr<Seque
 		cfg.score_builder.reset(new Stats::Blastn_Score(config.match_reward, config.mismatch_penalty, config.gap_open, config.gap_extend, cfg.db_letters, cfg.db->sequence_count()));
 #endif
 
+	if (Checkpoint::enabled())
+		Checkpoint::open(cfg);
+
     master_thread(total, cfg);
 	log_rss();
 }
@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "legacy/dmnd/dmnd.h"
 #include "util/command_line_parser.h"
 #include "util/log_stream.h"
+#include "util/parallel/coordinator.h"
 #include "util/system/system.h"
 #include "tools/tools.h"
 
@@ -60,7 +61,7 @@ namespace Cluster {
 #endif
 
 void split();
-namespace Benchmark { void benchmark(); }
+namespace Benchmark { void run(); }
 namespace Test { int run();
 }
 namespace Cluster {
@@ -89,7 +90,10 @@ int main(int ac, const char* av[])
 			cout << Const::program_name << " version " << Const::version_string << endl;
 			break;
 		case Config::makedb:
-			DatabaseFile::make_db();
+			if (config.append_db)
+				DatabaseFile::append_db();
+			else
+				DatabaseFile::make_db();
 			break;
 		case Config::blastp:
 		case Config::blastx:
@@ -142,7 +146,10 @@ int main(int ac, const char* av[])
 			multinode();
 			break;
 		case Config::benchmark:
-			Benchmark::benchmark();
+			Benchmark::run();
+			break;
+		case Config::COORDINATOR:
+			Coordinator::serve(config.coordinator);
 			break;
 		case Config::split:
 			split();
@@ -166,6 +173,12 @@ int main(int ac, const char* av[])
 			hash_seqs();
 			break;
 		case Config::prep_db:
+			if (config.database.empty())
+				throw std::runtime_error("Missing parameter: database file (--db/-d)");
+			if (DatabaseFile::is_diamond_db(auto_append_extension_if_exists(config.database, DatabaseFile::FILE_EXTENSION))) {
+				DatabaseFile::prep_db();
+				break;
+			}
 			set_color(Color::YELLOW, true);
 			cerr << "Warning: prepdb is deprecated since v2.1.14 and no longer needed to use BLAST databases. No action was taken." << endl;
 			reset_color(true);
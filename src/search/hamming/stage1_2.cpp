@@ -53,22 +53,39 @@ static Stage1KernelPackedLoc* stage1_dispatch(const Search::Config* cfg, PackedL
 			: (config.self && cfg->current_ref_block == 0 ? stage1_self<PackedLoc> : stage1<PackedLoc>));
 }
 
-void run_stage1(JoinIterator<PackedLoc>& it, Search::WorkSet* work_set, const Search::Config* cfg) {
-	auto kernel = stage1_dispatch(cfg, PackedLoc());
-	for (; it; ++it) {
-		work_set->stats.inc(Statistics::SEEDS_HIT);
-		kernel(it.r->begin(), (int32_t)it.r->size(), it.s->begin(), (int32_t)it.s->size(), *work_set);
-	}
+bool stage1_splittable(const Search::Config* cfg) {
+	return !config.lin_stage1_combo && !config.lin_stage1_query && !cfg->lin_stage1_target && cfg->min_length_ratio == 0.0
+		&& !(config.self && cfg->current_ref_block == 0);
 }
 
-void run_stage1(JoinIterator<PackedLocId>& it, Search::WorkSet* work_set, const Search::Config* cfg) {
-	auto kernel = stage1_dispatch(cfg, PackedLocId());
+template<typename SeedLoc>
+static void run_stage1(JoinIterator<SeedLoc>& it, Search::WorkSet* work_set, const Search::Config* cfg, uint64_t max_work) {
+	auto kernel = stage1_dispatch(cfg, SeedLoc());
 	for (; it; ++it) {
+		const uint32_t nq = (uint32_t)it.r->size(), ns = (uint32_t)it.s->size();
+		if ((uint64_t)nq * ns > max_work)
+			continue;
 		work_set->stats.inc(Statistics::SEEDS_HIT);
-		kernel(it.r->begin(), (int32_t)it.r->size(), it.s->begin(), (int32_t)it.s->size(), *work_set);
+		kernel(it.r->begin(), nq, it.s->begin(), ns, *work_set);
 	}
 }
 
+void run_stage1(JoinIterator<PackedLoc>& it, Search::WorkSet* work_set, const Search::Config* cfg, uint64_t max_work) {
+	run_stage1<PackedLoc>(it, work_set, cfg, max_work);
+}
+
+void run_stage1(JoinIterator<PackedLocId>& it, Search::WorkSet* work_set, const Search::Config* cfg, uint64_t max_work) {
+	run_stage1<PackedLocId>(it, work_set, cfg, max_work);
+}
+
+void run_stage1(const PackedLoc* q, uint32_t nq, const PackedLoc* s, uint32_t ns, Search::WorkSet* work_set) {
+	stage1(q, nq, s, ns, *work_set);
+}
+
+void run_stage1(const PackedLocId* q, uint32_t nq, const PackedLocId* s, uint32_t ns, Search::WorkSet* work_set) {
+	stage1(q, nq, s, ns, *work_set);
+}
+
 }}
 
 /*namespace Search {
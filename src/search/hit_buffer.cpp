@@ -27,6 +27,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util/io/output_file.h"
 #include "util/parallel/simple_thread_pool.h"
 #include "data/block/block.h"
+#include "util/system/numa.h"
+#include "util/memory/huge_pages.h"
+#include "basic/statistics.h"
+#include "util/trace.h"
+#define _REENTRANT
+#include "ips4o/ips4o.hpp"
 
 using std::vector;
 using std::string;
@@ -62,6 +68,9 @@ HitBuffer::HitBuffer(const vector<Key>& key_partition, const string& tmpdir, boo
 {
 	*log_stream << "Async_buffer() " << key_partition.back() << std::endl;
 	count_ = new atomic_size_t[key_partition.size()];
+	query_count_ = new atomic<uint32_t>[max_query];
+	for (uint32_t i = 0; i < max_query; ++i)
+		query_count_[i].store(0, std::memory_order_relaxed);
 
 	for (size_t i = 0; i < key_partition.size(); ++i) {
 		count_[i].store(0, std::memory_order_relaxed);
@@ -85,7 +94,11 @@ HitBuffer::HitBuffer(const vector<Key>& key_partition, const string& tmpdir, boo
 	}
 }
 
+static std::atomic<int64_t> bytes_written(0);
+
 void HitBuffer::write_worker(const std::atomic<bool>& stop, int bin) {
+	if (Trace::enabled)
+		Trace::thread_name("hit buffer writer " + std::to_string(bin));
 	if (config.trace_pt_membuf) {
 		while(!stop) {
 			pair<int, vector<Hit>*> buf;
@@ -102,6 +115,9 @@ void HitBuffer::write_worker(const std::atomic<bool>& stop, int bin) {
 			if (!out_queue_[bin]->wait_and_dequeue(buf))
 				break;
 			File& tmp_file = tmp_file_[std::get<0>(buf)];
+			Trace::Span span("write hits", "hit_buffer", "bytes", (int64_t)std::get<1>(buf)->size());
+			if (Trace::enabled)
+				Trace::counter("hit buffer bytes written", bytes_written += std::get<1>(buf)->size());
 			tmp_file.write(std::get<1>(buf)->size());
 			tmp_file.write(std::get<2>(buf));
 			tmp_file.write(std::get<1>(buf)->data(), std::get<1>(buf)->size());
@@ -144,6 +160,7 @@ HitBuffer::~HitBuffer() noexcept(false) {
 	if (!writer_.empty())
 		throw runtime_error("HitBuffer::~HitBuffer(): writer thread still active");
 	delete[] count_;
+	delete[] query_count_;
 }
 
 bool HitBuffer::load(size_t max_size) {
@@ -152,6 +169,8 @@ bool HitBuffer::load(size_t max_size) {
 	max_size = std::max(max_size, (size_t)1);
 	data_size_next_ = 0;
 	auto worker = [&](int end) {
+		if (Trace::enabled)
+			Trace::thread_name("hit buffer loader");
 		try {
 			Hit* out = data_loading_;
 			for (; bins_processed_ < end; ++bins_processed_) {
@@ -203,9 +222,25 @@ void HitBuffer::load_bin(Hit* out, int bin)
 		f.close();
 		return;
 	}
+	Trace::Span span("load hits", "hit_buffer", "bin", bin);
 	const int p = config.threads_ > 1 ? std::min(config.threads_ - 1, config.load_threads) : 1;
 	Queue<pair<vector<char>*, uint32_t>> queue(p * 4, 1, p, pair<vector<char>*, uint32_t>(nullptr, 0));
-	atomic<Hit*> out_ptr(out);
+	// The hits of each query context are placed at an offset given by the counts of the writers, so that the bin is
+	// loaded grouped by query without a separate sorting pass.
+	const uint32_t query_begin = begin(bin) * query_contexts_, query_end = std::min(end(bin) * query_contexts_, max_query_);
+	vector<atomic<uint64_t>> query_offset(query_end - query_begin);
+	uint64_t offset = 0;
+	for (uint32_t i = query_begin; i < query_end; ++i) {
+		query_offset[i - query_begin].store(offset, std::memory_order_relaxed);
+		offset += query_count_[i].load(std::memory_order_relaxed);
+	}
+	if (offset != count_[bin])
+		throw runtime_error("HitBuffer::load_bin(): mismatching query hit counts");
+	const ptrdiff_t hit_size = 2 + (long_subject_offsets_ ? sizeof(PackedLoc) : 4)
+#ifdef HIT_KEEP_TARGET_ID
+		+ 4
+#endif
+		;
 	atomic<uint64_t> count(0);
 	f.seek(0, SEEK_SET);
 	SimpleThreadPool pool;
@@ -216,7 +251,6 @@ void HitBuffer::load_bin(Hit* out, int bin)
 			if (!queue.wait_and_dequeue(v)) {
 				break;
 			}
-			Hit* dst = out_ptr.fetch_add(v.second, std::memory_order_relaxed);
 			uint32_t package_count = 0;
 			vector<char>::const_iterator ptr = v.first->begin(), end = v.first->end();
 			uint16_t nullscore;
@@ -225,11 +259,21 @@ void HitBuffer::load_bin(Hit* out, int bin)
 			while(ptr < end) {
 				uint32_t query_id, seed_offset;				
 				memcpy(&query_id, &*ptr, 4);
-				if (query_id >= max_query_)
+				if (query_id < query_begin || query_id >= query_end)
 					throw runtime_error("HitBuffer::load_bin(): invalid query id / possibly corrupted temporary file");
 				ptr += 4;
 				memcpy(&seed_offset, &*ptr, 4);
 				ptr += 4;
+				uint32_t n = 0;
+				for (vector<char>::const_iterator q = ptr; q + 2 <= end; q += hit_size, ++n) {
+					uint16_t score;
+					memcpy(&score, &*q, 2);
+					if (score == 0)
+						break;
+				}
+				Hit* dst = out + query_offset[query_id - query_begin].fetch_add(n, std::memory_order_relaxed);
+				if (dst + n > out + offset)
+					throw runtime_error("HitBuffer::load_bin(): buffer overflow / possibly corrupted temporary file");
 				PackedLoc subject_loc;
 				uint32_t x;
 				while (ptr < end) {
@@ -303,8 +347,18 @@ void HitBuffer::load_bin(Hit* out, int bin)
 	f.close();
 }
 
+void HitBuffer::sort_bin(int bin) {
+	vector<Hit>& hits = hit_buf_[bin];
+	TaskTimer timer;
+#ifdef NDEBUG
+	ips4o::parallel::sort(hits.begin(), hits.end(), std::less<Hit>(), config.threads_);
+#else
+	std::sort(hits.begin(), hits.end());
+#endif
+	statistics.inc(Statistics::TIME_SORT_SEED_HITS, timer.microseconds());
+}
+
 void HitBuffer::alloc_buffer() {
-	mmap_finished_ = mmap_loading_ = false;
 	if (config.trace_pt_membuf)
 		return;
 	int64_t max_size = 0;
@@ -315,45 +369,19 @@ void HitBuffer::alloc_buffer() {
 		data_loading_ = data_finished_ = nullptr;
 		return;
 	}
-#ifdef _MSC_VER
-	data_loading_ = new Hit[max_size];
-	data_finished_ = new Hit[max_size];	
-#else
-	int flags = MAP_PRIVATE | MAP_ANONYMOUS;
-#ifdef MAP_HUGETLB
-	flags |= MAP_HUGETLB;
-#endif
-	mmap_finished_ = mmap_loading_ = true;
-	data_finished_ = (Hit*)mmap(nullptr, max_size * sizeof(Hit), PROT_READ | PROT_WRITE, flags, -1, 0);
-	data_loading_ = (Hit*)mmap(nullptr, max_size * sizeof(Hit), PROT_READ | PROT_WRITE, flags, -1, 0);
-	if (data_finished_ == MAP_FAILED) {
-		data_finished_ = new Hit[max_size];
-		mmap_finished_ = false;
-	}
-	if (data_loading_ == MAP_FAILED) {
-		data_loading_ = new Hit[max_size];
-		mmap_loading_ = false;
+	data_finished_ = (Hit*)Util::Memory::huge_alloc(max_size * sizeof(Hit));
+	data_loading_ = (Hit*)Util::Memory::huge_alloc(max_size * sizeof(Hit));
+	if (Util::Numa::active()) {
+		Util::Numa::interleave(data_finished_, max_size * sizeof(Hit));
+		Util::Numa::interleave(data_loading_, max_size * sizeof(Hit));
 	}
-#endif
 }
 
 void HitBuffer::free_buffer() {
 	if (!config.trace_pt_membuf) {
-#ifdef _MSC_VER
-		delete[] data_loading_;
-		delete[] data_finished_;
-#else
-		if (mmap_finished_)
-			munmap(data_finished_, alloc_size_ * sizeof(Search::Hit));
-		else
-			delete[] data_finished_;
-		if (mmap_loading_)
-			munmap(data_loading_, alloc_size_ * sizeof(Search::Hit));
-		else
-			delete[] data_loading_;
-#endif
+		Util::Memory::huge_free(data_finished_, alloc_size_ * sizeof(Hit));
+		Util::Memory::huge_free(data_loading_, alloc_size_ * sizeof(Hit));
 	}
-
 }
 
 }
\ No newline at end of file
@@ -71,6 +71,7 @@ struct HitBuffer
 			last_bin_(0),
 			buffer_(config.trace_pt_membuf ? parent.bins() : 0),
 			text_buffer_(config.trace_pt_membuf ? 0 : parent.bins()),
+			query_hits_(0),
 			count_(parent.bins(), 0),
 			buf_count_(parent.bins(), 0),
 			parent_(parent)
@@ -86,6 +87,7 @@ struct HitBuffer
 				}
 		}
 		void new_query(unsigned query, Loc seed_offset) {
+			commit_query();
 			last_bin_ = parent_.bin(query / parent_.query_contexts_);
 			seed_offset_ = seed_offset;
 			query_ = query;
@@ -112,6 +114,7 @@ struct HitBuffer
 				}
 			++count_[last_bin_];
 			++buf_count_[last_bin_];
+			++query_hits_;
 			if (config.trace_pt_membuf) {
 #ifdef HIT_KEEP_TARGET_ID
 				buffer_[last_bin_]->emplace_back(query, subject, seed_offset_, score, target_block_id);
@@ -156,17 +159,24 @@ struct HitBuffer
 		}
 		virtual ~Writer()
 		{
+			commit_query();
 			for (int bin = 0; bin < parent_.bins(); ++bin) {
 				flush(bin, true);
 				parent_.count_[bin] += count_[bin];
 			}
 		}
 	private:
+		void commit_query() {
+			if (query_hits_ > 0)
+				parent_.query_count_[query_].fetch_add(query_hits_, std::memory_order_relaxed);
+			query_hits_ = 0;
+		}
 		const size_t buffer_size;
 		int last_bin_;
 		std::vector<std::vector<Hit>*> buffer_;
 		Loc seed_offset_;
 		BlockId query_;
+		uint32_t query_hits_;
 		std::vector<TextBuffer*> text_buffer_;
 		std::vector<size_t> count_;
 		std::vector<uint32_t> buf_count_;
@@ -175,6 +185,7 @@ struct HitBuffer
 
 	bool load(size_t max_size);
 
+	// Returns the hits of the next bins, grouped by query context in ascending order.
 	std::tuple<Hit*, size_t, Key, Key> retrieve() {
 		if (config.trace_pt_membuf || config.swipe_all) {
 			if (bins_processed_ >= bins())
@@ -185,6 +196,7 @@ struct HitBuffer
 				return std::tuple<Hit*, size_t, Key, Key> { nullptr, 0, input_range_next_.first, input_range_next_.second };
 			else {
 				auto& buf = hit_buf_[bin];
+				sort_bin(bin);
 				return std::tuple<Hit*, size_t, Key, Key> { buf.data(), buf.size(), input_range_next_.first, input_range_next_.second };
 			}
 		}
@@ -198,7 +210,6 @@ struct HitBuffer
 			} else
 				throw std::runtime_error("HitBuffer retrieve w/o load");
 			std::swap(data_loading_, data_finished_);
-			std::swap(mmap_finished_, mmap_loading_);
 			return std::tuple<Hit*, size_t, Key, Key> { data_finished_, data_size_next_, input_range_next_.first, input_range_next_.second };
 		}
 	}
@@ -221,6 +232,7 @@ struct HitBuffer
 private:
 
 	void load_bin(Hit* out, int bin);
+	void sort_bin(int bin);
 	void write_worker(const std::atomic<bool>& stop, int bin);
 
 	const std::vector<Key> key_partition_;
@@ -234,9 +246,10 @@ private:
 	std::vector<std::vector<Hit>> hit_buf_;
 	std::vector<File> tmp_file_;
 	std::atomic_size_t *count_;
+	// Number of hits per query context, used to place the hits of a bin in query order while loading.
+	std::atomic<uint32_t>* query_count_;
 	std::pair<Key, Key> input_range_next_;
 	Hit* data_loading_, *data_finished_;
-	bool mmap_loading_, mmap_finished_;
 	int64_t data_size_next_, alloc_size_;
 	std::thread* load_worker_;
 	std::exception_ptr load_exception_;
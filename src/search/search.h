@@ -32,6 +32,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "basic/reduction.h"
 #include "util/data_structures/deque.h"
 #include "data/block/block.h"
+#include "align/global_ranking/accumulator.h"
 
 // #define UNGAPPED_SPOUGE
 
@@ -77,7 +78,8 @@ extern const std::map<Sensitivity, SensitivityTraits> sensitivity_traits;
 extern const std::map<Sensitivity, std::vector<std::string>> shape_codes;
 extern const std::map<Sensitivity, std::vector<Round>> iterated_sens;
 
-void search_shape(unsigned sid, int query_block, unsigned query_iteration, char* query_buffer, char* ref_buffer, Config& cfg, const HashedSeedSet* target_seeds);
+// Searches the shapes [shape_begin, shape_end). The seed arrays of more than one shape are built in one pass over the sequences.
+void search_shapes(unsigned shape_begin, unsigned shape_end, int query_block, unsigned query_iteration, char* query_buffer, char* ref_buffer, Config& cfg, const HashedSeedSet* target_seeds);
 bool use_single_indexed(double coverage, size_t query_letters, size_t ref_letters);
 void setup_search(Sensitivity sens, Search::Config& cfg);
 MaskingAlgo soft_masking_algo(const SensitivityTraits& traits);
@@ -90,9 +92,10 @@ namespace Search {
 using Container = vector<std::array<char, 48>, Util::Memory::AlignmentAllocator<std::array<char, 48>, 16>>;
 
 struct WorkSet {
-	WorkSet(const Context& context, const Search::Config& cfg, unsigned shape_id, HitBuffer::Writer* out, AsyncWriter<Hit, Search::Config::RankingBuffer::EXPONENT>* global_ranking_buffer, KmerRanking *kmer_ranking):
+	WorkSet(const Context& context, const Search::Config& cfg, unsigned shape_id, HitBuffer::Writer* out, Extension::GlobalRanking::HitAccumulator* global_ranking_buffer, KmerRanking *kmer_ranking, int numa_node = -1):
 		context(context),
 		cfg(cfg),
+		ref_seqs(cfg.target_seqs(numa_node)),
 		shape_id(shape_id),
 		out(out),
 		global_ranking_buffer(global_ranking_buffer),
@@ -100,10 +103,11 @@ struct WorkSet {
 	{}
 	Context context;
 	const Search::Config& cfg;
+	const SequenceSet& ref_seqs;
 	unsigned shape_id;
 	Statistics stats;
 	HitBuffer::Writer* out;
-	AsyncWriter<Hit, Search::Config::RankingBuffer::EXPONENT>* global_ranking_buffer;
+	Extension::GlobalRanking::HitAccumulator* global_ranking_buffer;
 #ifndef __APPLE__
 	Container vq, vs;
 #endif
@@ -111,8 +115,14 @@ struct WorkSet {
 	KmerRanking* kmer_ranking;
 };
 
-void run_stage1(JoinIterator<PackedLoc>& it, WorkSet* work_set, const Search::Config* cfg);
-void run_stage1(JoinIterator<PackedLocId>& it, WorkSet* work_set, const Search::Config* cfg);
+// Runs the stage 1 kernel on the seed groups of a join result, skipping groups with more than max_work seed pairs.
+void run_stage1(JoinIterator<PackedLoc>& it, WorkSet* work_set, const Search::Config* cfg, uint64_t max_work);
+void run_stage1(JoinIterator<PackedLocId>& it, WorkSet* work_set, const Search::Config* cfg, uint64_t max_work);
+// Runs the stage 1 kernel on a range of query seeds x a range of subject seeds of one seed group.
+void run_stage1(const PackedLoc* q, uint32_t nq, const PackedLoc* s, uint32_t ns, WorkSet* work_set);
+void run_stage1(const PackedLocId* q, uint32_t nq, const PackedLocId* s, uint32_t ns, WorkSet* work_set);
+// True if the stage 1 kernel selected by the configuration can process a seed group in independent tile ranges.
+bool stage1_splittable(const Search::Config* cfg);
 
 inline bool keep_target_id(const Search::Config& cfg) {
 #ifdef HIT_KEEP_TARGET_ID
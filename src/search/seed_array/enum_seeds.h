@@ -57,30 +57,46 @@ template<typename F, typename Filter, bool SKIP_SEED_POSITIONS>
 //Search::SeedStats FLATTEN enum_seeds(SequenceSet* seqs, F* f, unsigned begin, unsigned end, const Filter* filter, const EnumCfg& cfg)
 Search::SeedStats enum_seeds(SequenceSet* seqs, F* f, unsigned begin, unsigned end, const Filter* filter, const EnumCfg& cfg)
 {
+	// The sequences are reduced in chunks that stay in cache while the seeds are enumerated shape by shape, so that each sequence
+	// is reduced once for all shapes and only the output buffers of one shape are in use at a time.
+	constexpr int64_t CHUNK_LETTERS = 1 << 16;
+	const Reduction& reduction = Reduction::get_reduction();
 	uint64_t key;
 	Search::SeedStats stats;
-	GrowableBuffer<Letter> buf(300);
-	for (unsigned i = begin; i < end; ++i) {
-		if (UNLIKELY(cfg.skip) && (*cfg.skip)[i / align_mode.query_contexts])
-			continue;
-		if(UNLIKELY(config.min_query_len > 0) && seqs->source_length(i) < config.min_query_len)
-			continue;
-		const Sequence seq = (*seqs)[i];
-		const auto l = seq.length();
-		Reduction::reduce_seq(seq, buf);
+	GrowableBuffer<Letter> buf(CHUNK_LETTERS);
+	auto skip = [&](unsigned i) {
+		return (UNLIKELY(cfg.skip) && (*cfg.skip)[i / align_mode.query_contexts])
+			|| (UNLIKELY(config.min_query_len > 0) && seqs->source_length(i) < config.min_query_len);
+	};
+	for (unsigned chunk_begin = begin, chunk_end; chunk_begin < end; chunk_begin = chunk_end) {
+		int64_t letters = 0;
+		for (chunk_end = chunk_begin; chunk_end < end && (letters == 0 || letters < CHUNK_LETTERS); ++chunk_end)
+			letters += seqs->length(chunk_end);
+		buf.ensure_capacity(letters);
+		Letter* dst = buf.data();
+		for (unsigned i = chunk_begin; i < chunk_end; ++i) {
+			const Sequence seq = (*seqs)[i];
+			if (!skip(i))
+				for (Loc j = 0; j < seq.length(); ++j)
+					dst[j] = reduction(seq[j]);
+			dst += seq.length();
+		}
 		for (int shape_id = cfg.shape_begin; shape_id < cfg.shape_end; ++shape_id) {
 			const Shape& sh = shapes[shape_id];
-			if (UNLIKELY(l < sh.length_)) continue;
-			SeedIterator<const Letter*> it(buf.data(), buf.data() + l, sh);
-			Letter* ptr = seqs->ptr(i);
-			Loc j = 0;
-			while (it.good()) {
-				if (it.get(key, sh)) {
-					const uint64_t pos = seqs->position(i, j);
-					if (!skip_seed_position<SKIP_SEED_POSITIONS>(cfg, shape_id, pos) && filter->contains(key, shape_id))
-						(*f)(key, pos, i, shape_id);
+			const Letter* reduced = buf.data();
+			for (unsigned i = chunk_begin; i < chunk_end; reduced += seqs->length(i), ++i) {
+				const Loc l = seqs->length(i);
+				if (UNLIKELY(l < sh.length_) || skip(i)) continue;
+				SeedIterator<const Letter*> it(reduced, reduced + l, sh);
+				Loc j = 0;
+				while (it.good()) {
+					if (it.get(key, sh)) {
+						const uint64_t pos = seqs->position(i, j);
+						if (!skip_seed_position<SKIP_SEED_POSITIONS>(cfg, shape_id, pos) && filter->contains(key, shape_id))
+							(*f)(key, pos, i, shape_id);
+					}
+					++j;
 				}
-				++j;
 			}
 		}
 	}
@@ -28,8 +28,9 @@ using std::array;
 
 namespace DISPATCH_ARCH {
 
-template char* SeedArray<PackedLoc>::alloc_buffer(const SeedHistogram&, int);
+template char* SeedArray<PackedLoc>::alloc_buffer(const SeedHistogram&, int, const vector<int>&);
 
 template SeedArray<PackedLoc>::SeedArray(Block&, const ShapeHistogram&, const SeedPartitionRange&, int, char* buffer, const NoFilter*, const EnumCfg&);
+template vector<SeedArray<PackedLoc>*> SeedArray<PackedLoc>::build(Block&, const SeedHistogram&, const SeedPartitionRange&, int, char*, const NoFilter*, const EnumCfg&);
 
 }
\ No newline at end of file
@@ -23,6 +23,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "search/seed_complexity.h"
 #include "flags.h"
 #include "util/memory/alignment.h"
+#include "util/memory/huge_pages.h"
+#include "util/system/numa.h"
 
 #ifndef DISPATCH_ARCH
 #define DISPATCH_ARCH ARCH_GENERIC
@@ -89,6 +91,11 @@ struct SeedArray
 	template<typename Filter>
 	SeedArray(Block& seqs, const SeedPartitionRange& range, int seedp_bits, const Filter* filter, EnumCfg& cfg);
 
+	// Builds the arrays of the shapes [enum_cfg.shape_begin, enum_cfg.shape_end) in a single pass over the sequences. The arrays are placed
+	// back to back into the buffer, which has to hold the seeds of all shapes in the range.
+	template<typename Filter>
+	static std::vector<SeedArray*> build(Block& seqs, const SeedHistogram& hst, const SeedPartitionRange& range, int seedp_bits, char* buffer, const Filter* filter, const EnumCfg& enum_cfg);
+
 	Entry* begin(unsigned i)
 	{
 		if (data_)
@@ -130,9 +137,13 @@ struct SeedArray
 	}
 
 	//static char *alloc_buffer(const SeedHistogram &hst, int index_chunks);
-	static char* alloc_buffer(const SeedHistogram& hst, int index_chunks)
+	static char* alloc_buffer(const SeedHistogram& hst, int index_chunks, const std::vector<int>& shape_batches)
 	{
-		return (char*)Util::Memory::aligned_malloc(sizeof(Entry) * hst.max_chunk_size(index_chunks), 32);
+		const size_t size = sizeof(Entry) * hst.max_chunk_size(index_chunks, shape_batches);
+		char* p = (char*)Util::Memory::huge_alloc(size);
+		if (Util::Numa::active())
+			Util::Numa::interleave(p, size);
+		return p;
 		//return new char[sizeof(Entry) * hst.max_chunk_size(index_chunks)];
 	}
 
@@ -140,6 +151,8 @@ struct SeedArray
 
 private:
 
+	SeedArray(const ShapeHistogram& hst, const SeedPartitionRange& range, int seedp_bits, char* buffer, SeedEncoding code);
+
 	Entry *data_;
 	std::vector<size_t> begin_;
 	std::vector<std::vector<Entry>> entries_;
@@ -30,13 +30,18 @@ using std::array;
 
 namespace DISPATCH_ARCH {
 
-template char* SeedArray<PackedLocId>::alloc_buffer(const SeedHistogram&, int);
+template char* SeedArray<PackedLocId>::alloc_buffer(const SeedHistogram&, int, const vector<int>&);
 
 template SeedArray<PackedLoc>::SeedArray(Block&, const ShapeHistogram&, const SeedPartitionRange&, int, char* buffer, const SeedSet*, const EnumCfg&);
 template SeedArray<PackedLoc>::SeedArray(Block&, const ShapeHistogram&, const SeedPartitionRange&, int, char* buffer, const HashedSeedSet*, const EnumCfg&);
 template SeedArray<PackedLocId>::SeedArray(Block&, const ShapeHistogram&, const SeedPartitionRange&, int, char* buffer, const NoFilter*, const EnumCfg&);
 template SeedArray<PackedLocId>::SeedArray(Block&, const ShapeHistogram&, const SeedPartitionRange&, int, char* buffer, const SeedSet*, const EnumCfg&);
 template SeedArray<PackedLocId>::SeedArray(Block&, const ShapeHistogram&, const SeedPartitionRange&, int, char* buffer, const HashedSeedSet*, const EnumCfg&);
+template vector<SeedArray<PackedLoc>*> SeedArray<PackedLoc>::build(Block&, const SeedHistogram&, const SeedPartitionRange&, int, char*, const SeedSet*, const EnumCfg&);
+template vector<SeedArray<PackedLoc>*> SeedArray<PackedLoc>::build(Block&, const SeedHistogram&, const SeedPartitionRange&, int, char*, const HashedSeedSet*, const EnumCfg&);
+template vector<SeedArray<PackedLocId>*> SeedArray<PackedLocId>::build(Block&, const SeedHistogram&, const SeedPartitionRange&, int, char*, const NoFilter*, const EnumCfg&);
+template vector<SeedArray<PackedLocId>*> SeedArray<PackedLocId>::build(Block&, const SeedHistogram&, const SeedPartitionRange&, int, char*, const SeedSet*, const EnumCfg&);
+template vector<SeedArray<PackedLocId>*> SeedArray<PackedLocId>::build(Block&, const SeedHistogram&, const SeedPartitionRange&, int, char*, const HashedSeedSet*, const EnumCfg&);
 
 template<typename SeedLoc>
 struct OnePassBufferedWriter
@@ -39,11 +39,10 @@ static inline int seed_bits(const SeedEncoding code, int seedp_bits) {
 	throw std::runtime_error("Unknown seed encoding.");
 }
 
-template<typename SeedLoc>
+template<typename SeedLoc, unsigned BUFFER_SIZE = 64>
 struct BufferedWriter
 {
 	using Entry = typename SeedArray<SeedLoc>::Entry;
-	static const unsigned BUFFER_SIZE = 64;
 	struct PartitionState {
 		uint32_t n;
 		Entry buf[BUFFER_SIZE];
@@ -126,18 +125,48 @@ static PtrSet<SeedLoc> build_iterators(SeedArray<SeedLoc>& sa, const ShapeHistog
 	return iterators;
 }
 
-template<typename SeedLoc> template<typename Filter>
-SeedArray<SeedLoc>::SeedArray(Block& seqs, const ShapeHistogram& hst, const SeedPartitionRange& range, int seedp_bits, char* buffer, const Filter* filter, const EnumCfg& enum_cfg) :
-	key_bits(seed_bits(enum_cfg.code, seedp_bits)),
+// Like BuildCallback, but distributes the seeds of several shapes into their own arrays.
+template<typename SeedLoc>
+struct MultiShapeBuildCallback
+{
+	MultiShapeBuildCallback(const SeedPartitionRange& range, const vector<typename SeedArray<SeedLoc>::Entry* const*>& ptr, int seedp_bits, int shape_begin) :
+		shape_begin(shape_begin)
+	{
+		it.reserve(ptr.size());
+		for (auto p : ptr)
+			it.emplace_back(p, seedp_bits, range);
+	}
+	bool operator()(uint64_t seed, uint64_t pos, uint32_t block_id, size_t shape)
+	{
+		it[shape - shape_begin].push(seed, pos, block_id);
+		return true;
+	}
+	void finish()
+	{
+		for (auto& i : it)
+			i.flush();
+	}
+	const int shape_begin;
+	vector<BufferedWriter<SeedLoc, 64>> it;
+};
+
+template<typename SeedLoc>
+SeedArray<SeedLoc>::SeedArray(const ShapeHistogram& hst, const SeedPartitionRange& range, int seedp_bits, char* buffer, SeedEncoding code) :
+	key_bits(seed_bits(code, seedp_bits)),
 	data_((Entry*)buffer)
 {
-	if (enum_cfg.shape_end - enum_cfg.shape_begin > 1)
-		throw std::runtime_error("SeedArray construction for >1 shape.");
 	begin_.reserve(range.size() + 1);
 	begin_.push_back(0);
 	for (SeedPartition i = range.begin(); i < range.end(); ++i)
 		begin_.push_back(begin_.back() + partition_size(hst, i));
+}
 
+template<typename SeedLoc> template<typename Filter>
+SeedArray<SeedLoc>::SeedArray(Block& seqs, const ShapeHistogram& hst, const SeedPartitionRange& range, int seedp_bits, char* buffer, const Filter* filter, const EnumCfg& enum_cfg) :
+	SeedArray(hst, range, seedp_bits, buffer, enum_cfg.code)
+{
+	if (enum_cfg.shape_end - enum_cfg.shape_begin > 1)
+		throw std::runtime_error("SeedArray construction for >1 shape.");
 	PtrSet<SeedLoc> iterators(build_iterators(*this, hst, range));
 	PtrVector<BuildCallback<SeedLoc>> cb;
 	cb.reserve(enum_cfg.partition->size() - 1);
@@ -146,4 +175,28 @@ SeedArray<SeedLoc>::SeedArray(Block& seqs, const ShapeHistogram& hst, const Seed
 	stats_ = enum_seeds(seqs, cb, filter, enum_cfg);
 }
 
+template<typename SeedLoc> template<typename Filter>
+vector<SeedArray<SeedLoc>*> SeedArray<SeedLoc>::build(Block& seqs, const SeedHistogram& hst, const SeedPartitionRange& range, int seedp_bits, char* buffer, const Filter* filter, const EnumCfg& enum_cfg)
+{
+	vector<SeedArray*> arrays;
+	vector<PtrSet<SeedLoc>> iterators;
+	for (int shape = enum_cfg.shape_begin; shape < enum_cfg.shape_end; ++shape) {
+		arrays.push_back(new SeedArray(hst.get(shape), range, seedp_bits, buffer, enum_cfg.code));
+		buffer += sizeof(Entry) * arrays.back()->size();
+		iterators.push_back(build_iterators(*arrays.back(), hst.get(shape), range));
+	}
+	PtrVector<MultiShapeBuildCallback<SeedLoc>> cb;
+	cb.reserve(enum_cfg.partition->size() - 1);
+	for (size_t i = 0; i < enum_cfg.partition->size() - 1; ++i) {
+		vector<Entry* const*> ptr;
+		for (const PtrSet<SeedLoc>& it : iterators)
+			ptr.push_back(it[i].data());
+		cb.push_back(new MultiShapeBuildCallback<SeedLoc>(range, ptr, seedp_bits, enum_cfg.shape_begin));
+	}
+	const Search::SeedStats stats = enum_seeds(seqs, cb, filter, enum_cfg);
+	for (SeedArray* a : arrays)
+		a->stats_ = stats;
+	return arrays;
+}
+
 }
\ No newline at end of file
@@ -32,13 +32,17 @@ SeedPartitionRange current_range;
 SeedHistogram::SeedHistogram()
 { }
 
-size_t SeedHistogram::max_chunk_size(const int index_chunks) const
+size_t SeedHistogram::max_chunk_size(const int index_chunks, const vector<int>& shape_batches) const
 {
 	size_t max = 0;
 	::Partition<int> p(seedp(), index_chunks);
-	for (int shape = 0; shape < shapes.count(); ++shape)
-		for (int chunk = 0; chunk < p.parts; ++chunk)
-			max = std::max(max, hst_size(data_[shape], SeedPartitionRange(p.begin(chunk), p.end(chunk))));
+	for (size_t batch = 0; batch + 1 < shape_batches.size(); ++batch)
+		for (int chunk = 0; chunk < p.parts; ++chunk) {
+			size_t n = 0;
+			for (int shape = shape_batches[batch]; shape < shape_batches[batch + 1]; ++shape)
+				n += hst_size(data_[shape], SeedPartitionRange(p.begin(chunk), p.end(chunk)));
+			max = std::max(max, n);
+		}
 	return max;
 }
 
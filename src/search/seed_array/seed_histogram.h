@@ -83,7 +83,8 @@ struct SeedHistogram
 	const ShapeHistogram& get(unsigned sid) const
 	{ return data_[sid]; }
 
-	size_t max_chunk_size(const int index_chunks) const;
+	// Maximum number of seeds of an index chunk, summed over the shapes of a batch. Batches are given by their boundaries.
+	size_t max_chunk_size(const int index_chunks, const std::vector<int>& shape_batches) const;
 
 	const std::vector<uint32_t>& partition() const
 	{
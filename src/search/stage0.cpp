@@ -20,11 +20,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <thread>
 #include <utility>
 #include <atomic>
+#include <numeric>
+#include <algorithm>
 #include "search.h"
 #include "search/seed_array/seed_array.h"
 #include "data/frequent_seeds.h"
 #include "util/data_structures/double_array.h"
 #include "util/system/system.h"
+#include "util/system/numa.h"
 #include "util/data_structures/deque.h"
 #include "search/hit_buffer.h"
 #include "basic/seed.h"
@@ -38,6 +41,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util/log_stream.h"
 #include "util/parallel/simple_thread_pool.h"
 #include "util/simd/dispatch.h"
+#include "align/global_ranking/global_ranking.h"
 
 using std::vector;
 using std::atomic;
@@ -51,8 +55,68 @@ namespace Search { namespace DISPATCH_ARCH {
 
 using ::DISPATCH_ARCH::SeedArray;
 
-void run_stage1(JoinIterator<PackedLoc>& it, Search::WorkSet* work_set, const Search::Config* cfg);
-void run_stage1(JoinIterator<PackedLocId>& it, Search::WorkSet* work_set, const Search::Config* cfg);
+void run_stage1(JoinIterator<PackedLoc>& it, Search::WorkSet* work_set, const Search::Config* cfg, uint64_t max_work);
+void run_stage1(JoinIterator<PackedLocId>& it, Search::WorkSet* work_set, const Search::Config* cfg, uint64_t max_work);
+void run_stage1(const PackedLoc* q, uint32_t nq, const PackedLoc* s, uint32_t ns, Search::WorkSet* work_set);
+void run_stage1(const PackedLocId* q, uint32_t nq, const PackedLocId* s, uint32_t ns, Search::WorkSet* work_set);
+bool stage1_splittable(const Search::Config* cfg);
+
+// Query seeds x subject seeds of a seed group that is too large to be processed by a single worker.
+template<typename SeedLoc>
+struct Stage1Task {
+	const SeedLoc* q, * s;
+	uint32_t nq, ns;
+	bool first;
+};
+
+// Seed groups are split if they hold more than 1/SPLIT_GRANULARITY of the average work per thread.
+static const uint64_t SPLIT_GRANULARITY = 16;
+
+template<typename SeedLoc>
+static vector<Stage1Task<SeedLoc>> split_seed_groups(const SeedPartitionRange& range, DoubleArray<SeedLoc>* query_seed_hits, DoubleArray<SeedLoc>* ref_seed_hits, uint64_t& max_work) {
+	vector<Stage1Task<SeedLoc>> tasks;
+	vector<uint64_t> work(range.size(), 0);
+	atomic<SeedPartition> seedp(0);
+	auto worker = [&]() {
+		SeedPartition p;
+		while ((p = seedp.fetch_add(1, std::memory_order_relaxed)) < range.size())
+			for (auto it = JoinIterator<SeedLoc>(query_seed_hits[p].begin(), ref_seed_hits[p].begin()); it; ++it)
+				work[p] += (uint64_t)it.r->size() * it.s->size();
+	};
+	vector<thread> threads;
+	for (int i = 0; i < config.threads_; ++i)
+		threads.emplace_back(worker);
+	for (auto& t : threads)
+		t.join();
+
+	const uint64_t tile = config.tile_size, total = std::accumulate(work.begin(), work.end(), (uint64_t)0);
+	max_work = std::max(tile * tile, total / ((uint64_t)config.threads_ * SPLIT_GRANULARITY));
+	for (SeedPartition p = 0; p < range.size(); ++p) {
+		if (work[p] <= max_work)
+			continue;
+		for (auto it = JoinIterator<SeedLoc>(query_seed_hits[p].begin(), ref_seed_hits[p].begin()); it; ++it) {
+			const uint32_t nq = (uint32_t)it.r->size(), ns = (uint32_t)it.s->size();
+			if ((uint64_t)nq * ns <= max_work)
+				continue;
+			const uint64_t q_tiles = (nq + tile - 1) / tile, s_tiles = (ns + tile - 1) / tile,
+				pieces = ((uint64_t)nq * ns + max_work - 1) / max_work,
+				q_parts = std::min(q_tiles, pieces), s_parts = std::min(s_tiles, (pieces + q_parts - 1) / q_parts);
+			bool first = true;
+			for (uint64_t i = 0; i < q_parts; ++i) {
+				const uint32_t q_begin = uint32_t(q_tiles * i / q_parts * tile), q_end = uint32_t(std::min(q_tiles * (i + 1) / q_parts * tile, (uint64_t)nq));
+				for (uint64_t j = 0; j < s_parts; ++j) {
+					const uint32_t s_begin = uint32_t(s_tiles * j / s_parts * tile), s_end = uint32_t(std::min(s_tiles * (j + 1) / s_parts * tile, (uint64_t)ns));
+					tasks.push_back({ it.r->begin() + q_begin, it.s->begin() + s_begin, q_end - q_begin, s_end - s_begin, first });
+					first = false;
+				}
+			}
+		}
+	}
+	// Largest tasks first, so that the remaining ones even out the load.
+	std::stable_sort(tasks.begin(), tasks.end(), [](const Stage1Task<SeedLoc>& a, const Stage1Task<SeedLoc>& b) {
+		return (uint64_t)a.nq * a.ns > (uint64_t)b.nq * b.ns; });
+	return tasks;
+}
 
 template<typename SeedLoc>
 static void seed_join_worker(
@@ -61,8 +125,11 @@ static void seed_join_worker(
 	atomic<unsigned> *seedp,
 	SeedPartition partition_count,
 	DoubleArray<SeedLoc> *query_seed_hits,
-	DoubleArray<SeedLoc> *ref_seeds_hits)
+	DoubleArray<SeedLoc> *ref_seeds_hits,
+	size_t thread_id)
 {
+	if (Util::Numa::active())
+		Util::Numa::pin_thread(Util::Numa::worker_node(thread_id));
 	SeedPartition p;
 	const int bits = query_seeds->key_bits;
 	if (bits != ref_seeds->key_bits)
@@ -78,33 +145,128 @@ static void seed_join_worker(
 }
 
 template<typename SeedLoc>
-static void search_worker(const std::atomic<bool>& stop, atomic<SeedPartition> *seedp, SeedPartition partition_count, unsigned shape, size_t thread_id, DoubleArray<SeedLoc> *query_seed_hits, DoubleArray<SeedLoc> *ref_seed_hits, const Search::Context *context, const Search::Config* cfg)
+static void search_worker(const std::atomic<bool>& stop, atomic<SeedPartition> *seedp, SeedPartition partition_count, unsigned shape, size_t thread_id, DoubleArray<SeedLoc> *query_seed_hits, DoubleArray<SeedLoc> *ref_seed_hits, const Search::Context *context, const Search::Config* cfg,
+	const vector<Stage1Task<SeedLoc>>* tasks, atomic<size_t>* next_task, uint64_t max_work)
 {
-	using GRB = AsyncWriter<Hit, Search::Config::RankingBuffer::EXPONENT>;
+	const int numa_node = Util::Numa::active() ? Util::Numa::worker_node(thread_id) : -1;
+	if (numa_node >= 0)
+		Util::Numa::pin_thread(numa_node);
 	unique_ptr<HitBuffer::Writer> writer;
-	unique_ptr<GRB> grb;
+	unique_ptr<Extension::GlobalRanking::HitAccumulator> grb;
 	if (config.global_ranking_targets)
-		grb.reset(new GRB(*cfg->global_ranking_buffer));
+		grb.reset(new Extension::GlobalRanking::HitAccumulator(*cfg));
 	else
 		writer.reset(new HitBuffer::Writer(*cfg->seed_hit_buf, thread_id));
-	unique_ptr<Search::WorkSet> work_set(new Search::WorkSet(*context, *cfg, shape, writer.get(), grb.get(), context->kmer_ranking));
+	unique_ptr<Search::WorkSet> work_set(new Search::WorkSet(*context, *cfg, shape, writer.get(), grb.get(), context->kmer_ranking, numa_node));
 	SeedPartition p;
 	while (!stop && (p = seedp->fetch_add(1, std::memory_order_relaxed)) < partition_count) {
 		auto it = JoinIterator<SeedLoc>(query_seed_hits[p].begin(), ref_seed_hits[p].begin());
-		DISPATCH_ARCH::run_stage1(it, work_set.get(), cfg);
+		DISPATCH_ARCH::run_stage1(it, work_set.get(), cfg, max_work);
 	}
+	size_t i;
+	while (!stop && (i = next_task->fetch_add(1, std::memory_order_relaxed)) < tasks->size()) {
+		const Stage1Task<SeedLoc>& t = (*tasks)[i];
+		if (t.first)
+			work_set->stats.inc(Statistics::SEEDS_HIT);
+		DISPATCH_ARCH::run_stage1(t.q, t.nq, t.s, t.ns, work_set.get());
+	}
+	if (grb)
+		grb->flush();
 	writer.reset();
 	statistics += work_set->stats;
 }
 
 template<typename SeedLoc>
-void search_shape(int sid, int query_block, unsigned query_iteration, char *query_buffer, char *ref_buffer, Search::Config& cfg, const HashedSeedSet* target_seeds)
+static void search_arrays(int sid, const SeedPartitionRange& range, SeedArray<SeedLoc>* query_idx, SeedArray<SeedLoc>* ref_idx, Search::Config& cfg)
+{
+	SequenceSet& ref_seqs = cfg.target->seqs(), &query_seqs = cfg.query->seqs();
+	*log_stream << "Indexed query seeds = " << Util::String::ratio_percentage(query_idx->size(), query_seqs.letters())
+		<< ", reference seeds = " << Util::String::ratio_percentage(ref_idx->size(), ref_seqs.letters()) << endl;
+	*log_stream << "Soft masked letters = " << Util::String::ratio_percentage(cfg.query->soft_masked_letters(), cfg.query->seqs().letters())
+		<< ", " << Util::String::ratio_percentage(cfg.target->soft_masked_letters(), cfg.target->seqs().letters()) << endl;
+	/*log_stream << "Low complexity seeds = " << Util::String::ratio_percentage(query_idx->stats().low_complexity_seeds, query_idx->stats().good_seed_positions)
+		<< ", " << Util::String::ratio_percentage(ref_idx->stats().low_complexity_seeds, ref_idx->stats().good_seed_positions) << endl;*/
+
+	TaskTimer timer("Computing hash join");
+	atomic<SeedPartition> seedp(0);
+	vector<std::thread> threads;
+	vector<DoubleArray<SeedLoc>> query_seed_hits(range.size()), ref_seed_hits(range.size());
+	for (int i = 0; i < config.threads_; ++i)
+		threads.emplace_back(seed_join_worker<SeedLoc>, query_idx, ref_idx, &seedp, range.size(), query_seed_hits.data(), ref_seed_hits.data(), i);
+	for (auto &t : threads)
+		t.join();
+	timer.finish();
+	log_rss();
+
+	if(config.freq_masking && !config.lin_stage1_query && !cfg.lin_stage1_target) {
+		timer.go("Building seed filter");
+		frequent_seeds.build(sid, range, query_seed_hits.data(), ref_seed_hits.data(), cfg);
+	}
+	else
+		Search::mask_seeds(shapes[sid], range, query_seed_hits.data(), ref_seed_hits.data(), cfg);
+
+	log_rss();
+	unique_ptr<KmerRanking> kmer_ranking;
+	if (Search::keep_target_id(cfg) && config.lin_stage1_query) {
+		timer.go("Building kmer ranking");
+		kmer_ranking.reset(config.kmer_ranking ? new KmerRanking(cfg.query->seqs(), range.size(), query_seed_hits.data(), ref_seed_hits.data())
+			: new KmerRanking(cfg.query->seqs()));
+	}
+
+	Search::Context* context = nullptr;
+	const vector<uint32_t> patterns = shapes.patterns(0, sid + 1);
+	context = new Search::Context{ {patterns.data(), patterns.data() + patterns.size() - 1 },
+		{patterns.data(), patterns.data() + patterns.size() },
+		score_matrix.rawscore(config.short_query_ungapped_bitscore),
+		kmer_ranking.get(),
+		seedp_mask(cfg.seedp_bits)
+	};
+
+	vector<Stage1Task<SeedLoc>> tasks;
+	uint64_t max_work = UINT64_MAX;
+	if (config.threads_ > 1 && DISPATCH_ARCH::stage1_splittable(&cfg)) {
+		timer.go("Splitting seed groups");
+		tasks = split_seed_groups(range, query_seed_hits.data(), ref_seed_hits.data(), max_work);
+		*log_stream << "Split seed groups: max work = " << max_work << ", tasks = " << tasks.size() << endl;
+	}
+
+	timer.go("Searching alignments");
+	seedp = 0;
+	atomic<size_t> next_task(0);
+	threads.clear();
+	vector<thread::id> search_workers;
+	for (int i = 0; i < config.threads_; ++i)
+		search_workers.push_back(cfg.search_pool.spawn(search_worker<SeedLoc>, &seedp, range.size(), sid, i, query_seed_hits.data(), ref_seed_hits.data(), context, &cfg, &tasks, &next_task, max_work));
+	try {
+		cfg.search_pool.join(search_workers.begin(), search_workers.end());
+	} catch(...) {
+		cfg.seed_hit_buf->finish_writing();			
+		throw;
+	}		
+	statistics.inc(Statistics::TIME_SEARCH, timer.microseconds());
+	timer.finish();
+	log_rss();
+
+	timer.go("Deallocating memory");
+	delete ref_idx;
+	delete query_idx;
+	delete context;
+	kmer_ranking.reset();
+	
+	timer.finish();
+	log_rss();
+}
+
+template<typename SeedLoc>
+void search_shapes(int shape_begin, int shape_end, int query_block, unsigned query_iteration, char *query_buffer, char *ref_buffer, Search::Config& cfg, const HashedSeedSet* target_seeds)
 {
 	using SA = SeedArray<SeedLoc>;
 	Partition<SeedPartition> p((SeedPartition)seedp_count(cfg.seedp_bits), cfg.index_chunks);
 	log_rss();
-	SequenceSet& ref_seqs = cfg.target->seqs(), &query_seqs = cfg.query->seqs();
 	const SeedHistogram& ref_hst = cfg.target->hst(), query_hst = cfg.query->hst();
+	const bool batch = shape_end - shape_begin > 1;
+	if (batch && (p.parts > 1 || target_seeds))
+		throw runtime_error("Shape batches require a single index chunk and a query seed array.");
 
 	for (unsigned chunk = 0; chunk < p.parts; ++chunk) {
 		*message_stream << "Processing query block " << query_block + 1;
@@ -113,118 +275,68 @@ void search_shape(int sid, int query_block, unsigned query_iteration, char *quer
 		*message_stream << ", reference block " << (cfg.current_ref_block + 1);
 		if (cfg.ref_blocks)
 			*message_stream << "/" << cfg.ref_blocks.value();
-		*message_stream	<< ", shape " << (sid + 1) << "/" << shapes.count();
+		if (batch)
+			*message_stream << ", shapes " << (shape_begin + 1) << "-" << shape_end << "/" << shapes.count();
+		else
+			*message_stream << ", shape " << (shape_begin + 1) << "/" << shapes.count();
 		if (cfg.index_chunks > 1)
 			*message_stream << ", index chunk " << chunk + 1 << "/" << cfg.index_chunks;
 		*message_stream << '.' << endl;
 		const SeedPartitionRange range(p.begin(chunk), p.end(chunk));
 		current_range = range;
 
-		TaskTimer timer("Building reference seed array", true);
-		SA *ref_idx;
-		const EnumCfg enum_ref{ &ref_hst.partition(), sid, sid + 1, cfg.seed_encoding, nullptr, false, false, cfg.seed_complexity_cut,
+		// In a batch, the sequences are scanned, reduced and soft masked once for all shapes.
+		TaskTimer timer(batch ? "Building reference seed arrays" : "Building reference seed array", true);
+		vector<SA*> ref_idx;
+		const EnumCfg enum_ref{ &ref_hst.partition(), shape_begin, shape_end, cfg.seed_encoding, nullptr, false, false, cfg.seed_complexity_cut,
 			query_seeds_bitset.get() || (bool)query_seeds_hashed ? MaskingAlgo::NONE : cfg.soft_masking,
 			cfg.minimizer_window, false, false, cfg.sketch_size, cfg.target_seed_hits.get() };
 		if (query_seeds_bitset.get())
-			ref_idx = new SA(*cfg.target, ref_hst.get(sid), range, cfg.seedp_bits, ref_buffer, query_seeds_bitset.get(), enum_ref);
+			ref_idx = batch ? SA::build(*cfg.target, ref_hst, range, cfg.seedp_bits, ref_buffer, query_seeds_bitset.get(), enum_ref)
+				: vector<SA*>{ new SA(*cfg.target, ref_hst.get(shape_begin), range, cfg.seedp_bits, ref_buffer, query_seeds_bitset.get(), enum_ref) };
 		else if (query_seeds_hashed.get())
-			ref_idx = new SA(*cfg.target, ref_hst.get(sid), range, cfg.seedp_bits, ref_buffer, query_seeds_hashed.get(), enum_ref);
+			ref_idx = batch ? SA::build(*cfg.target, ref_hst, range, cfg.seedp_bits, ref_buffer, query_seeds_hashed.get(), enum_ref)
+				: vector<SA*>{ new SA(*cfg.target, ref_hst.get(shape_begin), range, cfg.seedp_bits, ref_buffer, query_seeds_hashed.get(), enum_ref) };
 			//ref_idx = new SeedArray(ref_seqs, sid, range, query_seeds_hashed.get(), true);
 		else
-			ref_idx = new SA(*cfg.target, ref_hst.get(sid), range, cfg.seedp_bits, ref_buffer, &no_filter, enum_ref);
+			ref_idx = batch ? SA::build(*cfg.target, ref_hst, range, cfg.seedp_bits, ref_buffer, &no_filter, enum_ref)
+				: vector<SA*>{ new SA(*cfg.target, ref_hst.get(shape_begin), range, cfg.seedp_bits, ref_buffer, &no_filter, enum_ref) };
 		timer.finish();
 		log_rss();
 
-		timer.go("Building query seed array");
-		SA* query_idx;
-		EnumCfg enum_query{ target_seeds ? nullptr : &query_hst.partition(), sid, sid + 1, cfg.seed_encoding, cfg.query_skip.get(),
+		timer.go(batch ? "Building query seed arrays" : "Building query seed array");
+		vector<SA*> query_idx;
+		EnumCfg enum_query{ target_seeds ? nullptr : &query_hst.partition(), shape_begin, shape_end, cfg.seed_encoding, cfg.query_skip.get(),
 			false, true, cfg.seed_complexity_cut, cfg.soft_masking, cfg.minimizer_window, static_cast<bool>(query_seeds_hashed.get()),
 			static_cast<bool>(query_seeds_hashed.get()), cfg.sketch_size, config.self ? cfg.target_seed_hits.get() : nullptr };
 		if (target_seeds)
-			query_idx = new SA(*cfg.query, range, cfg.seedp_bits, target_seeds, enum_query);
+			query_idx.push_back(new SA(*cfg.query, range, cfg.seedp_bits, target_seeds, enum_query));
+		else if (batch)
+			query_idx = SA::build(*cfg.query, query_hst, range, cfg.seedp_bits, query_buffer, &no_filter, enum_query);
 		else
-			query_idx = new SA(*cfg.query, query_hst.get(sid), range, cfg.seedp_bits, query_buffer, &no_filter, enum_query);
-		timer.finish();
-		log_rss();
-
-		*log_stream << "Indexed query seeds = " << Util::String::ratio_percentage(query_idx->size(), query_seqs.letters())
-			<< ", reference seeds = " << Util::String::ratio_percentage(ref_idx->size(), ref_seqs.letters()) << endl;
-		*log_stream << "Soft masked letters = " << Util::String::ratio_percentage(cfg.query->soft_masked_letters(), cfg.query->seqs().letters())
-			<< ", " << Util::String::ratio_percentage(cfg.target->soft_masked_letters(), cfg.target->seqs().letters()) << endl;
-		/*log_stream << "Low complexity seeds = " << Util::String::ratio_percentage(query_idx->stats().low_complexity_seeds, query_idx->stats().good_seed_positions)
-			<< ", " << Util::String::ratio_percentage(ref_idx->stats().low_complexity_seeds, ref_idx->stats().good_seed_positions) << endl;*/
-
-		timer.go("Computing hash join");
-		atomic<SeedPartition> seedp(0);
-		vector<std::thread> threads;
-		vector<DoubleArray<SeedLoc>> query_seed_hits(range.size()), ref_seed_hits(range.size());
-		for (int i = 0; i < config.threads_; ++i)
-			threads.emplace_back(seed_join_worker<SeedLoc>, query_idx, ref_idx, &seedp, range.size(), query_seed_hits.data(), ref_seed_hits.data());
-		for (auto &t : threads)
-			t.join();
+			query_idx.push_back(new SA(*cfg.query, query_hst.get(shape_begin), range, cfg.seedp_bits, query_buffer, &no_filter, enum_query));
 		timer.finish();
 		log_rss();
 
-		if(config.freq_masking && !config.lin_stage1_query && !cfg.lin_stage1_target) {
-			timer.go("Building seed filter");
-			frequent_seeds.build(sid, range, query_seed_hits.data(), ref_seed_hits.data(), cfg);
-		}
-		else
-			Search::mask_seeds(shapes[sid], range, query_seed_hits.data(), ref_seed_hits.data(), cfg);
-
-		log_rss();
-		unique_ptr<KmerRanking> kmer_ranking;
-		if (Search::keep_target_id(cfg) && config.lin_stage1_query) {
-			timer.go("Building kmer ranking");
-			kmer_ranking.reset(config.kmer_ranking ? new KmerRanking(cfg.query->seqs(), range.size(), query_seed_hits.data(), ref_seed_hits.data())
-				: new KmerRanking(cfg.query->seqs()));
+		for (int sid = shape_begin; sid < shape_end; ++sid) {
+			if (batch)
+				*message_stream << "Searching shape " << (sid + 1) << "/" << shapes.count() << '.' << endl;
+			search_arrays(sid, range, query_idx[sid - shape_begin], ref_idx[sid - shape_begin], cfg);
+			if (config.global_ranking_targets && chunk + 1 == p.parts)
+				Extension::GlobalRanking::update_table(cfg);
 		}
-
-		Search::Context* context = nullptr;
-		const vector<uint32_t> patterns = shapes.patterns(0, sid + 1);
-		context = new Search::Context{ {patterns.data(), patterns.data() + patterns.size() - 1 },
-			{patterns.data(), patterns.data() + patterns.size() },
-			score_matrix.rawscore(config.short_query_ungapped_bitscore),
-			kmer_ranking.get(),
-			seedp_mask(cfg.seedp_bits)
-		};
-
-		timer.go("Searching alignments");
-		seedp = 0;
-		threads.clear();
-		vector<thread::id> search_workers;
-		for (int i = 0; i < config.threads_; ++i)
-			search_workers.push_back(cfg.search_pool.spawn(search_worker<SeedLoc>, &seedp, range.size(), sid, i, query_seed_hits.data(), ref_seed_hits.data(), context, &cfg));
-		try {
-			cfg.search_pool.join(search_workers.begin(), search_workers.end());
-		} catch(...) {
-			cfg.seed_hit_buf->finish_writing();			
-			throw;
-		}		
-		statistics.inc(Statistics::TIME_SEARCH, timer.microseconds());
-		timer.finish();
-		log_rss();
-
-		timer.go("Deallocating memory");
-		delete ref_idx;
-		delete query_idx;
-		delete context;
-		kmer_ranking.reset();
-		
-		timer.finish();
-		log_rss();
 	}
 }
 
-void search_shape(unsigned sid, int query_block, unsigned query_iteration, char* query_buffer, char* ref_buffer, Search::Config& cfg, const HashedSeedSet* target_seeds) {
+void search_shapes(unsigned shape_begin, unsigned shape_end, int query_block, unsigned query_iteration, char* query_buffer, char* ref_buffer, Search::Config& cfg, const HashedSeedSet* target_seeds) {
 	if (Search::keep_target_id(cfg))
-		search_shape<PackedLocId>(sid, query_block, query_iteration, query_buffer, ref_buffer, cfg, target_seeds);
+		search_shapes<PackedLocId>(shape_begin, shape_end, query_block, query_iteration, query_buffer, ref_buffer, cfg, target_seeds);
 	else
-		search_shape<PackedLoc>(sid, query_block, query_iteration, query_buffer, ref_buffer, cfg, target_seeds);
+		search_shapes<PackedLoc>(shape_begin, shape_end, query_block, query_iteration, query_buffer, ref_buffer, cfg, target_seeds);
 }
 
 }
 
-DISPATCH_7V(search_shape, unsigned, sid, int, query_block, unsigned, query_iteration, char*, query_buffer, char*, ref_buffer, Search::Config&, cfg, const HashedSeedSet*, target_seeds)
+DISPATCH_8V(search_shapes, unsigned, shape_begin, unsigned, shape_end, int, query_block, unsigned, query_iteration, char*, query_buffer, char*, ref_buffer, Search::Config&, cfg, const HashedSeedSet*, target_seeds)
 
 }
\ No newline at end of file
@@ -63,7 +63,7 @@ static int ungapped_window(int query_len) {
 }
 
 static pair<unsigned, Loc> query_data(const PackedLoc q, const SequenceSet& query_seqs) {
-	pair<size_t, size_t> l = query_seqs.local_position((uint64_t)q); // lazy eval?
+	pair<size_t, size_t> l = query_seqs.local_position((uint64_t)q);
 	return { (unsigned)l.first, (unsigned)l.second };
 }
 static pair<unsigned, Loc> query_data(const PackedLocId q, const SequenceSet& query_seqs) {
@@ -79,7 +79,7 @@ static void search_query_offset(const SeedLoc& q,
 	WorkSet& work_set)
 {
 	constexpr int N = ::DISPATCH_ARCH::SIMD::Vector<int8_t>::LANES;
-	const SequenceSet& ref_seqs = work_set.cfg.target->seqs(), &query_seqs = work_set.cfg.query->seqs();
+	const SequenceSet& ref_seqs = work_set.ref_seqs, &query_seqs = work_set.cfg.query->seqs();
 	const Letter* query = query_seqs.data(q);
 
 	const Letter* subjects[N];
@@ -0,0 +1,141 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <math.h>
+#include <algorithm>
+#include "evalue_table.h"
+#include "util/simd.h"
+
+using std::max;
+
+// Raw scores with precomputed terms.
+static const int MAX_SCORE = 4096;
+// Above X_HI, Phi(x) = 1 and g(x) = x up to double precision. Below X_LO, the exact evaluation is used.
+static const double X_LO = -2.0, X_HI = 8.0;
+// Bound on the relative interpolation error of g and Phi on [X_LO, X_HI] per squared step width.
+static const double INTERPOLATION_ERROR = 0.8;
+static const double MIN_STEP = 1e-4;
+
+static double normal_cdf(double x) {
+	return 0.5 * erfc(-x / sqrt(2.0));
+}
+
+static double normal_pdf(double x) {
+	return exp(-0.5 * x * x) / sqrt(2.0 * M_PI);
+}
+
+EvalueTable::EvalueTable(const Sls::ALP_set_of_parameters& params, double scale, double max_rel_error):
+	params_(params),
+	scale_(scale),
+	max_rel_error_(max_rel_error)
+{
+	if (!enabled())
+		return;
+	// The area is a sum of products of two interpolated factors.
+	x_step_ = max(sqrt(max_rel_error / (4.0 * INTERPOLATION_ERROR)), MIN_STEP);
+	inv_x_step_ = 1.0 / x_step_;
+	const int nodes = (int)ceil((X_HI - X_LO) * inv_x_step_) + 2;
+	g_.reserve(nodes);
+	phi_.reserve(nodes);
+	for (int i = 0; i < nodes; ++i) {
+		const double x = X_LO + i * x_step_, p = normal_cdf(x);
+		g_.push_back(x * p + normal_pdf(x));
+		phi_.push_back(p);
+	}
+	terms_.reserve(MAX_SCORE);
+	for (int s = 0; s < MAX_SCORE; ++s)
+		terms_.push_back(terms(s / scale_));
+}
+
+EvalueTable::Terms EvalueTable::terms(double y) const {
+	Terms t;
+	t.tmp_i = params_.a_I * y + params_.b_I;
+	t.sqrt_vi = sqrt(max(params_.vi_y_thr, params_.alpha_I * y + params_.beta_I));
+	t.inv_sqrt_vi = t.sqrt_vi == 0.0 ? 0.0 : 1.0 / t.sqrt_vi;
+	t.tmp_j = params_.a_J * y + params_.b_J;
+	t.sqrt_vj = sqrt(max(params_.vj_y_thr, params_.alpha_J * y + params_.beta_J));
+	t.inv_sqrt_vj = t.sqrt_vj == 0.0 ? 0.0 : 1.0 / t.sqrt_vj;
+	t.c = max(params_.c_y_thr, params_.sigma * y + params_.tau);
+	t.evalue_per_area = params_.K * exp(-params_.lambda * y);
+	return t;
+}
+
+bool EvalueTable::side(double len, double tmp, double sqrt_v, double inv_sqrt_v, double& p, double& phi) const {
+	const double d = len - tmp, x = d * inv_sqrt_v;
+	if (sqrt_v == 0.0 || x >= X_HI) {
+		p = d;
+		phi = 1.0;
+		return true;
+	}
+	if (x < X_LO)
+		return false;
+	const double f = (x - X_LO) * inv_x_step_;
+	const int i = (int)f;
+	const double w = f - i;
+	p = sqrt_v * (g_[i] + w * (g_[i + 1] - g_[i]));
+	phi = phi_[i] + w * (phi_[i + 1] - phi_[i]);
+	return true;
+}
+
+double EvalueTable::area(const Terms& t, double query_len, double subject_len) const {
+	double p1, phi1, p2, phi2;
+	if (!side(subject_len, t.tmp_i, t.sqrt_vi, t.inv_sqrt_vi, p1, phi1) || !side(query_len, t.tmp_j, t.sqrt_vj, t.inv_sqrt_vj, p2, phi2))
+		return -1.0;
+	return p1 * p2 + t.c * phi1 * phi2;
+}
+
+double EvalueTable::area(int raw_score, double query_len, double subject_len) const {
+	Terms buf;
+	return area(score_terms(raw_score, buf), query_len, subject_len);
+}
+
+double EvalueTable::evalue(int raw_score, double query_len, double subject_len) const {
+	Terms buf;
+	const Terms& t = score_terms(raw_score, buf);
+	const double a = area(t, query_len, subject_len);
+	return a < 0.0 ? a : a * t.evalue_per_area;
+}
+
+void EvalueTable::evalue(const int* raw_score, unsigned query_len, const unsigned* subject_len, double* out, int64_t n) const {
+	int64_t i = 0;
+#ifdef __SSE2__
+	// Two hits per iteration on the common path where both lengths are far from the correction range.
+	const __m128d n_len = _mm_set1_pd((double)query_len), x_hi = _mm_set1_pd(X_HI);
+	for (; i + 2 <= n; i += 2) {
+		const int s0 = raw_score[i], s1 = raw_score[i + 1];
+		if (s0 < 0 || s0 >= (int)terms_.size() || s1 < 0 || s1 >= (int)terms_.size()) {
+			out[i] = evalue(s0, query_len, subject_len[i]);
+			out[i + 1] = evalue(s1, query_len, subject_len[i + 1]);
+			continue;
+		}
+		const Terms& t0 = terms_[s0], & t1 = terms_[s1];
+		const __m128d m = _mm_set_pd((double)subject_len[i + 1], (double)subject_len[i]);
+		const __m128d di = _mm_sub_pd(m, _mm_set_pd(t1.tmp_i, t0.tmp_i)), dj = _mm_sub_pd(n_len, _mm_set_pd(t1.tmp_j, t0.tmp_j));
+		const __m128d xi = _mm_mul_pd(di, _mm_set_pd(t1.inv_sqrt_vi, t0.inv_sqrt_vi)), xj = _mm_mul_pd(dj, _mm_set_pd(t1.inv_sqrt_vj, t0.inv_sqrt_vj));
+		const int fast = _mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(xi, x_hi), _mm_cmpge_pd(xj, x_hi)));
+		const __m128d area = _mm_add_pd(_mm_mul_pd(di, dj), _mm_set_pd(t1.c, t0.c));
+		alignas(16) double e[2];
+		_mm_store_pd(e, _mm_mul_pd(area, _mm_set_pd(t1.evalue_per_area, t0.evalue_per_area)));
+		out[i] = (fast & 1) ? e[0] : evalue(s0, query_len, subject_len[i]);
+		out[i + 1] = (fast & 2) ? e[1] : evalue(s1, query_len, subject_len[i + 1]);
+	}
+#endif
+	for (; i < n; ++i)
+		out[i] = evalue(raw_score[i], query_len, subject_len[i]);
+}
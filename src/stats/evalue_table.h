@@ -0,0 +1,73 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "alp/sls_pvalues.hpp"
+
+// Table-driven evaluation of the ALP e-value with finite size correction.
+// The corrected area is p1(y,m) * p2(y,n) + c(y) * P1(y,m) * P2(y,n), where each length dependent factor is
+// sqrt(v(y)) * g(x) or Phi(x) with x = (len - a*y - b) / sqrt(v(y)) and g(x) = x * Phi(x) + phi(x).
+// The score dependent terms are precomputed per raw score, g and Phi are interpolated over x.
+// A negative return value means that the arguments are not covered and the exact ALP evaluation must be used.
+struct EvalueTable {
+
+	EvalueTable():
+		max_rel_error_(0.0)
+	{}
+	EvalueTable(const Sls::ALP_set_of_parameters& params, double scale, double max_rel_error);
+
+	bool enabled() const {
+		return max_rel_error_ > 0.0;
+	}
+
+	double max_rel_error() const {
+		return max_rel_error_;
+	}
+
+	// Corrected area for query length n and subject length m.
+	double area(int raw_score, double query_len, double subject_len) const;
+	// Equivalent to AlignmentEvaluer::evalue(raw_score / scale, query_len, subject_len).
+	double evalue(int raw_score, double query_len, double subject_len) const;
+	void evalue(const int* raw_score, unsigned query_len, const unsigned* subject_len, double* out, int64_t n) const;
+
+private:
+
+	struct Terms {
+		double tmp_i, sqrt_vi, inv_sqrt_vi, tmp_j, sqrt_vj, inv_sqrt_vj, c, evalue_per_area;
+	};
+
+	Terms terms(double y) const;
+	bool side(double len, double tmp, double sqrt_v, double inv_sqrt_v, double& p, double& phi) const;
+	double area(const Terms& t, double query_len, double subject_len) const;
+
+	const Terms& score_terms(int raw_score, Terms& buf) const {
+		if (raw_score >= 0 && raw_score < (int)terms_.size())
+			return terms_[raw_score];
+		buf = terms(raw_score / scale_);
+		return buf;
+	}
+
+	Sls::ALP_set_of_parameters params_;
+	double scale_, max_rel_error_, x_step_, inv_x_step_;
+	std::vector<Terms> terms_;
+	std::vector<double> g_, phi_;
+
+};
@@ -68,6 +68,7 @@ ScoreMatrix::ScoreMatrix(const string & matrix, int gap_open, int gap_extend, in
 {	
 	evaluer.initParameters(alp_params(standard_matrix_, gap_open_, gap_extend_));
 	ln_k_ = std::log(evaluer.parameters().K);
+	evalue_table_ = EvalueTable(evaluer.parameters(), scale_, config.evalue_table_error);
 	init_background_scores();
 }
 
@@ -187,6 +188,7 @@ ScoreMatrix::ScoreMatrix(const string& matrix_file, int gap_open, int gap_extend
 		throw runtime_error("The ALP library failed to compute the statistical parameters for this matrix. It may help to adjust the gap penalty settings.");
 	}
 	ln_k_ = std::log(evaluer.parameters().K);
+	evalue_table_ = EvalueTable(evaluer.parameters(), scale_, config.evalue_table_error);
 	init_background_scores();
 }
 
@@ -214,11 +216,43 @@ std::vector<const T*> Scores<T>::pointers() const {
 
 template struct Scores<int>;
 
-double ScoreMatrix::evalue(int raw_score, unsigned query_len, unsigned subject_len) const
+double ScoreMatrix::evalue_exact(int raw_score, unsigned query_len, unsigned subject_len) const
 {
 	return evaluer.evalue((double)raw_score / scale_, query_len, subject_len) * (double)db_letters_ / (double)subject_len;
 }
 
+bool ScoreMatrix::near_cutoff(double evalue) const {
+	// Decisions at the reporting threshold must not depend on the interpolation error.
+	return std::abs(evalue - config.max_evalue) <= 4.0 * evalue_table_.max_rel_error() * config.max_evalue;
+}
+
+double ScoreMatrix::evalue(int raw_score, unsigned query_len, unsigned subject_len) const
+{
+	if (evalue_table_.enabled()) {
+		const double e = evalue_table_.evalue(raw_score, query_len, subject_len);
+		if (e >= 0.0) {
+			const double r = e * db_letters_ / (double)subject_len;
+			if (!near_cutoff(r))
+				return r;
+		}
+	}
+	return evalue_exact(raw_score, query_len, subject_len);
+}
+
+void ScoreMatrix::evalue(const int* raw_score, unsigned query_len, const unsigned* subject_len, double* out, int64_t n) const
+{
+	if (!evalue_table_.enabled()) {
+		for (int64_t i = 0; i < n; ++i)
+			out[i] = evalue_exact(raw_score[i], query_len, subject_len[i]);
+		return;
+	}
+	evalue_table_.evalue(raw_score, query_len, subject_len, out, n);
+	for (int64_t i = 0; i < n; ++i) {
+		const double r = out[i] * db_letters_ / (double)subject_len[i];
+		out[i] = out[i] < 0.0 || near_cutoff(r) ? evalue_exact(raw_score[i], query_len, subject_len[i]) : r;
+	}
+}
+
 double ScoreMatrix::evalue_norm(int raw_score, unsigned query_len, unsigned subject_len) const
 {
 	return evaluer.evalue((double)raw_score / scale_, query_len, subject_len) * (double)1e9 / (double)subject_len;
@@ -227,7 +261,8 @@ double ScoreMatrix::evalue_norm(int raw_score, unsigned query_len, unsigned subj
 double ScoreMatrix::bitscore_corrected(int raw_score, unsigned query_len, unsigned subject_len) const
 {
 	//const double area = evaluer.area(raw_score, query_len, subject_len);
-	const double log_area = evaluer.log_area(raw_score, query_len, subject_len);
+	const double area = evalue_table_.enabled() && scale_ == 1.0 ? evalue_table_.area(raw_score, query_len, subject_len) : -1.0;
+	const double log_area = area > 0.0 ? log(area) : evaluer.log_area(raw_score, query_len, subject_len);
 	return (evaluer.parameters().lambda * raw_score - log(evaluer.parameters().K) - log_area) / log(2.0);
 }
 
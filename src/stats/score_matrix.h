@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "basic/value.h"
 #include "alp/sls_alignment_evaluer.hpp"
 #include "stats/standard_matrix.h"
+#include "stats/evalue_table.h"
 
 const double LN_2 = 0.69314718055994530941723212145818;
 
@@ -134,6 +135,7 @@ struct ScoreMatrix
 	{ return (int)ceil(rawscore(bitscore, double ())); }
 
 	double evalue(int raw_score, unsigned query_len, unsigned subject_len) const;
+	void evalue(const int* raw_score, unsigned query_len, const unsigned* subject_len, double* out, int64_t n) const;
 	double evalue_norm(int raw_score, unsigned query_len, unsigned subject_len) const;
 	double bitscore_corrected(int raw_score, unsigned query_len, unsigned subject_len) const;
 
@@ -227,6 +229,8 @@ struct ScoreMatrix
 private:
 
 	void init_background_scores();
+	double evalue_exact(int raw_score, unsigned query_len, unsigned subject_len) const;
+	bool near_cutoff(double evalue) const;
 
 	const Stats::StandardMatrix* standard_matrix_;
 	const int8_t* score_array_;
@@ -245,6 +249,7 @@ private:
 	Scores<int16_t> matrix16_;
 	std::array<double, TRUE_AA> background_scores_;
 	Sls::AlignmentEvaluer evaluer;
+	EvalueTable evalue_table_;
 
 };
 
@@ -17,9 +17,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ****/
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <functional>
 #include <iostream>
 #include <stdexcept>
+#include <vector>
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include "basic/config.h"
 #include "cluster/multinode/len_sort.h"
+#include "util/parallel/atomic.h"
+#include "util/parallel/coordinator.h"
 
 int run_queue_stress_test();
 int run_hit_buffer_stress_test();
@@ -43,8 +52,66 @@ static void len_sort_block_limits() {
 	require(!can_add_to_len_sorted_block(0, 0, 800, 1000, 10, 1000), "Expected an unrepresentable sequence to fail.");
 }
 
+// Worker processes share a counter, a queue and a completion count through a coordinator process.
+static void coordinator_processes() {
+#ifndef _WIN32
+	const int WORKERS = 4, ITEMS = 100;
+	struct NoJob {
+		void register_sync_file(const std::string&) {}
+	} job;
+	const std::string prefix = "diamond_test_" + std::to_string(getpid()), address = "unix:" + prefix + ".sock";
+	const std::string saved = config.coordinator;
+	config.coordinator = address;
+	std::vector<pid_t> children;
+	auto spawn = [&children](const std::function<void()>& f) {
+		const pid_t pid = fork();
+		if (pid < 0)
+			throw std::runtime_error("fork failed");
+		if (pid == 0) {
+			int status = 0;
+			try {
+				f();
+			}
+			catch (std::exception&) {
+				status = 1;
+			}
+			_exit(status);
+		}
+		children.push_back(pid);
+	};
+	spawn([&]() { Coordinator::serve(address); });
+	for (int i = 0; i < WORKERS; ++i)
+		spawn([&]() {
+			Atomic counter(prefix + "_counter", job), finished(prefix + "_finished", job);
+			FileStack queue(prefix + "_queue", FileStack::Backend::SYNC);
+			for (int j = 0; j < ITEMS; ++j)
+				queue.push(counter.fetch_add());
+			finished.fetch_add();
+		});
+	Atomic counter(prefix + "_counter", job), finished(prefix + "_finished", job);
+	finished.await(WORKERS);
+	FileStack queue(prefix + "_queue", FileStack::Backend::SYNC);
+	require(counter.get() == WORKERS * ITEMS, "Expected the coordinator counter to count all increments.");
+	require(queue.size() == WORKERS * ITEMS, "Expected the coordinator queue to hold all items.");
+	std::vector<bool> seen(WORKERS * ITEMS, false);
+	int64_t i;
+	while (queue.pop(i) >= 0) {
+		require(i < WORKERS * ITEMS && !seen[i], "Expected unique values from the coordinator counter.");
+		seen[i] = true;
+	}
+	Coordinator::shutdown();
+	for (pid_t pid : children) {
+		int status;
+		waitpid(pid, &status, 0);
+		require(WIFEXITED(status) && WEXITSTATUS(status) == 0, "Expected the coordinator test processes to succeed.");
+	}
+	config.coordinator = saved;
+#endif
+}
+
 int run() {
 	len_sort_block_limits();
+	coordinator_processes();
 	std::cerr << "Unit tests passed." << std::endl;
 	return 0;
 	//filestack();	
@@ -38,6 +38,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util/simd/dispatch.h"
 #include "dp/score_vector_int16.h"
 #include "search/hit_buffer.h"
+#include "search/stage2.h"
+#include "search/hamming/kernel.h"
+#include "search/seed_array/seed_array.h"
+#include "util/algo/hash_join.h"
+#include "masking/masking.h"
+#include "data/block/block.h"
+#include "benchmark.h"
 
 using std::vector;
 using std::endl;
@@ -605,8 +612,179 @@ void benchmark() {
 #endif
 }
 
+// Suite kernels
+
+static const int SWIPE_TARGETS = 32, BAND = 64, FINGERPRINTS = 1024;
+
+static void stage1(Suite& suite) {
+	const Data& data = suite.data;
+	const Loc len = (Loc)data.query.size();
+	Search::Container q(FINGERPRINTS), t(FINGERPRINTS);
+	for (int i = 0; i < FINGERPRINTS; ++i) {
+		const Loc pos = 16 + i % (len - 48);
+		FingerPrint::load(data.query.data() + pos, &q[i]);
+		FingerPrint::load(data.seqs[i % data.seqs.size()].data() + pos, &t[i]);
+	}
+	const unsigned id = Search::sensitivity_traits.at(Sensitivity::DEFAULT).min_identities;
+	HitField hits;
+	suite.measure("stage1_all_vs_all", "seed hits/s", (double)FINGERPRINTS * FINGERPRINTS, [&]() {
+		hits.init(FINGERPRINTS, FINGERPRINTS);
+		Search::DISPATCH_ARCH::all_vs_all(q.data(), FINGERPRINTS, t.data(), FINGERPRINTS, hits, id);
+	});
+}
+
+static void ungapped(Suite& suite) {
+	const Data& data = suite.data;
+	const Loc len = (Loc)data.query.size();
+	const int n = 16, window = std::min(config.ungapped_window, len & ~31);
+	vector<int> offsets;
+	for (int i = 0; i + round_up(window, 32) <= len; i += 16)
+		offsets.push_back(i);
+	int out[n];
+	suite.measure("ungapped_window", "cells/s", (double)offsets.size() * n * window, [&]() {
+		const Letter* subjects[n];
+		for (int i : offsets) {
+			for (int j = 0; j < n; ++j)
+				subjects[j] = data.homolog(j).data() + i;
+			DP::window_ungapped_best(data.query.data() + i, subjects, n, window, out);
+		}
+	});
+}
+
+#ifdef __AVX2__
+static void scan_diags(Suite& suite) {
+	const Data& data = suite.data;
+	const Sequence query(data.query);
+	const LongScoreProfile<int8_t> profile = DP::make_profile8(query, nullptr, 0);
+	int out[128];
+	double cells = 0.0;
+	for (int i = 0; i < SWIPE_TARGETS; ++i)
+		cells += 128.0 * data.homolog(i).size();
+	suite.measure("scan_diags128", "cells/s", cells, [&]() {
+		for (int i = 0; i < SWIPE_TARGETS; ++i) {
+			const Sequence target(data.homolog(i));
+			DP::scan_diags128(profile, target, -64, 0, target.length(), out);
+		}
+	});
+}
+#endif
+
+static void swipe(Suite& suite, const char* kernel, int bin, bool banded, HspValues v, bool unrelated) {
+	const Data& data = suite.data;
+	const Sequence query(data.query);
+	DP::Targets targets;
+	double cells = 0.0;
+	for (int i = 0; i < SWIPE_TARGETS; ++i) {
+		const Sequence target(unrelated ? data.unrelated(i) : data.homolog(i));
+		if (banded)
+			targets[bin].emplace_back(target, target.length(), -BAND / 2, BAND / 2, i, query.length());
+		else
+			targets[bin].emplace_back(target, target.length(), i);
+		cells += (double)(banded ? BAND : query.length()) * target.length();
+	}
+	Statistics stat;
+	DP::Params params{ query, "", Frame(0), query.length(), nullptr, banded ? DP::Flags::NONE : DP::Flags::FULL_MATRIX, false, 0, 0, v, stat, nullptr };
+	suite.measure(kernel, "cells/s", cells, [&]() {
+		const list<Hsp> out = ::DP::BandedSwipe::swipe(targets, params);
+	});
+}
+
+#if ARCH_ID == 2
+static void anchored(Suite& suite) {
+	const Data& data = suite.data;
+	const Sequence query(data.query);
+	Loc tlen = 0;
+	double cells = 0.0;
+	vector<DP::AnchoredSwipe::Target<int16_t>> targets;
+	for (int i = 0; i < 16; ++i) {
+		const Sequence target(data.homolog(i));
+		targets.emplace_back(target, -BAND / 2, BAND / 2, 0, query.length(), i, false);
+		tlen = std::max(tlen, target.length());
+		cells += (double)BAND * target.length();
+	}
+	const LongScoreProfile<int16_t> profile = DP::make_profile16(query, nullptr, query.length() + tlen + 32, &score_matrix);
+	const vector<const int16_t*> pointers = profile.pointers(0);
+	const DP::AnchoredSwipe::Options options{ pointers.data(), pointers.data() };
+	vector<DP::AnchoredSwipe::Target<int16_t>> work;
+	suite.measure("swipe_anchored_16", "cells/s", cells, [&]() {
+		work = targets;
+		DP::AnchoredSwipe::DISPATCH_ARCH::smith_waterman<ScoreVector<int16_t, 0>>(work.data(), (int64_t)work.size(), options);
+	});
+}
+#endif
+
+static void tantan(Suite& suite) {
+	const Data& data = suite.data;
+	double letters = 0.0;
+	for (const vector<Letter>& s : data.seqs)
+		letters += s.size();
+	suite.measure("tantan", "letters/s", letters, [&]() {
+		for (const vector<Letter>& s : data.seqs)
+			const Mask::Ranges r = Masking::get().intervals(s.data(), s.size(), MaskingAlgo::TANTAN);
+	});
+}
+
+static void seed_search(Suite& suite) {
+	using SA = SeedArray<PackedLoc>;
+	Block& query = *suite.data.query_block, & target = *suite.data.target_block;
+	const int bits = Search::seedp_bits(::shapes[0].weight_, 1, 1);
+	const SeedPartitionRange range(0, seedp_count(bits));
+	EnumCfg hst_cfg{ nullptr, 0, 1, SeedEncoding::SPACED_FACTOR, nullptr, false, false, 0.0, MaskingAlgo::NONE, 0, false, false, 0, nullptr };
+	const SeedHistogram query_hst(query, false, &no_filter, hst_cfg, bits), target_hst(target, false, &no_filter, hst_cfg, bits);
+	const EnumCfg query_cfg{ &query_hst.partition(), 0, 1, SeedEncoding::SPACED_FACTOR, nullptr, false, false, 0.0, MaskingAlgo::NONE, 0, false, false, 0, nullptr },
+		target_cfg{ &target_hst.partition(), 0, 1, SeedEncoding::SPACED_FACTOR, nullptr, false, false, 0.0, MaskingAlgo::NONE, 0, false, false, 0, nullptr };
+	char* query_buffer = SA::alloc_buffer(query_hst, 1, { 0, 1 }), * target_buffer = SA::alloc_buffer(target_hst, 1, { 0, 1 });
+	std::unique_ptr<SA> query_seeds, target_seeds;
+	auto build = [&]() {
+		query_seeds.reset(new SA(query, query_hst.get(0), range, bits, query_buffer, &no_filter, query_cfg));
+		target_seeds.reset(new SA(target, target_hst.get(0), range, bits, target_buffer, &no_filter, target_cfg));
+	};
+	build();
+	suite.measure("seed_array", "seeds/s", double(query_seeds->size() + target_seeds->size()), build);
+
+	vector<SA::Entry> query_entries(query_seeds->begin(0), query_seeds->begin(0) + query_seeds->size()),
+		target_entries(target_seeds->begin(0), target_seeds->begin(0) + target_seeds->size());
+	const SeedPartition partitions = (SeedPartition)seedp_count(bits);
+	suite.measure("hash_join", "seeds/s", double(query_entries.size() + target_entries.size()), [&]() {
+		std::copy(query_entries.begin(), query_entries.end(), query_seeds->begin(0));
+		std::copy(target_entries.begin(), target_entries.end(), target_seeds->begin(0));
+		for (SeedPartition p = 0; p < partitions; ++p)
+			hash_join(Relation<SA::Entry>(query_seeds->begin(p), query_seeds->size(p)), Relation<SA::Entry>(target_seeds->begin(p), target_seeds->size(p)), query_seeds->key_bits);
+	});
+	query_seeds.reset();
+	target_seeds.reset();
+	Util::Memory::huge_free(query_buffer);
+	Util::Memory::huge_free(target_buffer);
+}
+
+void kernels(Suite& suite) {
+	stage1(suite);
+	ungapped(suite);
+#ifdef __AVX2__
+	scan_diags(suite);
+#endif
+#if defined(__SSE4_1__) | defined(__ARM_NEON)
+	swipe(suite, "swipe_full_8", 0, false, HspValues::NONE, true);
+	swipe(suite, "swipe_banded_8", 0, true, HspValues::NONE, true);
+#endif
+#if defined(__SSE2__) | defined(__ARM_NEON)
+	swipe(suite, "swipe_full_16", 1, false, HspValues::NONE, false);
+	swipe(suite, "swipe_banded_16", 1, true, HspValues::NONE, false);
+	swipe(suite, "swipe_banded_16_traceback", 1, true, HspValues::TRANSCRIPT, false);
+#endif
+	swipe(suite, "swipe_full_32", 2, false, HspValues::NONE, false);
+	swipe(suite, "swipe_banded_32", 2, true, HspValues::NONE, false);
+#if ARCH_ID == 2
+	anchored(suite);
+#endif
+	tantan(suite);
+	seed_search(suite);
+}
+
 }
 
 DISPATCH_0V(benchmark)
+DISPATCH_1V(kernels, Suite&, suite)
+
 
 }
\ No newline at end of file
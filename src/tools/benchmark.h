@@ -0,0 +1,74 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "basic/value.h"
+#include "util/system/perf_counters.h"
+
+struct Block;
+
+namespace Benchmark {
+
+// Synthetic protein families for the benchmark suite. Each family consists of mutated copies of a random root sequence,
+// where the substituted positions are drawn from the background distribution. The query is the root of family 0, so
+// that family 0 holds its homologs and the other families unrelated sequences.
+struct Data {
+	Data(Loc length, double identity, uint64_t seed);
+	~Data();
+	static constexpr int FAMILIES = 32, MEMBERS = 32;
+	std::vector<Letter> query;
+	std::vector<std::vector<Letter>> seqs;
+	// The even and odd members of all families as query and target blocks for the seed search kernels.
+	std::unique_ptr<Block> query_block, target_block;
+	const std::vector<Letter>& homolog(int i) const {
+		return seqs[i];
+	}
+	const std::vector<Letter>& unrelated(int i) const {
+		return seqs[MEMBERS + i];
+	}
+};
+
+struct Result {
+	std::string kernel, arch, unit;
+	double rate, ns, spread;
+	uint64_t iterations;
+	// Hardware performance counts per iteration, see Util::Perf::available().
+	std::array<double, Util::Perf::COUNT> counters;
+};
+
+struct Suite {
+	Suite();
+	// Times f after a warm-up run. The iterations per repetition are calibrated to a minimum run time, the reported
+	// rate is the median over the repetitions in units of work per second.
+	void measure(const std::string& kernel, const char* unit, double work, const std::function<void()>& f);
+	const Data data;
+	std::string arch;
+	std::vector<Result> results;
+};
+
+// Runs the kernels compiled for the current architecture, see SIMD::set_arch().
+void kernels(Suite& suite);
+
+}
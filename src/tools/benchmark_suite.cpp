@@ -0,0 +1,292 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include "benchmark.h"
+#include "basic/config.h"
+#include "basic/const.h"
+#include "basic/shape_config.h"
+#include "data/block/block.h"
+#include "dp/dp.h"
+#include "output/output_format.h"
+#include "search/hit_buffer.h"
+#include "search/search.h"
+#include "stats/standard_matrix.h"
+#include "util/log_stream.h"
+#include "util/parallel/simple_thread_pool.h"
+#include "util/simd.h"
+
+using std::vector;
+using std::string;
+using std::map;
+using std::endl;
+using std::runtime_error;
+using std::chrono::high_resolution_clock;
+using std::chrono::duration;
+
+namespace Benchmark {
+
+void benchmark();
+
+// Minimum run time of one timed repetition in seconds.
+static const double MIN_TIME = 0.1;
+
+Data::Data(Loc length, double identity, uint64_t seed):
+	query_block(new Block),
+	target_block(new Block)
+{
+	if (length < 64)
+		throw runtime_error("--bench-length has to be at least 64.");
+	if (identity < 0.0 || identity > 100.0)
+		throw runtime_error("--bench-identity has to be in the range 0-100.");
+	std::mt19937_64 rng(seed);
+	const auto& freqs = Stats::blosum62.background_freqs;
+	std::discrete_distribution<int> letter(freqs.begin(), freqs.end());
+	std::bernoulli_distribution conserved(identity / 100.0);
+	for (int i = 0; i < FAMILIES; ++i) {
+		vector<Letter> root(length);
+		for (Letter& l : root)
+			l = (Letter)letter(rng);
+		for (int j = 0; j < MEMBERS; ++j) {
+			vector<Letter> s(root);
+			for (Letter& l : s)
+				if (!conserved(rng))
+					l = (Letter)letter(rng);
+			seqs.push_back(std::move(s));
+		}
+		if (i == 0)
+			query = std::move(root);
+	}
+	for (size_t i = 0; i < seqs.size(); ++i)
+		(i % 2 ? target_block : query_block)->push_back(Sequence(seqs[i]), nullptr, nullptr, (OId)i, SequenceType::amino_acid, 1);
+}
+
+Data::~Data() {}
+
+Suite::Suite():
+	data(config.bench_length, config.bench_identity, config.bench_seed)
+{
+	if (config.bench_reps < 1)
+		throw runtime_error("--bench-reps has to be at least 1.");
+	::shapes = ShapeConfig(Search::shape_codes.at(Sensitivity::DEFAULT), 1);
+	if (!Util::Perf::enabled)
+		Util::Perf::open();
+}
+
+static double elapsed(const std::function<void()>& f, uint64_t n) {
+	const high_resolution_clock::time_point t = high_resolution_clock::now();
+	for (uint64_t i = 0; i < n; ++i)
+		f();
+	return duration<double>(high_resolution_clock::now() - t).count();
+}
+
+void Suite::measure(const string& kernel, const char* unit, double work, const std::function<void()>& f) {
+	f();
+	uint64_t n = 1;
+	double t;
+	while ((t = elapsed(f, n)) < MIN_TIME)
+		n = t > 0.0 ? std::max(n + 1, (uint64_t)(n * MIN_TIME * 1.2 / t)) : n * 10;
+	vector<double> ns;
+	const Util::Perf::Values begin = Util::Perf::read();
+	for (int i = 0; i < config.bench_reps; ++i)
+		ns.push_back(elapsed(f, n) * 1e9 / n);
+	const Util::Perf::Values end = Util::Perf::read();
+	std::sort(ns.begin(), ns.end());
+	const double median = ns[ns.size() / 2];
+	Result r{ kernel, arch, unit, work / median * 1e9, median, (ns.back() - ns.front()) / median, n, {} };
+	for (int i = 0; i < Util::Perf::COUNT; ++i)
+		r.counters[i] = end[i] > begin[i] ? (double)(end[i] - begin[i]) / (n * config.bench_reps) : 0.0;
+	results.push_back(r);
+	*message_stream << std::left << std::setw(28) << kernel << std::setw(10) << arch << std::right << std::setw(12) << std::setprecision(4)
+		<< r.rate << ' ' << unit << " (spread " << std::setprecision(2) << r.spread * 100 << "%)" << endl;
+}
+
+static void hit_buffer(Suite& suite) {
+	const uint32_t QUERIES = 4096, HITS_PER_QUERY = 256, BINS = 16, TARGET_LEN = 1 << 20;
+	vector<uint32_t> key_partition;
+	for (uint32_t i = 1; i <= BINS; ++i)
+		key_partition.push_back(i * QUERIES / BINS);
+	SimpleThreadPool pool;
+	std::mt19937_64 rng(config.bench_seed);
+	vector<uint32_t> subjects(HITS_PER_QUERY);
+	for (uint32_t& s : subjects)
+		s = (uint32_t)(rng() % TARGET_LEN);
+	suite.measure("hit_buffer_io", "hits/s", (double)QUERIES * HITS_PER_QUERY, [&]() {
+		Search::HitBuffer buf(key_partition, config.tmpdir, false, 1, 1, QUERIES, TARGET_LEN, pool);
+		{
+			Search::HitBuffer::Writer writer(buf, 0);
+			for (uint32_t q = 0; q < QUERIES; ++q) {
+				writer.new_query(q, (Loc)(q % 64));
+				for (uint32_t i = 0; i < HITS_PER_QUERY; ++i)
+					writer.write(q, PackedLoc(subjects[i] ^ q), (uint16_t)(i + 1));
+			}
+		}
+		buf.finish_writing();
+		buf.alloc_buffer();
+		size_t hits = 0;
+		while (buf.load(std::numeric_limits<size_t>::max()))
+			hits += std::get<1>(buf.retrieve());
+		buf.free_buffer();
+		if (hits != (size_t)QUERIES * HITS_PER_QUERY)
+			throw runtime_error("Hit buffer benchmark lost hits.");
+	});
+}
+
+static void output(Suite& suite) {
+	const Data& data = suite.data;
+	const Sequence query(data.query);
+	DP::Targets targets;
+	for (int i = 0; i < Data::MEMBERS; ++i)
+		targets[1].emplace_back(Sequence(data.homolog(i)), (Loc)data.homolog(i).size(), -32, 32, i, query.length());
+	Statistics stat;
+	DP::Params params{ query, "", Frame(0), query.length(), nullptr, DP::Flags::NONE, false, 0, 0, HspValues::TRANSCRIPT, stat, nullptr };
+	const std::list<Hsp> hsps = DP::BandedSwipe::swipe(targets, params);
+	TabularFormat format;
+	TextBuffer buf;
+	const TranslatedSequence query_seq(query);
+	Output::Info info{ SeqInfo{ 0, 0, "query", nullptr, query.length(), query, Sequence() }, false, nullptr, buf, Util::Seq::AccessionParsing(), {}, {} };
+	suite.measure("output_tabular", "records/s", (double)hsps.size(), [&]() {
+		for (const Hsp& hsp : hsps) {
+			const vector<Letter>& target = data.homolog(hsp.swipe_target);
+			format.print_match(HspContext(hsp, 0, 0, query_seq, "query", hsp.swipe_target, (unsigned)target.size(), "target", 1, 1, Sequence(target)), info);
+		}
+		buf.clear();
+	});
+}
+
+// JSON key of a performance counter, e.g. "llc_misses".
+static string counter_key(int counter) {
+	string s = Util::Perf::name(counter);
+	for (char& c : s)
+		c = c == ' ' ? '_' : (char)std::tolower(c);
+	return s;
+}
+
+static void write(const Suite& suite, std::ostream& out) {
+	out << std::setprecision(6) << "{" << endl
+		<< "\"version\": \"" << Const::version_string << "\"," << endl
+		<< "\"cpu\": \"" << SIMD::features() << "\"," << endl
+		<< "\"length\": " << config.bench_length << "," << endl
+		<< "\"identity\": " << config.bench_identity << "," << endl
+		<< "\"seed\": " << config.bench_seed << "," << endl
+		<< "\"reps\": " << config.bench_reps << "," << endl
+		<< "\"results\": [" << endl;
+	for (size_t i = 0; i < suite.results.size(); ++i) {
+		const Result& r = suite.results[i];
+		out << "{\"kernel\": \"" << r.kernel << "\", \"arch\": \"" << r.arch << "\", \"unit\": \"" << r.unit << "\", \"rate\": " << r.rate
+			<< ", \"ns\": " << r.ns << ", \"spread\": " << r.spread << ", \"iterations\": " << r.iterations;
+		for (int j = 0; j < Util::Perf::COUNT; ++j)
+			if (Util::Perf::available(j))
+				out << ", \"" << counter_key(j) << "\": " << r.counters[j];
+		out << "}" << (i + 1 < suite.results.size() ? "," : "") << endl;
+	}
+	out << "]" << endl << "}" << endl;
+}
+
+static string field(const string& line, const string& key) {
+	const string k = "\"" + key + "\": ";
+	size_t i = line.find(k);
+	if (i == string::npos)
+		throw runtime_error("Missing field in benchmark result: " + key);
+	i += k.length();
+	if (line[i] == '"')
+		return line.substr(i + 1, line.find('"', i + 1) - i - 1);
+	return line.substr(i, line.find_first_of(",}", i) - i);
+}
+
+// Reads the rates of a result file written by write(), keyed by kernel and architecture.
+static map<string, double> read(const string& file_name) {
+	std::ifstream in(file_name);
+	if (!in)
+		throw runtime_error("Error opening file " + file_name);
+	map<string, double> rates;
+	string line;
+	while (std::getline(in, line))
+		if (line.find("\"kernel\": ") != string::npos)
+			rates[field(line, "kernel") + '/' + field(line, "arch")] = std::stod(field(line, "rate"));
+	if (rates.empty())
+		throw runtime_error("No benchmark results in file " + file_name);
+	return rates;
+}
+
+static void compare() {
+	if (config.bench_compare.size() != 2)
+		throw runtime_error("--bench-compare requires two files (baseline, candidate).");
+	const map<string, double> baseline = read(config.bench_compare[0]), candidate = read(config.bench_compare[1]);
+	int regressions = 0;
+	for (const auto& i : baseline) {
+		const auto j = candidate.find(i.first);
+		std::cout << std::left << std::setw(38) << i.first << std::right;
+		if (j == candidate.end()) {
+			std::cout << "missing in candidate" << endl;
+			continue;
+		}
+		const double change = j->second / i.second - 1.0;
+		std::cout << std::setprecision(4) << std::setw(12) << i.second << std::setw(12) << j->second << std::setw(8) << std::fixed << std::setprecision(1)
+			<< change * 100 << '%' << std::defaultfloat;
+		if (change < -config.bench_tolerance) {
+			std::cout << "  REGRESSION";
+			++regressions;
+		}
+		std::cout << endl;
+	}
+	for (const auto& j : candidate)
+		if (baseline.find(j.first) == baseline.end())
+			std::cout << std::left << std::setw(38) << j.first << std::right << "missing in baseline" << endl;
+	if (regressions > 0)
+		throw runtime_error(std::to_string(regressions) + " kernel(s) regressed beyond the tolerance of --bench-tolerance.");
+}
+
+void run() {
+	if (!config.bench_compare.empty()) {
+		compare();
+		return;
+	}
+	if (!config.type.empty()) {
+		benchmark();
+		return;
+	}
+	Suite suite;
+	for (SIMD::Arch a : SIMD::archs()) {
+		SIMD::set_arch(a);
+		suite.arch = SIMD::arch_name(a);
+		kernels(suite);
+	}
+	SIMD::set_arch(SIMD::Arch::None);
+	suite.arch = "none";
+	hit_buffer(suite);
+	output(suite);
+	if (config.output_file.empty())
+		write(suite, std::cout);
+	else {
+		std::ofstream out(config.output_file);
+		write(suite, out);
+		if (!out)
+			throw runtime_error("Error writing file " + config.output_file);
+	}
+}
+
+}
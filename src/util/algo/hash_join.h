@@ -26,6 +26,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "../data_structures/hash_table.h"
 #include "../data_structures/double_array.h"
 #include "../math/integer.h"
+#include "../memory/huge_pages.h"
+#include "../memory/governor.h"
 
 static inline uint32_t checked_double_array_count(size_t n) {
 	if (n > std::numeric_limits<uint32_t>::max())
@@ -123,7 +125,7 @@ void table_join(
 	using Key = typename T::Key;
 	const Key keys = (Key)1 << (total_bits - shift);
 	ExtractBits<Key> key(keys, shift);
-	RelPtr *table = (RelPtr*)calloc(keys, sizeof(RelPtr));
+	RelPtr *table = (RelPtr*)Util::Memory::huge_alloc(keys * sizeof(RelPtr), true);
 	RelPtr *p;
 
 	for (T *i = R.data; i < R.end(); ++i)
@@ -168,7 +170,7 @@ void table_join(
 		p->s += sizeof(typename T::Value);
 	}
 
-	free(table);
+	Util::Memory::huge_free(table, keys * sizeof(RelPtr));
 }
 
 template<typename T>
@@ -215,11 +217,12 @@ std::pair<DoubleArray<typename T::Value>, DoubleArray<typename T::Value>> hash_j
 	const bool swap = config.hash_join_swap && R.n > S.n;
 	if (swap)
 		std::swap(R, S);
-	T *buf_r = (T*)malloc(sizeof(T) * R.n), *buf_s = (T*)malloc(sizeof(T) * S.n);
+	const Util::Memory::Reservation mem(Util::Memory::Pool::SEED_JOIN, int64_t(sizeof(T) * (R.n + S.n)));
+	T *buf_r = (T*)Util::Memory::huge_alloc(sizeof(T) * R.n), *buf_s = (T*)Util::Memory::huge_alloc(sizeof(T) * S.n);
 	DoubleArray<typename T::Value> out_r((void*)R.data), out_s((void*)S.data);
 	hash_join(R, S, buf_r, buf_s, out_r, out_s, total_bits);
-	free(buf_r);
-	free(buf_s);
+	Util::Memory::huge_free(buf_r, sizeof(T) * R.n);
+	Util::Memory::huge_free(buf_s, sizeof(T) * S.n);
 	if (swap)
 		std::swap(out_r, out_s);
 	return { out_r, out_s };
@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
 #include <stdexcept>
+#include "../memory/huge_pages.h"
 
 struct Modulo {
 	size_t operator()(size_t offset, size_t size) const {
@@ -48,7 +49,7 @@ struct HashTable : private HashFunction
 
 	HashTable(size_t size, const HashFunction &hash) :
 		HashFunction(hash),
-		table((Entry*)calloc(size, sizeof(Entry))),
+		table((Entry*)Util::Memory::huge_alloc(size * sizeof(Entry), true)),
 		size_(size),
 		destroy_(true)
 	{
@@ -64,7 +65,7 @@ struct HashTable : private HashFunction
 	~HashTable()
 	{
 		if (destroy_)
-			free(table);
+			Util::Memory::huge_free(table, size_ * sizeof(Entry));
 	}
 
 	Value& operator[](Key key)
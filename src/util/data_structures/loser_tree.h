@@ -0,0 +1,91 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2012-2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <stddef.h>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Tournament tree of losers for k-way merging. Selecting the minimum key is O(1), replacing the key
+// of the current winner is O(log k). Ties are broken by the lower source index.
+template<typename Key>
+struct LoserTree
+{
+	LoserTree(const std::vector<Key>& keys):
+		keys_(keys),
+		tree_(std::max(keys.size(), (size_t)1), NONE)
+	{
+		for (size_t i = 0; i < keys_.size(); ++i)
+			insert(i);
+	}
+
+	size_t min_index() const
+	{
+		return tree_[0];
+	}
+
+	const Key& min() const
+	{
+		return keys_[tree_[0]];
+	}
+
+	// Sets a new key for the current winner and replays its path to the root.
+	void replace_min(const Key& key)
+	{
+		size_t winner = tree_[0];
+		keys_[winner] = key;
+		for (size_t node = (winner + keys_.size()) / 2; node > 0; node /= 2)
+			if (less(tree_[node], winner))
+				std::swap(tree_[node], winner);
+		tree_[0] = winner;
+	}
+
+	size_t size() const
+	{
+		return keys_.size();
+	}
+
+private:
+
+	static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
+	bool less(size_t a, size_t b) const
+	{
+		return keys_[a] < keys_[b] || (!(keys_[b] < keys_[a]) && a < b);
+	}
+
+	void insert(size_t leaf)
+	{
+		size_t winner = leaf;
+		for (size_t node = (leaf + keys_.size()) / 2; node > 0; node /= 2) {
+			if (tree_[node] == NONE) {
+				tree_[node] = winner;
+				return;
+			}
+			if (less(tree_[node], winner))
+				std::swap(tree_[node], winner);
+		}
+		tree_[0] = winner;
+	}
+
+	std::vector<Key> keys_;
+	std::vector<size_t> tree_;
+
+};
@@ -18,8 +18,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #pragma once
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
 #include <map>
+#include <vector>
+#include "../memory/governor.h"
 
 template<typename T, typename F>
 struct ReorderQueue
@@ -50,21 +54,27 @@ struct ReorderQueue
 
 	void push(size_t n, T value)
 	{
-		mtx_.lock();
+		std::unique_lock<std::mutex> lock(mtx_);
 		//cout << "n=" << n << " next=" << next_ << endl;
+		if (n != next_ && value && Util::Memory::available(Util::Memory::Pool::OUTPUT) < (int64_t)value->alloc_size()) {
+			// Backpressure: give the producer of the next buffer time to catch up. The wait is bounded since the producers
+			// may depend on each other through the task sets of the thread pool.
+			flushed_.wait_for(lock, std::chrono::seconds(1), [&] {
+				return n == next_ || Util::Memory::available(Util::Memory::Pool::OUTPUT) >= (int64_t)value->alloc_size(); });
+		}
 		if (n != next_) {
 			backlog_[n] = value;
 			size_ += value ? value->alloc_size() : 0;
 			max_size_ = std::max(max_size_, size_);
-			mtx_.unlock();
+			memory_.resize(size_);
 		}
 		else
-			flush(value);
+			flush(value, lock);
 	}
 
 private:
 
-	void flush(T value)
+	void flush(T value, std::unique_lock<std::mutex>& lock)
 	{
 		size_t n = next_ + 1;
 		std::vector<T> out;
@@ -76,7 +86,7 @@ private:
 				backlog_.erase(i);
 				++n;
 			}
-			mtx_.unlock();
+			lock.unlock();
 			size_t size = 0;
 			for (typename std::vector<T>::iterator j = out.begin(); j < out.end(); ++j) {
 				if (*j) {
@@ -87,16 +97,20 @@ private:
 				}
 			}
 			out.clear();
-			mtx_.lock();
+			lock.lock();
 			size_ -= size;
+			memory_.resize(size_);
 		} while ((i = backlog_.begin()) != backlog_.end() && i->first == n);
 		next_ = n;
-		mtx_.unlock();
+		lock.unlock();
+		flushed_.notify_all();
 	}
 
 	std::mutex mtx_;
+	std::condition_variable flushed_;
 	F& f_;
 	std::map<size_t, T> backlog_;
 	size_t begin_, next_, size_, max_size_;
+	Util::Memory::Reservation memory_{ Util::Memory::Pool::OUTPUT, 0 };
 
 };
\ No newline at end of file
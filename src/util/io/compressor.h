@@ -18,11 +18,21 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #pragma once
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
 #include "decompressor.h"
+#include "../memory/governor.h"
 
 struct CompressorX {
 	virtual size_t fwrite(const void* buffer, size_t size, size_t count, FILE* stream) = 0;	
 	virtual void close(FILE* stream) {}
+	virtual void flush(FILE* stream) {
+		std::fflush(stream);
+	}
 	virtual CompressionLib lib() const = 0;
 	virtual ~CompressorX() = default;
 };
@@ -40,6 +50,7 @@ struct ZlibCompressor : CompressorX {
 	ZlibCompressor();
 	size_t fwrite(const void* buffer, size_t size, size_t count, FILE* stream) override;
 	void close(FILE* stream) override;
+	void flush(FILE* stream) override;
 	virtual CompressionLib lib() const override {
 		return CompressionLib::ZLIB;
 	}
@@ -59,6 +70,7 @@ struct ZstdCompressor : CompressorX {
 	ZstdCompressor();
 	size_t fwrite(const void* buffer, size_t size, size_t count, FILE* stream) override;
 	void close(FILE* stream) override;
+	void flush(FILE* stream) override;
 	virtual CompressionLib lib() const override {
 		return CompressionLib::ZSTD;
 	}
@@ -72,3 +84,46 @@ private:
 	bool closed_ = false;
 };
 #endif
+
+// Compresses blocks of the input on worker threads into independent gzip members or zstd frames, which are written
+// to the stream in input order. The concatenated members/frames are valid for standard decompressors. With bgzf,
+// the gzip members follow the BGZF format (blocks of at most 64 KB with the block size in a header field,
+// terminated by the BGZF EOF block), which allows tools like bgzip and tabix to address the output by block.
+struct ParallelCompressor : CompressorX {
+	ParallelCompressor(CompressionLib lib, int threads, bool bgzf = false);
+	size_t fwrite(const void* buffer, size_t size, size_t count, FILE* stream) override;
+	void close(FILE* stream) override;
+	void flush(FILE* stream) override;
+	virtual CompressionLib lib() const override {
+		return lib_;
+	}
+	~ParallelCompressor();
+private:
+	struct Block {
+		std::vector<char> in;
+		std::vector<unsigned char> out;
+		bool done = false;
+		std::exception_ptr error;
+	};
+	void compress(Block& block) const;
+	void submit();
+	void write_front();
+	void worker();
+	void stop();
+	static const size_t chunk_size = 1llu << 20, bgzf_chunk_size = 0xff00;
+	const CompressionLib lib_;
+	const int threads_;
+	const bool bgzf_;
+	const size_t block_size_;
+	std::vector<char> buf_;
+	// Blocks in output order, and the blocks not yet taken by a worker.
+	std::deque<std::unique_ptr<Block>> pending_;
+	std::deque<Block*> queue_;
+	std::vector<std::thread> workers_;
+	std::mutex mtx_;
+	std::condition_variable work_cv_, done_cv_;
+	FILE* stream_ = nullptr;
+	uint64_t blocks_written_ = 0;
+	bool stop_ = false, closed_ = false;
+	Util::Memory::Reservation memory_{ Util::Memory::Pool::COMPRESSION, 0 };
+};
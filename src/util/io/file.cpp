@@ -23,6 +23,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <fcntl.h>
 #endif
 #include <string.h> // strerror
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 #include "file.h"
 #include "temp_file.h"
 #include "util/data_structures/mem_buffer.h"
@@ -44,12 +48,28 @@ static CompressionLib detect_compressor(const char* b) {
 	return CompressionLib::NONE;
 }
 
-File::File(Temporary):
+File::File(Temporary t):
 	line_buf_((char*)malloc(1024)),
 	line_buf_size_(1024),
 	decompressor_(new PassThrough),
 	compressor_(new PassThroughCompressor)
-{	
+{
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+	if (t.in_memory) {
+		const int fd = memfd_create("diamond-tmp", MFD_CLOEXEC);
+		if (fd >= 0 && (file_ = fdopen(fd, "w+b")) != nullptr) {
+			if (setvbuf(file_, nullptr, _IOFBF, config.file_buffer_size) != 0)
+				throw runtime_error("Error setting buffer size for in-memory temporary file. " + string(strerror(errno)));
+			unlinked_ = true;
+			file_name_ = "memfd:diamond-tmp";
+			auto_delete_ = true;
+			seekable_ = true;
+			return;
+		}
+		if (fd >= 0)
+			::close(fd);
+	}
+#endif
 	TempFileData d = TempFile::init(true);
 #ifdef _MSC_VER
 	file_ = fopen(d.name.c_str(), "w+b");
@@ -123,18 +143,22 @@ File::File(const string& name, const char* mode, Flags flags, CompressionLib com
 		}
 	}
 	else if (strcmp(mode, "wb") == 0 && compression != CompressionLib::NONE) {
-		switch (compression) {
-		case CompressionLib::ZLIB:
-			compressor_.reset(new ZlibCompressor);
-			break;
-		case CompressionLib::ZSTD:
+		const bool bgzf = compression == CompressionLib::ZLIB && config.compression == "bgzf";
+		if (config.threads_ > 1 || bgzf)
+			compressor_.reset(new ParallelCompressor(compression, config.threads_, bgzf));
+		else
+			switch (compression) {
+			case CompressionLib::ZLIB:
+				compressor_.reset(new ZlibCompressor);
+				break;
+			case CompressionLib::ZSTD:
 #ifdef WITH_ZSTD
-			compressor_.reset(new ZstdCompressor);
+				compressor_.reset(new ZstdCompressor);
 #endif
-			break;
-		default:
-			;
-		}
+				break;
+			default:
+				;
+			}
 	}
 }
 
@@ -196,6 +220,10 @@ void File::write_c_str(const char* s) {
 	write(s, strlen(s) + 1);
 }
 
+void File::flush() {
+	compressor_->flush(file_);
+}
+
 void File::seek(int64_t p, int origin)
 {
 	if(decompressor_ && decompressor_->lib() != CompressionLib::NONE && (p != 0 || origin != SEEK_SET))
@@ -33,13 +33,16 @@ const size_t MEGABYTES = 1 << 20;
 const size_t GIGABYTES = 1 << 30;
 const size_t KILOBYTES = 1 << 10;
 
-struct Temporary {};
+struct Temporary {
+	// Back the file by anonymous memory instead of the temporary directory where supported.
+	bool in_memory = false;
+};
 
 struct File {
 
 	enum struct Flags : int { DETECT_COMPRESSION = 1, TREAT_BLANK_AS_STDIN = 2, TREAT_BLANK_AS_STDOUT = 4, NONE = 0 };
 
-	File(Temporary);
+	File(Temporary t);
 	File(const std::string& name, const char* mode, Flags flags = Flags::NONE, CompressionLib compression = CompressionLib::NONE);
 	File(const File&) = delete;
 	File& operator= (const File&) = delete;
@@ -72,6 +75,13 @@ struct File {
 		write(&x, sizeof(T));
 	}
 	void write_c_str(const char* s);
+	void flush();
+	CompressorX* compressor() {
+		return compressor_.get();
+	}
+	void set_compressor(CompressorX* compressor) {
+		compressor_.reset(compressor);
+	}
 	
 	bool eof() const;
 	std::string peek(int64_t n);
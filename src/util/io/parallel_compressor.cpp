@@ -0,0 +1,247 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <string.h>
+#include <errno.h>
+#include <algorithm>
+#include <limits>
+#include "compressor.h"
+
+using std::vector;
+using std::runtime_error;
+using std::unique_lock;
+using std::mutex;
+
+static const unsigned char BGZF_EOF[28] = { 0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00,
+	0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+static const size_t BGZF_HEADER = 18, BGZF_FOOTER = 8;
+
+static void put_le(unsigned char* ptr, uint32_t x, int bytes) {
+	for (int i = 0; i < bytes; ++i)
+		ptr[i] = (unsigned char)(x >> (8 * i));
+}
+
+static void deflate_block(const vector<char>& in, vector<unsigned char>& out, size_t offset, int window_bits) {
+	z_stream strm;
+	strm.zalloc = Z_NULL;
+	strm.zfree = Z_NULL;
+	strm.opaque = Z_NULL;
+	if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		throw runtime_error("Error initializing zlib compressor (deflateInit2)");
+	out.resize(offset + deflateBound(&strm, (uLong)in.size()));
+	strm.next_in = (Bytef*)in.data();
+	strm.avail_in = (uInt)in.size();
+	strm.next_out = out.data() + offset;
+	strm.avail_out = (uInt)(out.size() - offset);
+	const int ret = deflate(&strm, Z_FINISH);
+	const size_t produced = strm.total_out;
+	deflateEnd(&strm);
+	if (ret != Z_STREAM_END)
+		throw runtime_error("Error during zlib compression (deflate)");
+	out.resize(offset + produced);
+}
+
+ParallelCompressor::ParallelCompressor(CompressionLib lib, int threads, bool bgzf):
+	lib_(lib),
+	threads_(std::max(threads, 1)),
+	bgzf_(bgzf),
+	block_size_(bgzf ? bgzf_chunk_size : chunk_size)
+{
+	if (lib != CompressionLib::ZLIB && lib != CompressionLib::ZSTD)
+		throw runtime_error("Unsupported library for parallel compression.");
+	if (bgzf && lib != CompressionLib::ZLIB)
+		throw runtime_error("BGZF requires zlib compression.");
+#ifndef WITH_ZSTD
+	if (lib == CompressionLib::ZSTD)
+		throw runtime_error("Executable was not compiled with support for ZStandard compression.");
+#endif
+	buf_.reserve(block_size_);
+}
+
+void ParallelCompressor::compress(Block& block) const {
+	if (lib_ == CompressionLib::ZSTD) {
+#ifdef WITH_ZSTD
+		block.out.resize(ZSTD_compressBound(block.in.size()));
+		const size_t n = ZSTD_compress(block.out.data(), block.out.size(), block.in.data(), block.in.size(), ZSTD_CLEVEL_DEFAULT);
+		if (ZSTD_isError(n))
+			throw runtime_error(std::string("Error during zstd compression: ") + ZSTD_getErrorName(n));
+		block.out.resize(n);
+#endif
+	}
+	else if (bgzf_) {
+		deflate_block(block.in, block.out, BGZF_HEADER, -15);
+		const size_t cdata = block.out.size() - BGZF_HEADER;
+		block.out.resize(block.out.size() + BGZF_FOOTER);
+		if (block.out.size() > 65536)
+			throw runtime_error("BGZF block size exceeded.");
+		unsigned char* h = block.out.data();
+		std::copy(BGZF_EOF, BGZF_EOF + 16, h);
+		put_le(h + 16, uint32_t(block.out.size() - 1), 2);
+		put_le(h + BGZF_HEADER + cdata, (uint32_t)crc32(crc32(0L, Z_NULL, 0), (const Bytef*)block.in.data(), (uInt)block.in.size()), 4);
+		put_le(h + BGZF_HEADER + cdata + 4, (uint32_t)block.in.size(), 4);
+	}
+	else
+		deflate_block(block.in, block.out, 0, 15 + 16);
+}
+
+void ParallelCompressor::worker() {
+	for (;;) {
+		Block* block;
+		{
+			unique_lock<mutex> lock(mtx_);
+			work_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+			if (queue_.empty())
+				return;
+			block = queue_.front();
+			queue_.pop_front();
+		}
+		try {
+			compress(*block);
+		}
+		catch (...) {
+			block->error = std::current_exception();
+		}
+		vector<char>().swap(block->in);
+		{
+			unique_lock<mutex> lock(mtx_);
+			block->done = true;
+		}
+		done_cv_.notify_all();
+	}
+}
+
+void ParallelCompressor::submit() {
+	if (buf_.empty())
+		return;
+	if (workers_.empty())
+		for (int i = 0; i < threads_; ++i)
+			workers_.emplace_back(&ParallelCompressor::worker, this);
+	// Under memory pressure, fewer blocks are kept in flight.
+	while (pending_.size() >= (Util::Memory::pressure() ? 1 : 2) * (size_t)threads_)
+		write_front();
+	std::unique_ptr<Block> block(new Block);
+	block->in.swap(buf_);
+	buf_.reserve(block_size_);
+	{
+		unique_lock<mutex> lock(mtx_);
+		queue_.push_back(block.get());
+		pending_.push_back(std::move(block));
+	}
+	memory_.resize(int64_t(pending_.size() * block_size_));
+	work_cv_.notify_one();
+}
+
+void ParallelCompressor::write_front() {
+	Block& block = *pending_.front();
+	{
+		unique_lock<mutex> lock(mtx_);
+		done_cv_.wait(lock, [&block] { return block.done; });
+	}
+	if (block.error)
+		std::rethrow_exception(block.error);
+	if (std::fwrite(block.out.data(), 1, block.out.size(), stream_) != block.out.size())
+		throw runtime_error(std::string("Error writing compressed file: ") + strerror(errno));
+	++blocks_written_;
+	pending_.pop_front();
+	memory_.resize(int64_t(pending_.size() * block_size_));
+}
+
+size_t ParallelCompressor::fwrite(const void* buffer, size_t size, size_t count, FILE* stream) {
+	if (size == 0 || count == 0)
+		return 0;
+	if (closed_)
+		throw runtime_error("Cannot write to closed compressor.");
+	if (stream_ == nullptr)
+		stream_ = stream;
+	else if (stream_ != stream)
+		throw runtime_error("Cannot write one compressed stream to multiple FILE handles.");
+	if (count > std::numeric_limits<size_t>::max() / size)
+		throw runtime_error("Compressed write size overflow.");
+	size_t remaining = size * count;
+	const char* in = static_cast<const char*>(buffer);
+	while (remaining > 0) {
+		const size_t n = std::min(remaining, block_size_ - buf_.size());
+		buf_.insert(buf_.end(), in, in + n);
+		in += n;
+		remaining -= n;
+		if (buf_.size() == block_size_)
+			submit();
+	}
+	return count;
+}
+
+void ParallelCompressor::flush(FILE* stream) {
+	if (!closed_ && stream_ != nullptr) {
+		submit();
+		while (!pending_.empty())
+			write_front();
+	}
+	std::fflush(stream);
+}
+
+void ParallelCompressor::stop() {
+	{
+		unique_lock<mutex> lock(mtx_);
+		stop_ = true;
+	}
+	work_cv_.notify_all();
+	for (std::thread& t : workers_)
+		t.join();
+	workers_.clear();
+}
+
+void ParallelCompressor::close(FILE* stream) {
+	if (closed_)
+		return;
+	if (stream_ == nullptr)
+		stream_ = stream;
+	else if (stream_ != stream)
+		throw runtime_error("Cannot close compressor with a different FILE handle.");
+	closed_ = true;
+	try {
+		submit();
+		while (!pending_.empty())
+			write_front();
+		// An empty input is written as one empty member/frame, so that the file is still recognized.
+		if (blocks_written_ == 0 && !bgzf_) {
+			Block block;
+			compress(block);
+			if (std::fwrite(block.out.data(), 1, block.out.size(), stream_) != block.out.size())
+				throw runtime_error(std::string("Error writing compressed file: ") + strerror(errno));
+		}
+		if (bgzf_ && std::fwrite(BGZF_EOF, 1, sizeof(BGZF_EOF), stream_) != sizeof(BGZF_EOF))
+			throw runtime_error(std::string("Error writing compressed file: ") + strerror(errno));
+	}
+	catch (...) {
+		stop();
+		throw;
+	}
+	stop();
+}
+
+ParallelCompressor::~ParallelCompressor() {
+	if (!closed_ && stream_) {
+		try {
+			close(stream_);
+		}
+		catch (...) {
+		}
+	}
+	stop();
+}
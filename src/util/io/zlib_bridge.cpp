@@ -186,6 +186,15 @@ void ZlibCompressor::close(FILE* stream) {
 	closed_ = true;
 }
 
+void ZlibCompressor::flush(FILE* stream) {
+	if (!closed_ && stream_ != nullptr) {
+		strm_.next_in = Z_NULL;
+		strm_.avail_in = 0;
+		deflate_loop(stream_, Z_SYNC_FLUSH);
+	}
+	std::fflush(stream);
+}
+
 ZlibCompressor::~ZlibCompressor() {
 	if (!initialized_)
 		return;
@@ -130,6 +130,20 @@ size_t ZstdCompressor::fwrite(const void* buffer, size_t size, size_t count, FIL
 	return count;
 }
 
+void ZstdCompressor::flush(FILE* stream) {
+	if (!closed_ && stream_ != nullptr) {
+		size_t remaining;
+		do {
+			ZSTD_outBuffer out_buf{ out_.data(), out_.size(), 0 };
+			remaining = ZSTD_flushStream(strm_, &out_buf);
+			if (ZSTD_isError(remaining))
+				throw std::runtime_error(std::string("Error flushing zstd stream: ") + ZSTD_getErrorName(remaining));
+			write_out(stream_, out_buf.pos);
+		} while (remaining != 0);
+	}
+	std::fflush(stream);
+}
+
 void ZstdCompressor::close(FILE* stream) {
 	if (closed_)
 		return;
@@ -21,8 +21,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <exception>
 #include <ostream>
 #include <chrono>
+#include <string>
 #include <stdint.h>
 #include <limits.h>
+#include "trace.h"
+#include "system/perf_counters.h"
 
 extern std::ostream* message_stream;
 extern std::ostream* log_stream;
@@ -71,6 +74,13 @@ struct TaskTimer
 	}
 	void finish()
 	{
+		if (!phase_.empty()) {
+			if (Trace::enabled)
+				Trace::complete(phase_, "phase", trace_begin_);
+			if (Util::Perf::enabled)
+				Util::Perf::add_phase(phase_, perf_begin_);
+			phase_.clear();
+		}
 		if (!msg_ || level_ == UINT_MAX)
 			return;
 		*stream_ << " [" << get() << "s]" << std::endl;
@@ -96,6 +106,13 @@ private:
 	void start(const char *msg)
 	{
 		t = std::chrono::high_resolution_clock::now();
+		if (msg && (Trace::enabled || Util::Perf::enabled)) {
+			phase_ = msg;
+			if (Trace::enabled)
+				trace_begin_ = Trace::now();
+			if (Util::Perf::enabled)
+				perf_begin_ = Util::Perf::read();
+		}
 		if (level_ == UINT_MAX)
 			return;
 		if (!msg)
@@ -119,4 +136,7 @@ private:
 	const char *msg_;
 	std::ostream* stream_;
 	std::chrono::high_resolution_clock::time_point t;
+	std::string phase_;
+	int64_t trace_begin_;
+	Util::Perf::Values perf_begin_;
 };
\ No newline at end of file
@@ -0,0 +1,125 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2012-2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include "governor.h"
+#include "basic/config.h"
+#include "util/log_stream.h"
+#include "util/string/string.h"
+
+using std::string;
+using std::atomic;
+using std::endl;
+
+namespace Util { namespace Memory {
+
+static const int POOLS = (int)Pool::COUNT;
+static const char* const POOL_NAMES[POOLS] = { "Sequences", "Seed arrays", "Seed join", "Trace points", "Seed hits", "Output queue", "Global ranking", "Compression" };
+// Fraction of the limit each pool may use. The pools that size themselves after the headroom have the full limit.
+static const double BUDGET[POOLS] = { 1.0, 1.0, 0.5, 1.0, 0.25, 0.125, 0.5, 0.125 };
+static const double PRESSURE_LEVEL = 0.9, CGROUP_FRACTION = 0.9;
+
+static int64_t limit_ = Util::String::interpret_number(DEFAULT_MEMORY_LIMIT);
+static atomic<int64_t> used_[POOLS], peak_[POOLS], total_(0), total_peak_(0);
+
+static void update_max(atomic<int64_t>& peak, int64_t value) {
+	int64_t p = peak.load(std::memory_order_relaxed);
+	while (value > p && !peak.compare_exchange_weak(p, value, std::memory_order_relaxed));
+}
+
+// Minimum of memory.max over the cgroup v2 hierarchy of the process, 0 if there is no limit.
+static int64_t cgroup_limit() {
+	std::ifstream cgroup("/proc/self/cgroup");
+	string line, path;
+	while (std::getline(cgroup, line))
+		if (line.compare(0, 3, "0::") == 0)
+			path = line.substr(3);
+	if (!cgroup.eof() || path.empty())
+		return 0;
+	int64_t limit = 0;
+	for (;;) {
+		std::ifstream f("/sys/fs/cgroup" + path + "/memory.max");
+		string v;
+		if (f >> v && v != "max") {
+			const int64_t n = std::stoll(v);
+			limit = limit == 0 ? n : std::min(limit, n);
+		}
+		if (path.empty() || path == "/")
+			break;
+		path = path.substr(0, path.find_last_of('/'));
+	}
+	return limit;
+}
+
+void init_governor(int64_t limit, bool explicit_limit) {
+	limit_ = limit;
+	const int64_t cgroup = (int64_t)(cgroup_limit() * CGROUP_FRACTION);
+	if (cgroup > 0 && cgroup < limit_) {
+		if (explicit_limit)
+			*message_stream << "Warning: --memory-limit exceeds the memory limit of the cgroup, using " << Util::String::format(cgroup) << '.' << endl;
+		limit_ = cgroup;
+	}
+	*log_stream << "Memory limit = " << Util::String::format(limit_) << (cgroup > 0 ? " (cgroup limit = " + Util::String::format(cgroup) + ")" : "") << endl;
+}
+
+int64_t limit() {
+	return limit_;
+}
+
+int64_t budget(Pool pool) {
+	return (int64_t)(limit_ * BUDGET[(int)pool]);
+}
+
+int64_t used() {
+	return total_.load(std::memory_order_relaxed);
+}
+
+int64_t used(Pool pool) {
+	return used_[(int)pool].load(std::memory_order_relaxed);
+}
+
+int64_t available(Pool pool) {
+	return std::max(std::min(budget(pool) - used(pool), limit_ - used()), (int64_t)0);
+}
+
+bool pressure() {
+	return used() > limit_ * PRESSURE_LEVEL;
+}
+
+void add(Pool pool, int64_t bytes) {
+	const int i = (int)pool;
+	const int64_t n = used_[i].fetch_add(bytes, std::memory_order_relaxed) + bytes, total = total_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	if (bytes > 0) {
+		update_max(peak_[i], n);
+		update_max(total_peak_, total);
+	}
+}
+
+void log_peak_usage() {
+	*log_stream << "Peak memory usage     = " << Util::String::format(total_peak_.load()) << " (limit " << Util::String::format(limit_) << ")" << endl;
+	for (int i = 0; i < POOLS; ++i)
+		if (peak_[i].load() > 0)
+			*log_stream << "  " << std::left << std::setw(20) << POOL_NAMES[i] << std::right << "= " << Util::String::format(peak_[i].load()) << endl;
+}
+
+}}
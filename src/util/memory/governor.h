@@ -0,0 +1,92 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2012-2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <stdint.h>
+
+// Accounting of the large allocations against --memory-limit. The subsystems register their buffers as reservations
+// in a pool, and phases query the headroom to throttle themselves: the trace point loader stops prefetching, the
+// output queue applies backpressure, the compressor keeps fewer blocks in flight and the seed arrays are built in more
+// index chunks. Each pool has a budget as a fraction of the limit. If the process runs in a cgroup v2 with a lower
+// memory.max, the limit is reduced accordingly.
+
+namespace Util { namespace Memory {
+
+enum class Pool { SEQUENCES, SEED_ARRAYS, SEED_JOIN, TRACE_POINTS, SEED_HITS, OUTPUT, GLOBAL_RANKING, COMPRESSION, COUNT };
+
+// Sets the limit to the minimum of the given limit (--memory-limit) and the cgroup memory.max of the process.
+void init_governor(int64_t limit, bool explicit_limit);
+int64_t limit();
+int64_t budget(Pool pool);
+int64_t used();
+int64_t used(Pool pool);
+// Bytes the pool may still reserve within its budget and the overall limit.
+int64_t available(Pool pool);
+// True if the accounted memory exceeds PRESSURE_LEVEL of the limit.
+bool pressure();
+void add(Pool pool, int64_t bytes);
+// Prints the peak usage per pool to the log.
+void log_peak_usage();
+
+struct Reservation {
+	Reservation():
+		pool_(Pool::COUNT),
+		bytes_(0)
+	{}
+	Reservation(Pool pool, int64_t bytes):
+		pool_(pool),
+		bytes_(0)
+	{
+		resize(bytes);
+	}
+	Reservation(Reservation&& r) noexcept:
+		pool_(r.pool_),
+		bytes_(r.bytes_)
+	{
+		r.bytes_ = 0;
+	}
+	Reservation& operator=(Reservation&& r) noexcept {
+		release();
+		pool_ = r.pool_;
+		bytes_ = r.bytes_;
+		r.bytes_ = 0;
+		return *this;
+	}
+	Reservation(const Reservation&) = delete;
+	Reservation& operator=(const Reservation&) = delete;
+	~Reservation() {
+		release();
+	}
+	void resize(int64_t bytes) {
+		if (bytes != bytes_)
+			add(pool_, bytes - bytes_);
+		bytes_ = bytes;
+	}
+	void release() {
+		resize(0);
+	}
+	int64_t bytes() const {
+		return bytes_;
+	}
+private:
+	Pool pool_;
+	int64_t bytes_;
+};
+
+}}
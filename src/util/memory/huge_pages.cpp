@@ -0,0 +1,176 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2012-2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <fstream>
+#include <string>
+#include "huge_pages.h"
+#include "alignment.h"
+#include "basic/config.h"
+#include "util/log_stream.h"
+#include "util/string/string.h"
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+#if !defined(_WIN32) && defined(MAP_ANONYMOUS)
+#define HUGE_PAGE_MMAP
+#endif
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+using std::atomic;
+using std::mutex;
+using std::endl;
+using std::string;
+
+namespace Util { namespace Memory {
+
+static const size_t PAGE_2M = size_t(1) << 21, PAGE_1G = size_t(1) << 30;
+
+enum { HUGE_PAGES_OFF = 0, HUGE_PAGES_TRANSPARENT = 1, HUGE_PAGES_EXPLICIT = 2 };
+
+// Backing of a large allocation. Explicit huge pages are reserved at mapping time, transparent ones only
+// advised, so whether they are actually used is determined from /proc/self/smaps_rollup when logging.
+enum Backing { REGULAR, TRANSPARENT, EXPLICIT_2M, EXPLICIT_1G, BACKINGS };
+
+struct Mapping {
+	size_t length;
+	Backing backing;
+};
+
+static atomic<size_t> live_bytes[BACKINGS];
+static mutex mtx;
+static std::unordered_map<void*, Mapping> mappings;
+
+static size_t round_up(size_t size, size_t page_size) {
+	return (size + page_size - 1) & ~(page_size - 1);
+}
+
+#ifdef HUGE_PAGE_MMAP
+static void* map(size_t size, int flags) {
+	void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+	return p == MAP_FAILED ? nullptr : p;
+}
+#endif
+
+void* huge_alloc(size_t size, bool zero) {
+#ifdef HUGE_PAGE_MMAP
+	if (size >= HUGE_PAGE_THRESHOLD && config.huge_pages != HUGE_PAGES_OFF) {
+		void* p = nullptr;
+		size_t len = 0;
+		Backing backing = REGULAR;
+#ifdef MAP_HUGETLB
+		if (config.huge_pages == HUGE_PAGES_EXPLICIT) {
+			if (size >= PAGE_1G && (p = map(len = round_up(size, PAGE_1G), MAP_HUGETLB | MAP_HUGE_1GB)) != nullptr)
+				backing = EXPLICIT_1G;
+			else if ((p = map(len = round_up(size, PAGE_2M), MAP_HUGETLB | MAP_HUGE_2MB)) != nullptr)
+				backing = EXPLICIT_2M;
+		}
+#endif
+		if (p == nullptr) {
+			// map an extra huge page so that the returned address can be aligned to a huge page boundary
+			const size_t mapped = round_up(size, PAGE_2M) + PAGE_2M;
+			char* q = (char*)map(mapped, 0);
+			if (q == nullptr)
+				throw std::bad_alloc();
+			char* aligned = (char*)round_up((size_t)q, PAGE_2M);
+			if (aligned > q)
+				munmap(q, aligned - q);
+			len = mapped - (aligned - q);
+			p = aligned;
+#ifdef MADV_HUGEPAGE
+			if (madvise(p, len, MADV_HUGEPAGE) == 0)
+				backing = TRANSPARENT;
+#endif
+		}
+		live_bytes[backing] += len;
+		std::lock_guard<mutex> lock(mtx);
+		mappings[p] = { len, backing };
+		return p;
+	}
+#endif
+	void* p = aligned_malloc(std::max(size, (size_t)1), 32);
+	if (zero)
+		memset(p, 0, size);
+	return p;
+}
+
+static bool unmap(void* p) {
+#ifdef HUGE_PAGE_MMAP
+	std::unique_lock<mutex> lock(mtx);
+	auto it = mappings.find(p);
+	if (it == mappings.end())
+		return false;
+	const Mapping m = it->second;
+	mappings.erase(it);
+	lock.unlock();
+	live_bytes[m.backing] -= m.length;
+	munmap(p, m.length);
+	return true;
+#else
+	return false;
+#endif
+}
+
+void huge_free(void* p, size_t size) {
+	if (p == nullptr)
+		return;
+	if (size < HUGE_PAGE_THRESHOLD || !unmap(p))
+		aligned_free(p);
+}
+
+void huge_free(void* p) {
+	if (p != nullptr && !unmap(p))
+		aligned_free(p);
+}
+
+static size_t anon_huge_pages() {
+	std::ifstream f("/proc/self/smaps_rollup");
+	string line;
+	while (std::getline(f, line))
+		if (line.compare(0, 15, "AnonHugePages: ") == 0)
+			return std::stoull(line.substr(15)) * 1024;
+	return 0;
+}
+
+void log_huge_pages() {
+	const size_t regular = live_bytes[REGULAR], transparent = live_bytes[TRANSPARENT], explicit_2m = live_bytes[EXPLICIT_2M], explicit_1g = live_bytes[EXPLICIT_1G],
+		total = regular + transparent + explicit_2m + explicit_1g;
+	if (total == 0)
+		return;
+	const size_t transparent_resident = std::min(anon_huge_pages(), transparent), hits = explicit_1g + explicit_2m + transparent_resident;
+	*log_stream << "Huge pages: mapped = " << convert_size(total) << ", explicit 1G = " << convert_size(explicit_1g) << ", explicit 2M = " << convert_size(explicit_2m)
+		<< ", transparent = " << convert_size(transparent_resident) << '/' << convert_size(transparent) << ", hit rate = " << (double)hits / total * 100.0 << '%' << endl;
+}
+
+}}
@@ -0,0 +1,72 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2012-2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <stddef.h>
+#include <new>
+
+// Allocation of large, randomly accessed buffers (seed arrays, join tables, sequence storage) on huge pages
+// to reduce dTLB misses. Requests of at least HUGE_PAGE_THRESHOLD bytes are mapped separately and backed by
+// explicit (MAP_HUGETLB, 2 MB or 1 GB) or transparent huge pages according to --huge-pages, falling back to
+// regular pages. Smaller requests are served from the heap.
+
+namespace Util { namespace Memory {
+
+static constexpr size_t HUGE_PAGE_THRESHOLD = size_t(2) << 20;
+
+void* huge_alloc(size_t size, bool zero = false);
+void huge_free(void* p, size_t size);
+// Frees a buffer from huge_alloc without knowing its size (slower, requires a lookup of the mapping).
+void huge_free(void* p);
+void log_huge_pages();
+
+template<typename T>
+struct HugePageAllocator {
+
+	using value_type = T;
+
+	HugePageAllocator() noexcept {}
+
+	template<typename U>
+	HugePageAllocator(const HugePageAllocator<U>&) noexcept {}
+
+	T* allocate(size_t n) {
+		return (T*)huge_alloc(n * sizeof(T));
+	}
+
+	void deallocate(T* p, size_t n) noexcept {
+		huge_free(p, n * sizeof(T));
+	}
+
+	template<typename U>
+	struct rebind {
+		using other = HugePageAllocator<U>;
+	};
+
+	bool operator==(const HugePageAllocator&) const noexcept {
+		return true;
+	}
+
+	bool operator!=(const HugePageAllocator&) const noexcept {
+		return false;
+	}
+
+};
+
+}}
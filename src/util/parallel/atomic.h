@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <atomic>
 #include <thread>
 #include "filestack.h"
+#include "coordinator.h"
 
 template<typename T>
 void exchange_if_smaller(std::atomic<T>& value, T replacement) {
@@ -50,8 +51,9 @@ struct Atomic {
 
 	template<typename Job>
 	Atomic(const std::string& file_name, Job& job):
-		stack_(file_name, job)
+		stack_(file_name, FileStack::Backend::SYNC)
 	{
+		job.register_sync_file(file_name);
 	}
 
 	int64_t get() {
@@ -65,6 +67,10 @@ struct Atomic {
 	}
 
 	void await(int64_t n) {
+		if (stack_.remote()) {
+			Coordinator::await(stack_.file_name(), n);
+			return;
+		}
 		for (;;) {
 			int64_t i;
 			stack_.top(i);
@@ -0,0 +1,546 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <string.h>
+#include "coordinator.h"
+#include "basic/config.h"
+#include "util/log_stream.h"
+#ifndef _WIN32
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+using std::vector;
+using std::runtime_error;
+using std::to_string;
+using std::endl;
+using std::chrono::steady_clock;
+
+namespace Coordinator {
+
+bool enabled() {
+	return !config.coordinator.empty();
+}
+
+#ifdef _WIN32
+
+static void unsupported() {
+	throw runtime_error("--coordinator is not supported on Windows.");
+}
+
+void serve(const string&) { unsupported(); }
+void open(const string&, const vector<string>&) { unsupported(); }
+int64_t push(const string&, const string&) { unsupported(); return 0; }
+bool pop(const string&, string&, bool, int64_t&) { unsupported(); return false; }
+void remove(const string&, const string&) { unsupported(); }
+int64_t size(const string&) { unsupported(); return 0; }
+void clear(const string&) { unsupported(); }
+int64_t fetch_add(const string&, int64_t) { unsupported(); return 0; }
+void await(const string&, int64_t) { unsupported(); }
+void await_query(const string&, const string&, double) { unsupported(); }
+void await_size(const string&, int64_t, double) { unsupported(); }
+void erase(const string&) { unsupported(); }
+void shutdown() { unsupported(); }
+
+#else
+
+// A message is a list of fields, sent as a 32 bit little endian length followed by the fields separated by zero bytes.
+// Requests start with the operation and the stack name, responses with OK or ERR.
+using Message = vector<string>;
+
+static const string UNIX_PREFIX = "unix:";
+// Seconds a worker keeps trying to connect, so that the coordinator may be started after the workers.
+static const int CONNECT_TIMEOUT = 60;
+
+static string errno_str() {
+	return strerror(errno);
+}
+
+static bool is_unix(const string& address) {
+	return address.compare(0, UNIX_PREFIX.size(), UNIX_PREFIX) == 0;
+}
+
+// Returns a listening or connected socket. Returns -1 if the connection is refused.
+static int open_socket(const string& address, bool listen) {
+	if (is_unix(address)) {
+		const string path = address.substr(UNIX_PREFIX.size());
+		sockaddr_un addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		if (path.empty() || path.length() >= sizeof(addr.sun_path))
+			throw runtime_error("Invalid socket path: " + path);
+		strcpy(addr.sun_path, path.c_str());
+		const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0)
+			throw runtime_error("Error creating socket: " + errno_str());
+		if (listen) {
+			::unlink(path.c_str());
+			if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+				::close(fd);
+				throw runtime_error("Error listening on " + address + ": " + errno_str());
+			}
+		}
+		else if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+			::close(fd);
+			return -1;
+		}
+		return fd;
+	}
+	const size_t i = address.rfind(':');
+	if (i == string::npos)
+		throw runtime_error("Invalid coordinator address (expected host:port or unix:path): " + address);
+	const string host = address.substr(0, i), port = address.substr(i + 1);
+	addrinfo hints, *res;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = listen ? AI_PASSIVE : 0;
+	const int e = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &res);
+	if (e != 0)
+		throw runtime_error("Error resolving coordinator address " + address + ": " + gai_strerror(e));
+	int fd = -1;
+	const int one = 1;
+	for (addrinfo* p = res; p != nullptr; p = p->ai_next) {
+		fd = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+		if (fd < 0)
+			continue;
+		if (listen) {
+			setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+			if (bind(fd, p->ai_addr, p->ai_addrlen) == 0 && ::listen(fd, SOMAXCONN) == 0)
+				break;
+		}
+		else if (connect(fd, p->ai_addr, p->ai_addrlen) == 0) {
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+			break;
+		}
+		::close(fd);
+		fd = -1;
+	}
+	freeaddrinfo(res);
+	if (fd < 0 && listen)
+		throw runtime_error("Error listening on " + address + ": " + errno_str());
+	return fd;
+}
+
+static string encode(const Message& m) {
+	string s(4, '\0');
+	for (size_t i = 0; i < m.size(); ++i) {
+		if (i > 0)
+			s += '\0';
+		s += m[i];
+	}
+	const uint32_t n = uint32_t(s.length() - 4);
+	for (int i = 0; i < 4; ++i)
+		s[i] = char((n >> (8 * i)) & 0xff);
+	return s;
+}
+
+static Message decode(const char* p, size_t n) {
+	Message m(1);
+	for (const char* end = p + n; p < end; ++p)
+		if (*p == '\0')
+			m.emplace_back();
+		else
+			m.back() += *p;
+	return m;
+}
+
+static uint32_t frame_size(const char* p) {
+	uint32_t n = 0;
+	for (int i = 0; i < 4; ++i)
+		n |= uint32_t((unsigned char)p[i]) << (8 * i);
+	return n;
+}
+
+static bool send_all(int fd, const string& s) {
+#ifdef MSG_NOSIGNAL
+	const int flags = MSG_NOSIGNAL;
+#else
+	const int flags = 0;
+#endif
+	for (size_t i = 0; i < s.length();) {
+		const ssize_t n = ::send(fd, s.data() + i, s.length() - i, flags);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		i += n;
+	}
+	return true;
+}
+
+static bool recv_all(int fd, char* p, size_t n) {
+	while (n > 0) {
+		const ssize_t i = ::recv(fd, p, n, 0);
+		if (i < 0 && errno == EINTR)
+			continue;
+		if (i <= 0)
+			return false;
+		p += i;
+		n -= i;
+	}
+	return true;
+}
+
+// Lines of a push, split like the lines written to a stack file.
+static vector<string> lines(const string& s) {
+	vector<string> v;
+	size_t i = 0;
+	do {
+		const size_t j = s.find('\n', i);
+		v.push_back(s.substr(i, j == string::npos ? string::npos : j - i));
+		i = j == string::npos ? s.length() : j + 1;
+	} while (i < s.length());
+	return v;
+}
+
+namespace {
+
+struct Waiter {
+	int fd;
+	string op, stack, arg;
+	steady_clock::time_point deadline;
+};
+
+struct Server {
+
+	void run(const string& address);
+
+private:
+
+	using Stack = vector<string>;
+
+	int64_t top_value(const string& stack) const {
+		const auto it = stacks_.find(stack);
+		return it == stacks_.end() || it->second.empty() || it->second.back().empty() ? -1 : std::stoll(it->second.back());
+	}
+
+	// Returns true if the waiter can be answered, setting error if it fails.
+	bool ready(const Waiter& w, string& error) const {
+		const auto it = stacks_.find(w.stack);
+		const size_t size = it == stacks_.end() ? 0 : it->second.size();
+		if (w.op == "AWAIT")
+			return top_value(w.stack) >= std::stoll(w.arg);
+		if (w.op == "AWAIT_SIZE")
+			return size == (size_t)std::stoll(w.arg);
+		const string top = size > 0 ? it->second.back() : string();
+		if (top.find(w.arg) != string::npos)
+			return true;
+		if (top.find("STOP") != string::npos) {
+			error = "STOP on FileStack " + w.stack;
+			return true;
+		}
+		return false;
+	}
+
+	void reply(int fd, const string& error) {
+		send_all(fd, encode(error.empty() ? Message{ "OK" } : Message{ "ERR", error }));
+	}
+
+	// Answers the satisfied waiters of a modified stack.
+	void wake(const string& stack) {
+		string error;
+		for (auto it = waiters_.begin(); it != waiters_.end();) {
+			error.clear();
+			bool done;
+			try {
+				done = it->stack == stack && ready(*it, error);
+			}
+			catch (std::exception& e) {
+				error = e.what();
+				done = true;
+			}
+			if (done) {
+				reply(it->fd, error);
+				it = waiters_.erase(it);
+			}
+			else
+				++it;
+		}
+	}
+
+	void expire() {
+		const auto now = steady_clock::now();
+		for (auto it = waiters_.begin(); it != waiters_.end();) {
+			if (it->deadline <= now) {
+				reply(it->fd, it->op == "AWAIT_SIZE" ? "Could not detect size " + it->arg + " of FileStack " + it->stack
+					: "Could not discover keyword " + it->arg + " on FileStack " + it->stack);
+				it = waiters_.erase(it);
+			}
+			else
+				++it;
+		}
+	}
+
+	// Returns the response, or an empty message if the request waits for a modification.
+	Message handle(int fd, const Message& m) {
+		const string& op = m[0];
+		if (op == "SHUTDOWN") {
+			stop_ = true;
+			return { "OK" };
+		}
+		if (m.size() < 2)
+			return { "ERR", "Malformed coordinator request" };
+		const string& name = m[1];
+		if (op == "OPEN") {
+			if (stacks_.find(name) == stacks_.end())
+				stacks_[name] = Stack(m.begin() + 2, m.end());
+			return { "OK" };
+		}
+		if (op == "SIZE") {
+			const auto it = stacks_.find(name);
+			return { "OK", to_string(it == stacks_.end() ? 0 : it->second.size()) };
+		}
+		if (op == "AWAIT" || op == "AWAIT_SIZE" || op == "AWAIT_QUERY") {
+			if (m.size() < 3)
+				return { "ERR", "Malformed coordinator request" };
+			const double timeout = m.size() > 3 ? std::stod(m[3]) : 0.0;
+			const Waiter w{ fd, op, name, m[2], timeout > 0.0 ? steady_clock::now() + std::chrono::duration_cast<steady_clock::duration>(std::chrono::duration<double>(timeout))
+				: steady_clock::time_point::max() };
+			string error;
+			if (ready(w, error))
+				return error.empty() ? Message{ "OK" } : Message{ "ERR", error };
+			waiters_.push_back(w);
+			return {};
+		}
+		Stack& s = stacks_[name];
+		Message r{ "OK" };
+		if (op == "PUSH" && m.size() > 2) {
+			for (const string& l : lines(m[2]))
+				s.push_back(l);
+			r.push_back(to_string(s.size()));
+		}
+		else if (op == "POP" || op == "TOP") {
+			string line;
+			if (!s.empty()) {
+				line = s.back();
+				if (op == "POP")
+					s.pop_back();
+			}
+			r.push_back(to_string(s.size()));
+			if (!line.empty())
+				r.push_back(line);
+		}
+		else if (op == "REMOVE" && m.size() > 2)
+			s.erase(std::remove(s.begin(), s.end(), m[2]), s.end());
+		else if (op == "CLEAR")
+			s.clear();
+		else if (op == "ADD" && m.size() > 2) {
+			const int64_t i = std::max(top_value(name), (int64_t)0);
+			if (!s.empty())
+				s.pop_back();
+			s.push_back(to_string(i + std::stoll(m[2])));
+			r.push_back(to_string(i));
+		}
+		else if (op == "ERASE")
+			stacks_.erase(name);
+		else
+			return { "ERR", "Unknown coordinator request: " + op };
+		if (op != "TOP" && op != "ERASE")
+			wake(name);
+		return r;
+	}
+
+	void disconnect(int fd) {
+		waiters_.erase(std::remove_if(waiters_.begin(), waiters_.end(), [fd](const Waiter& w) { return w.fd == fd; }), waiters_.end());
+		buffers_.erase(fd);
+		::close(fd);
+	}
+
+	// Reads from a client and handles its complete requests. Returns false if the connection was closed.
+	bool receive(int fd) {
+		char buf[65536];
+		const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+		if (n < 0 && errno == EINTR)
+			return true;
+		if (n <= 0)
+			return false;
+		string& b = buffers_[fd];
+		b.append(buf, n);
+		size_t i = 0;
+		while (b.length() - i >= 4 && b.length() - i - 4 >= frame_size(b.data() + i)) {
+			const uint32_t size = frame_size(b.data() + i);
+			Message r;
+			try {
+				r = handle(fd, decode(b.data() + i + 4, size));
+			}
+			catch (std::exception& e) {
+				r = { "ERR", e.what() };
+			}
+			if (!r.empty() && !send_all(fd, encode(r)))
+				return false;
+			i += 4 + size;
+		}
+		b.erase(0, i);
+		return true;
+	}
+
+	std::unordered_map<string, Stack> stacks_;
+	vector<Waiter> waiters_;
+	std::map<int, string> buffers_;
+	bool stop_ = false;
+
+};
+
+void Server::run(const string& address) {
+	const int listen_fd = open_socket(address, true);
+	*message_stream << "Coordinator listening on " << address << endl;
+	vector<pollfd> fds;
+	while (!stop_) {
+		fds.assign(1, pollfd{ listen_fd, POLLIN, 0 });
+		for (const auto& b : buffers_)
+			fds.push_back(pollfd{ b.first, POLLIN, 0 });
+		int timeout = -1;
+		for (const Waiter& w : waiters_)
+			if (w.deadline != steady_clock::time_point::max()) {
+				const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(w.deadline - steady_clock::now()).count() + 1;
+				timeout = (int)std::max<int64_t>(0, timeout < 0 ? ms : std::min<int64_t>(timeout, ms));
+			}
+		if (poll(fds.data(), fds.size(), timeout) < 0) {
+			if (errno == EINTR)
+				continue;
+			throw runtime_error("Error polling coordinator sockets: " + errno_str());
+		}
+		for (size_t i = 1; i < fds.size(); ++i)
+			if (fds[i].revents && !receive(fds[i].fd))
+				disconnect(fds[i].fd);
+		if (fds[0].revents & POLLIN) {
+			const int fd = accept(listen_fd, nullptr, nullptr);
+			if (fd >= 0) {
+				const int one = 1;
+				setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+				buffers_[fd];
+			}
+		}
+		expire();
+	}
+	while (!buffers_.empty())
+		disconnect(buffers_.begin()->first);
+	::close(listen_fd);
+	if (is_unix(address))
+		::unlink(address.substr(UNIX_PREFIX.size()).c_str());
+	*message_stream << "Coordinator shut down" << endl;
+}
+
+struct Connection {
+	~Connection() {
+		if (fd >= 0)
+			::close(fd);
+	}
+	int fd = -1;
+};
+
+}
+
+static thread_local Connection connection_;
+
+static Message request(const Message& m) {
+	if (connection_.fd < 0) {
+		const auto deadline = steady_clock::now() + std::chrono::seconds(CONNECT_TIMEOUT);
+		while ((connection_.fd = open_socket(config.coordinator, false)) < 0) {
+			if (steady_clock::now() >= deadline)
+				throw runtime_error("Could not connect to the coordinator at " + config.coordinator);
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+	}
+	char size[4];
+	if (!send_all(connection_.fd, encode(m)) || !recv_all(connection_.fd, size, 4))
+		throw runtime_error("Lost connection to the coordinator at " + config.coordinator);
+	string payload(frame_size(size), '\0');
+	if (!recv_all(connection_.fd, &payload[0], payload.length()))
+		throw runtime_error("Lost connection to the coordinator at " + config.coordinator);
+	Message r = decode(payload.data(), payload.length());
+	if (r[0] != "OK")
+		throw runtime_error(r.size() > 1 ? r[1] : "Coordinator request failed: " + m[0]);
+	return r;
+}
+
+void serve(const string& address) {
+	Server().run(address);
+}
+
+void open(const string& stack, const vector<string>& lines) {
+	Message m{ "OPEN", stack };
+	m.insert(m.end(), lines.begin(), lines.end());
+	request(m);
+}
+
+int64_t push(const string& stack, const string& line) {
+	return std::stoll(request({ "PUSH", stack, line })[1]);
+}
+
+bool pop(const string& stack, string& line, bool keep, int64_t& size_after) {
+	const Message r = request({ keep ? "TOP" : "POP", stack });
+	size_after = std::stoll(r[1]);
+	line = r.size() > 2 ? r[2] : string();
+	return r.size() > 2;
+}
+
+void remove(const string& stack, const string& line) {
+	request({ "REMOVE", stack, line });
+}
+
+int64_t size(const string& stack) {
+	return std::stoll(request({ "SIZE", stack })[1]);
+}
+
+void clear(const string& stack) {
+	request({ "CLEAR", stack });
+}
+
+int64_t fetch_add(const string& stack, int64_t n) {
+	return std::stoll(request({ "ADD", stack, to_string(n) })[1]);
+}
+
+void await(const string& stack, int64_t n) {
+	request({ "AWAIT", stack, to_string(n) });
+}
+
+void await_query(const string& stack, const string& query, double timeout) {
+	request({ "AWAIT_QUERY", stack, query, to_string(timeout) });
+}
+
+void await_size(const string& stack, int64_t size, double timeout) {
+	request({ "AWAIT_SIZE", stack, to_string(size), to_string(timeout) });
+}
+
+void erase(const string& stack) {
+	request({ "ERASE", stack });
+}
+
+void shutdown() {
+	request({ "SHUTDOWN" });
+}
+
+#endif
+
+}
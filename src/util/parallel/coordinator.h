@@ -0,0 +1,53 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// Socket backend for the synchronization stacks of distributed runs (--coordinator). The coordinator process (diamond
+// coordinator) keeps the stacks in memory, keyed by their file names, and serves the FileStack operations over TCP
+// (host:port) or UNIX domain sockets (unix:path). Waiting operations are answered as soon as a modification of the stack
+// satisfies them instead of polling the file system. Every thread of a worker uses its own connection.
+namespace Coordinator {
+
+bool enabled();
+// Runs the coordinator until a worker requests the shutdown.
+void serve(const std::string& address);
+
+// Creates the stack with the given lines unless it exists already.
+void open(const std::string& stack, const std::vector<std::string>& lines);
+// Returns the size of the stack after the push.
+int64_t push(const std::string& stack, const std::string& line);
+// Returns false if the stack is empty. Keeps the line on the stack if keep is set.
+bool pop(const std::string& stack, std::string& line, bool keep, int64_t& size_after);
+void remove(const std::string& stack, const std::string& line);
+int64_t size(const std::string& stack);
+void clear(const std::string& stack);
+int64_t fetch_add(const std::string& stack, int64_t n);
+// Waits until the top of the stack is a number >= n.
+void await(const std::string& stack, int64_t n);
+// Waits until the top line contains query, see FileStack::poll_query.
+void await_query(const std::string& stack, const std::string& query, double timeout);
+void await_size(const std::string& stack, int64_t size, double timeout);
+void erase(const std::string& stack);
+void shutdown();
+
+}
@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <algorithm>
 #include <string.h>
 #include <iostream>
+#include <fstream>
 #include <algorithm>
 #include <chrono>
 #include <thread>
@@ -29,6 +30,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <limits>
 #include <vector>
 #include "multiprocessing.h"
+#include "coordinator.h"
 #include "util/system/system.h"
 #ifdef _WIN32
 #else
@@ -59,12 +61,20 @@ FileStack::FileStack() : FileStack::FileStack(default_file_name) {
 
 void FileStack::remove() {
     close();
+    if (remote_) {
+        Coordinator::erase(file_name_);
+        if (!exists(file_name_))
+            return;
+    }
 	remove_tmp_file(file_name_);
 }
 
 FileStack::FileStack(const string & file_name) : FileStack::FileStack(file_name, default_max_line_length) {
 }
 
+FileStack::FileStack(const string & file_name, Backend backend) : FileStack::FileStack(file_name, default_max_line_length, backend) {
+}
+
 void FileStack::close() {
 #ifdef _WIN32
     if (hFile != INVALID_HANDLE_VALUE) {
@@ -79,9 +89,26 @@ void FileStack::close() {
 #endif
 }
 
-FileStack::FileStack(const string & file_name, int maximum_line_length):
-    file_name_(file_name)
+FileStack::FileStack(const string & file_name, int maximum_line_length, Backend backend):
+    file_name_(file_name),
+    remote_(backend == Backend::SYNC && Coordinator::enabled())
 {
+    set_max_line_length(maximum_line_length);
+    if (remote_) {
+#ifdef _WIN32
+        hFile = INVALID_HANDLE_VALUE;
+#else
+        fd = -1;
+#endif
+        // A stack file written before the run (e.g. by --mp-init) seeds the stack on the coordinator.
+        vector<string> lines;
+        std::ifstream f(file_name);
+        string line;
+        while (std::getline(f, line))
+            lines.push_back(line);
+        Coordinator::open(file_name_, lines);
+        return;
+    }
 #ifdef _WIN32
     hFile = CreateFile(TEXT(file_name.c_str()), FILE_GENERIC_WRITE | FILE_GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
     if (hFile == INVALID_HANDLE_VALUE)
@@ -93,7 +120,6 @@ FileStack::FileStack(const string & file_name, int maximum_line_length):
         throw(std::runtime_error("could not open file " + file_name_));
     }
 #endif
-    set_max_line_length(maximum_line_length);
 }
 
 FileStack::~FileStack() {
@@ -154,6 +180,8 @@ int FileStack::unlock() {
 }
 
 int64_t FileStack::seek(int64_t offset, int mode) {
+    if (remote_)
+        throw runtime_error("FileStack " + file_name_ + " is held by the coordinator and has no file");
 #ifdef _WIN32
     LARGE_INTEGER ptr, o;
     o.QuadPart = offset;
@@ -167,6 +195,8 @@ int64_t FileStack::seek(int64_t offset, int mode) {
 }
 
 size_t FileStack::read(char* buf, size_t size) {
+    if (remote_)
+        throw runtime_error("FileStack " + file_name_ + " is held by the coordinator and has no file");
 #ifdef _WIN32
     DWORD n;
     if (!ReadFile(hFile, buf, (DWORD)size, &n, NULL))
@@ -181,6 +211,8 @@ size_t FileStack::read(char* buf, size_t size) {
 }
 
 int64_t FileStack::write(const char* buf, size_t size) {
+    if (remote_)
+        throw runtime_error("FileStack " + file_name_ + " is held by the coordinator and has no file");
 #ifdef _WIN32
     DWORD n;
     if (!WriteFile(hFile, buf, (DWORD)size, &n, NULL))
@@ -192,6 +224,8 @@ int64_t FileStack::write(const char* buf, size_t size) {
 }
 
 int FileStack::truncate(size_t size) {
+    if (remote_)
+        throw runtime_error("FileStack " + file_name_ + " is held by the coordinator and has no file");
 #ifdef _WIN32
     seek(size, SEEK_SET);
     if (!SetEndOfFile(hFile))
@@ -204,6 +238,13 @@ int FileStack::truncate(size_t size) {
 
 int64_t FileStack::pop_non_locked(string & buf, const bool keep_flag, size_t & size_after_pop) {
     DBG("");
+    if (remote_) {
+        int64_t size;
+        Coordinator::pop(file_name_, buf, keep_flag, size);
+        if (size_after_pop != numeric_limits<size_t>::max())
+            size_after_pop = (size_t)size;
+        return buf.size();
+    }
     buf.clear();
     int stat = 0;
     const int64_t size = seek(0, SEEK_END);
@@ -256,6 +297,8 @@ int64_t FileStack::pop_exclusive(string & buf) {
 
 int FileStack::pop(string & buf, const bool keep_flag, size_t & size_after_pop) {
     DBG("");
+    if (remote_)
+        return (int)pop_non_locked(buf, keep_flag, size_after_pop);
     lock();
     int val = (int)pop_non_locked(buf, keep_flag, size_after_pop);
     unlock();
@@ -292,6 +335,8 @@ int64_t FileStack::pop_non_locked(int64_t & i) {
 }
 
 int64_t FileStack::pop(int64_t& i) {
+    if (remote_)
+        return pop_non_locked(i);
     lock();
     const int64_t r = pop_non_locked(i);
     unlock();
@@ -312,6 +357,10 @@ int64_t FileStack::top(int64_t& i) {
 
 void FileStack::remove(const string & line) {
     DBG("");
+    if (remote_) {
+        Coordinator::remove(file_name_, line);
+        return;
+    }
     lock();
     const int64_t size = seek(0, SEEK_END);
     seek(0, SEEK_SET);
@@ -340,6 +389,10 @@ void FileStack::remove(const string & line) {
 int64_t FileStack::push_exclusive(const string & buf) {
     DBG("");
     static const string nl("\n");
+    if (remote_) {
+        Coordinator::push(file_name_, buf);
+        return buf.size() + (buf.back() != nl.back() ? 1 : 0);
+    }
     seek(0, SEEK_END);
     size_t n = write(buf.c_str(), buf.size());
     if (buf.back() != nl.back()) {
@@ -350,6 +403,12 @@ int64_t FileStack::push_exclusive(const string & buf) {
 
 int64_t FileStack::push(const string & buf, size_t & size_after_push) {
     DBG("");
+    if (remote_) {
+        const int64_t size = Coordinator::push(file_name_, buf);
+        if (size_after_push != numeric_limits<size_t>::max())
+            size_after_push = (size_t)size;
+        return buf.size() + (buf.back() != '\n' ? 1 : 0);
+    }
     lock();
     int64_t n = push_exclusive(buf);
     if (size_after_push != numeric_limits<size_t>::max()) {
@@ -363,6 +422,10 @@ std::string FileStack::file_name() const {
     return file_name_;
 }
 
+bool FileStack::remote() const {
+    return remote_;
+}
+
 int64_t FileStack::push(const string & buf) {
     DBG("");
     size_t size_after_push = numeric_limits<size_t>::max();
@@ -376,6 +439,8 @@ int64_t FileStack::push_non_locked(int64_t i) {
 }
 
 int64_t FileStack::push(int64_t i) {
+    if (remote_)
+        return push_non_locked(i);
     lock();
     const int64_t r = push_non_locked(i);
     unlock();
@@ -384,6 +449,8 @@ int64_t FileStack::push(int64_t i) {
 
 size_t FileStack::size() {
     DBG("");
+    if (remote_)
+        return (size_t)Coordinator::size(file_name_);
     lock();
     const size_t c = size_unlocked();
     unlock();
@@ -412,6 +479,10 @@ size_t FileStack::size_unlocked() {
 
 int FileStack::clear() {
     DBG("");
+    if (remote_) {
+        Coordinator::clear(file_name_);
+        return 0;
+    }
     lock();
     seek(0, SEEK_SET);
     int stat = truncate(0);
@@ -421,6 +492,10 @@ int FileStack::clear() {
 
 bool FileStack::poll_query(const string & query, const double sleep_s, const size_t max_iter) {
     DBG("");
+    if (remote_) {
+        Coordinator::await_query(file_name_, query, double(max_iter) * sleep_s);
+        return true;
+    }
     string buf;
     const std::chrono::duration<double> sleep_time(sleep_s);
     for (size_t i=0; i < max_iter; ++i) {
@@ -443,6 +518,10 @@ bool FileStack::poll_query(const string & query, const double sleep_s, const siz
 
 bool FileStack::poll_size(const size_t size, const double sleep_s, const size_t max_iter) {
     DBG("");
+    if (remote_) {
+        Coordinator::await_size(file_name_, (int64_t)size, double(max_iter) * sleep_s);
+        return true;
+    }
     string buf;
     const std::chrono::duration<double> sleep_time(sleep_s);
     for (size_t i=0; i < max_iter; ++i) {
@@ -475,6 +554,8 @@ int FileStack::get_max_line_length() {
 
 
 int64_t FileStack::fetch_add(int64_t n) {
+    if (remote_)
+        return Coordinator::fetch_add(file_name_, n);
     string s;
     lock();
     int64_t i;
@@ -39,9 +39,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 class FileStack {
     public:
+        // Stacks used for synchronization (work queues, counters, barriers) are held by the coordinator process if
+        // --coordinator is set. Stacks that are also read as data files always use the file system.
+        enum class Backend { FILE, SYNC };
         FileStack();
         FileStack(const std::string & file_name);
-        FileStack(const std::string & file_name, int maximum_line_length);
+        FileStack(const std::string & file_name, Backend backend);
+        FileStack(const std::string & file_name, int maximum_line_length, Backend backend = Backend::FILE);
         ~FileStack();
         void close();
         template<typename Job>
@@ -80,6 +84,7 @@ class FileStack {
         bool poll_query(const std::string & query, const double sleep_s=0.5, const size_t max_iter=7200);
         bool poll_size(const size_t size, const double sleep_s=0.5, const size_t max_iter=7200);
         std::string file_name() const;
+        bool remote() const;
                 
         int64_t pop_exclusive(std::string& buf);
         int64_t push_exclusive(const std::string& buf);
@@ -98,6 +103,7 @@ class FileStack {
         struct flock lck;
 #endif
         std::string file_name_;
+        bool remote_;
         off_t max_line_length;
 
         int pop(std::string &, const bool, size_t &);
@@ -37,6 +37,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // #define DEBUG
 #undef DEBUG
 #include "filestack.h"
+#include "coordinator.h"
 #include "parallelizer.h"
 
 using std::shared_ptr;
@@ -143,10 +144,10 @@ bool Parallelizer::barrier(const string & tag) {
 
     auto cmd_file_name = get_barrier_file_name("cmd", tag, i_barrier);
     DBG(cmd_file_name);
-    FileStack cmd_fs(cmd_file_name);
+    FileStack cmd_fs(cmd_file_name, FileStack::Backend::SYNC);
     auto ack_file_name = get_barrier_file_name("ack", tag, i_barrier);
     DBG(ack_file_name);
-    FileStack ack_fs(ack_file_name);
+    FileStack ack_fs(ack_file_name, FileStack::Backend::SYNC);
 
     static const string msg = "WAIT";
     if (is_master()) {
@@ -211,7 +212,7 @@ bool Parallelizer::create_stack(const std::string & tag, std::string sfx) {
 
 bool Parallelizer::create_stack_from_file(const std::string & tag, const std::string & file_name) {
     delete_stack(tag);
-    fs_map.emplace(tag, shared_ptr<FileStack>(new FileStack(file_name)));
+    fs_map.emplace(tag, shared_ptr<FileStack>(new FileStack(file_name, tag == LOG ? FileStack::Backend::FILE : FileStack::Backend::SYNC)));
     DBG(file_name);
     return true;
 }
@@ -241,6 +242,8 @@ void Parallelizer::sleep(const double sleep_s) {
 
 bool Parallelizer::clean(vector<string> & file_list) {
     for (auto s : file_list) {
+        if (Coordinator::enabled())
+            Coordinator::erase(s);
         errno = 0;
         UNLINK(s.c_str());
     }
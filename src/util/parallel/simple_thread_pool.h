@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <mutex>
 #include <exception>
 #include <tuple>
+#include "../trace.h"
 
 namespace simple_thread_pool_detail {
 
@@ -53,6 +54,7 @@ struct SpawnTask {
         : fn(std::move(f)), args(std::move(a)), stop(s), mtx(m), exc(e) {}
 
     void operator()() {
+        Trace::Span span("thread", "thread");
         try {
             invoke(make_index_sequence<std::tuple_size<Tuple>::value>{});
         }
@@ -26,6 +26,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <condition_variable>
 #include <functional>
 #include "../log_stream.h"
+#include "../trace.h"
+#include "../system/numa.h"
 
 namespace Util { namespace Parallel {
 
@@ -149,6 +151,8 @@ struct ThreadPool {
 			std::unique_lock<std::mutex> lock(mtx_);
 			++task_set.total_;
 			tasks_[task_set.priority].emplace([task]() { task(); }, task_set);
+			if (Trace::enabled)
+				Trace::counter("thread pool queue", queue_len(task_set.priority));
 			task_set.cv_.notify_one();
 		}
 	}
@@ -170,6 +174,7 @@ struct ThreadPool {
 				if (!task) {
 					const int64_t next = default_begin_.fetch_add(1, std::memory_order_relaxed);
 					if (next < default_end_) {
+						Trace::Span span("default task", "thread_pool", "index", next);
 						default_task_(*this, next);
 						default_finished_.fetch_add(1, std::memory_order_relaxed);
 					}
@@ -185,7 +190,10 @@ struct ThreadPool {
 				task = pop_task(task_set->priority);
 			}
 
-			task.f();
+			{
+				Trace::Span span("task", "thread_pool");
+				task.f();
+			}
 			if (task.task_set)
 				task.task_set->finish();
 		}
@@ -205,7 +213,13 @@ struct ThreadPool {
 
 	void run(int threads, bool heartbeat = false, TaskSet* task_set = nullptr) {
 		for (int i = 0; i < threads; ++i)
-			workers_.emplace_back([this, task_set] { this->run_set(task_set); });
+			workers_.emplace_back([this, task_set, i] {
+				if (Trace::enabled)
+					Trace::thread_name("thread pool worker " + std::to_string(i));
+				if (Util::Numa::active())
+					Util::Numa::pin_thread(Util::Numa::worker_node(i));
+				this->run_set(task_set);
+			});
 		if (heartbeat)
 			heartbeat_ = std::thread([&]() {
 			while (default_finished_ < default_count_) {
@@ -119,9 +119,43 @@ Arch init_arch() {
 	return Arch::Generic;
 }
 
+static Arch current_arch = Arch::None;
+
 Arch arch() {
-	static Arch a = Arch::None;
-	return a == Arch::None ? (a = init_arch()) : a;
+	return current_arch == Arch::None ? (current_arch = init_arch()) : current_arch;
+}
+
+void set_arch(Arch a) {
+	current_arch = a;
+}
+
+std::vector<Arch> archs() {
+	init_arch();
+	std::vector<Arch> v{ Arch::Generic };
+#ifdef WITH_SSE4_1
+	if ((flags & SSSE3) && (flags & POPCNT) && (flags & SSE4_1))
+		v.push_back(Arch::SSE4_1);
+#endif
+#ifdef WITH_AVX2
+	if ((flags & SSSE3) && (flags & POPCNT) && (flags & SSE4_1) && (flags & AVX2))
+		v.push_back(Arch::AVX2);
+#endif
+#ifdef WITH_NEON
+	if (flags & NEON)
+		v.push_back(Arch::NEON);
+#endif
+	return v;
+}
+
+string arch_name(Arch a) {
+	switch (a) {
+	case Arch::Generic: return "generic";
+	case Arch::SSE4_1: return "sse4.1";
+	case Arch::AVX2: return "avx2";
+	case Arch::AVX512: return "avx512";
+	case Arch::NEON: return "neon";
+	default: return "none";
+	}
 }
 
 string features() {
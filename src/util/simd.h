@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
 #include <string>
+#include <vector>
 #include <ostream>
 #include "system.h"
 
@@ -51,6 +52,11 @@ namespace SIMD {
 enum class Arch { None, Generic, SSE4_1, AVX2, AVX512, NEON };
 enum Flags { SSSE3 = 1, POPCNT = 2, SSE4_1 = 4, AVX2 = 8, AVX512 = 16, NEON = 32 };
 Arch arch();
+// Overrides the detected architecture for all dispatched functions. Arch::None restores the detected one.
+void set_arch(Arch a);
+// The architectures that were compiled in and are supported by the CPU, in ascending order.
+std::vector<Arch> archs();
+std::string arch_name(Arch a);
 
 std::string features();
 
@@ -0,0 +1,196 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2012-2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <stdint.h>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include "numa.h"
+#include "basic/config.h"
+#include "util/log_stream.h"
+#ifdef __linux__
+#include <unistd.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_move_pages)
+#define NUMA_SYSCALLS
+#endif
+
+using std::vector;
+using std::string;
+using std::endl;
+
+namespace Util { namespace Numa {
+
+static const int MAX_NODES = 1024, MPOL_INTERLEAVE_ = 3, MPOL_MF_MOVE_ = 1 << 1, MAX_SAMPLED_PAGES = 4096;
+
+struct Node {
+	int id;
+	string cpulist;
+	vector<int> cpus;
+};
+
+static vector<int> parse_list(const string& s) {
+	vector<int> v;
+	std::istringstream ss(s);
+	string range;
+	while (std::getline(ss, range, ',')) {
+		if (range.empty() || range == "\n")
+			continue;
+		const size_t i = range.find('-');
+		const int begin = std::stoi(range.substr(0, i)), end = i == string::npos ? begin : std::stoi(range.substr(i + 1));
+		for (int j = begin; j <= end; ++j)
+			v.push_back(j);
+	}
+	return v;
+}
+
+static string read_line(const string& file_name) {
+	std::ifstream f(file_name);
+	string s;
+	std::getline(f, s);
+	return s;
+}
+
+static vector<Node> detect() {
+	vector<Node> nodes;
+#ifdef __linux__
+	try {
+		for (int id : parse_list(read_line("/sys/devices/system/node/online"))) {
+			if (id >= MAX_NODES)
+				continue;
+			const string cpulist = read_line("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+			const vector<int> cpus = parse_list(cpulist);
+			if (!cpus.empty())
+				nodes.push_back({ id, cpulist, cpus });
+		}
+	}
+	catch (std::exception&) {
+		nodes.clear();
+	}
+#endif
+	return nodes;
+}
+
+static const vector<Node>& topology() {
+	static const vector<Node> nodes = detect();
+	return nodes;
+}
+
+int nodes() {
+	return std::max((int)topology().size(), 1);
+}
+
+bool active() {
+	return config.numa && nodes() > 1;
+}
+
+int worker_node(size_t worker) {
+	return int(worker % nodes());
+}
+
+bool pin_thread(int node) {
+#ifdef __linux__
+	if (node < 0 || node >= (int)topology().size())
+		return false;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (int cpu : topology()[node].cpus)
+		if (cpu < CPU_SETSIZE)
+			CPU_SET(cpu, &set);
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+#ifdef NUMA_SYSCALLS
+static std::pair<uintptr_t, size_t> page_range(const void* ptr, size_t size) {
+	const uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+	const uintptr_t begin = ((uintptr_t)ptr + page_size - 1) & ~(page_size - 1), end = ((uintptr_t)ptr + size) & ~(page_size - 1);
+	return { begin, end > begin ? end - begin : 0 };
+}
+#endif
+
+void interleave(void* ptr, size_t size) {
+#ifdef NUMA_SYSCALLS
+	if (topology().size() < 2)
+		return;
+	const auto range = page_range(ptr, size);
+	if (range.second == 0)
+		return;
+	const int bits = 8 * sizeof(unsigned long);
+	unsigned long mask[MAX_NODES / bits] = {};
+	for (const Node& n : topology())
+		mask[n.id / bits] |= 1ul << (n.id % bits);
+	// Failure is not fatal, the memory just stays where the kernel put it.
+	syscall(SYS_mbind, range.first, range.second, MPOL_INTERLEAVE_, mask, (unsigned long)MAX_NODES + 1, MPOL_MF_MOVE_);
+#endif
+}
+
+vector<double> placement(const void* ptr, size_t size) {
+	vector<double> v;
+#ifdef NUMA_SYSCALLS
+	const auto range = page_range(ptr, size);
+	const uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+	const size_t pages = range.second / page_size, step = std::max(pages / MAX_SAMPLED_PAGES, (size_t)1);
+	vector<void*> addr;
+	for (size_t i = 0; i < pages; i += step)
+		addr.push_back((void*)(range.first + i * page_size));
+	vector<int> status(addr.size(), -1);
+	if (addr.empty() || syscall(SYS_move_pages, 0, addr.size(), addr.data(), nullptr, status.data(), 0) != 0)
+		return v;
+	vector<size_t> count(topology().size(), 0);
+	size_t resident = 0;
+	for (int s : status)
+		for (size_t i = 0; i < topology().size(); ++i)
+			if (topology()[i].id == s) {
+				++count[i];
+				++resident;
+			}
+	if (resident == 0)
+		return v;
+	for (size_t n : count)
+		v.push_back((double)n / resident);
+#endif
+	return v;
+}
+
+string placement_str(const void* ptr, size_t size) {
+	const vector<double> v = placement(ptr, size);
+	if (v.empty())
+		return "n/a";
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(1);
+	for (size_t i = 0; i < v.size(); ++i)
+		ss << (i > 0 ? " " : "") << "node" << topology()[i].id << '=' << v[i] * 100 << '%';
+	return ss.str();
+}
+
+void log_topology() {
+	*log_stream << "NUMA nodes = " << topology().size();
+	for (const Node& n : topology())
+		*log_stream << " node" << n.id << "=[" << n.cpulist << ']';
+	*log_stream << endl;
+}
+
+}}
@@ -0,0 +1,46 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2012-2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// NUMA topology detection and memory placement. Implemented directly on top of the Linux
+// sysfs interface and the mbind/get_mempolicy/move_pages system calls, so no libnuma is
+// required. On other platforms (or single-node machines) all functions are no-ops.
+
+namespace Util { namespace Numa {
+
+// Number of online NUMA nodes (1 if the topology is unknown).
+int nodes();
+// True if --numa was given and the machine has more than one node.
+bool active();
+// Node assigned to a worker thread (round-robin over the nodes).
+int worker_node(size_t worker);
+// Restrict the calling thread to the CPUs of the given node. Returns false on failure.
+bool pin_thread(int node);
+// Interleave the pages of a memory range across all nodes, migrating pages that have already been touched.
+void interleave(void* ptr, size_t size);
+// Fraction of resident pages per node for a memory range (sampled).
+std::vector<double> placement(const void* ptr, size_t size);
+std::string placement_str(const void* ptr, size_t size);
+void log_topology();
+
+}}
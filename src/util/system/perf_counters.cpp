@@ -0,0 +1,167 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2012-2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <string.h>
+#include <errno.h>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+#include "perf_counters.h"
+#include "util/log_stream.h"
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#if defined(__linux__) && defined(SYS_perf_event_open)
+#define PERF_SYSCALLS
+#endif
+
+using std::vector;
+using std::string;
+using std::endl;
+using std::mutex;
+using std::lock_guard;
+
+namespace Util { namespace Perf {
+
+bool enabled = false;
+
+static const char* const NAMES[COUNT] = { "cycles", "instructions", "LLC misses", "dTLB misses", "branch misses" };
+static int fd_[COUNT] = { -1, -1, -1, -1, -1 };
+
+struct Phase {
+	string name;
+	Values counts;
+};
+
+static mutex mtx_;
+static vector<Phase> phases_;
+
+const char* name(int counter) {
+	return NAMES[counter];
+}
+
+bool available(int counter) {
+	return fd_[counter] >= 0;
+}
+
+#ifdef PERF_SYSCALLS
+
+static int open_counter(uint32_t type, uint64_t config) {
+	perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	attr.inherit = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+bool open() {
+	static const uint64_t CACHE_READ_MISS = ((uint64_t)PERF_COUNT_HW_CACHE_OP_READ << 8) | ((uint64_t)PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	const std::pair<uint32_t, uint64_t> events[COUNT] = {
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | CACHE_READ_MISS },
+		{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | CACHE_READ_MISS },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+	};
+	int n = 0, err = 0;
+	for (int i = 0; i < COUNT; ++i) {
+		if ((fd_[i] = open_counter(events[i].first, events[i].second)) >= 0)
+			++n;
+		else
+			err = errno;
+	}
+	if (n == 0) {
+		*message_stream << "Warning: hardware performance counters are not available (" << strerror(err) << ")." << endl;
+		return false;
+	}
+	for (int i = 0; i < COUNT; ++i)
+		if (fd_[i] < 0)
+			*log_stream << "Performance counter not available: " << NAMES[i] << endl;
+	enabled = true;
+	return true;
+}
+
+Values read() {
+	Values v;
+	for (int i = 0; i < COUNT; ++i) {
+		uint64_t buf[3];
+		if (fd_[i] < 0 || ::read(fd_[i], buf, sizeof(buf)) != (ssize_t)sizeof(buf) || buf[2] == 0)
+			v[i] = 0;
+		else
+			v[i] = buf[2] < buf[1] ? (uint64_t)((double)buf[0] * buf[1] / buf[2]) : buf[0];
+	}
+	return v;
+}
+
+#else
+
+bool open() {
+	*message_stream << "Warning: hardware performance counters are not supported on this platform." << endl;
+	return false;
+}
+
+Values read() {
+	return Values();
+}
+
+#endif
+
+void add_phase(const string& phase, const Values& begin) {
+	const Values end = read();
+	lock_guard<mutex> lock(mtx_);
+	auto it = phases_.begin();
+	while (it != phases_.end() && it->name != phase)
+		++it;
+	if (it == phases_.end())
+		it = phases_.insert(it, Phase{ phase, Values() });
+	for (int i = 0; i < COUNT; ++i)
+		it->counts[i] += end[i] > begin[i] ? end[i] - begin[i] : 0;
+}
+
+void print() {
+	if (!enabled)
+		return;
+	std::ostream& out = *message_stream;
+	auto row = [&out](const string& name, const Values& v) {
+		out << std::left << std::setw(40) << name.substr(0, 39) << std::right;
+		for (int i = 0; i < COUNT; ++i)
+			if (available(i))
+				out << std::setw(16) << v[i];
+		out << std::setw(8) << std::fixed << std::setprecision(2) << (v[CYCLES] ? (double)v[INSTRUCTIONS] / v[CYCLES] : 0.0) << std::defaultfloat << endl;
+	};
+	lock_guard<mutex> lock(mtx_);
+	out << endl << std::left << std::setw(40) << "Phase" << std::right;
+	for (int i = 0; i < COUNT; ++i)
+		if (available(i))
+			out << std::setw(16) << NAMES[i];
+	out << std::setw(8) << "IPC" << endl;
+	for (const Phase& p : phases_)
+		row(p.name, p.counts);
+	row("Total", read());
+}
+
+}}
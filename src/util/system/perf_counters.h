@@ -0,0 +1,50 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2012-2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <array>
+#include <string>
+#include <stdint.h>
+
+// Hardware performance counters (--perf-counters) implemented with perf_event_open. The counters are opened for the
+// main thread with the inherit flag, so that the kernel maintains a copy for every thread created afterwards and folds
+// its counts into the totals when the thread exits. Phases are attributed by TaskTimer: the counts of a worker thread
+// are assigned to the phase in which it is joined. Counters the kernel or hardware does not provide are reported as
+// unavailable; without perf_event_open (non-Linux, containers, perf_event_paranoid > 2) all functions are no-ops.
+
+namespace Util { namespace Perf {
+
+enum { CYCLES, INSTRUCTIONS, LLC_MISSES, DTLB_MISSES, BRANCH_MISSES, COUNT };
+
+using Values = std::array<uint64_t, COUNT>;
+
+extern bool enabled;
+
+// Opens the counters. Returns false and disables counting if none of them is available.
+bool open();
+const char* name(int counter);
+bool available(int counter);
+// Counts of the process since open(), scaled for multiplexing.
+Values read();
+// Adds the counts since begin to the totals of a phase.
+void add_phase(const std::string& phase, const Values& begin);
+// Prints the totals per phase to the log.
+void print();
+
+}}
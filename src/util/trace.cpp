@@ -0,0 +1,154 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "trace.h"
+
+using std::string;
+using std::vector;
+using std::mutex;
+using std::lock_guard;
+using std::endl;
+
+namespace Trace {
+
+bool enabled = false;
+
+struct Event {
+	char phase;
+	string name;
+	const char* category, * arg_name;
+	int64_t ts, dur, arg, query_block, ref_block;
+};
+
+struct ThreadBuffer {
+	int tid;
+	string name;
+	vector<Event> events;
+};
+
+static string file_name_;
+static std::chrono::steady_clock::time_point start_;
+static std::atomic<int64_t> query_block_(-1), ref_block_(-1);
+static mutex mtx_;
+static vector<std::unique_ptr<ThreadBuffer>> buffers_;
+static thread_local ThreadBuffer* buffer_ = nullptr;
+
+static ThreadBuffer& buffer() {
+	if (!buffer_) {
+		lock_guard<mutex> lock(mtx_);
+		buffers_.emplace_back(new ThreadBuffer{ (int)buffers_.size() + 1, string(), {} });
+		buffer_ = buffers_.back().get();
+	}
+	return *buffer_;
+}
+
+void open(const string& file_name) {
+	std::ofstream f(file_name);
+	if (!f)
+		throw std::runtime_error("Error opening file " + file_name);
+	file_name_ = file_name;
+	start_ = std::chrono::steady_clock::now();
+	enabled = true;
+	thread_name("main");
+}
+
+int64_t now() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_).count();
+}
+
+void set_blocks(int64_t query_block, int64_t ref_block) {
+	query_block_.store(query_block, std::memory_order_relaxed);
+	ref_block_.store(ref_block, std::memory_order_relaxed);
+}
+
+void thread_name(const string& name) {
+	if (enabled)
+		buffer().name = name;
+}
+
+void complete(const string& name, const char* category, int64_t begin, const char* arg_name, int64_t arg) {
+	if (!enabled)
+		return;
+	const int64_t t = now();
+	buffer().events.push_back({ 'X', name, category, arg_name, begin, t - begin, arg, query_block_.load(std::memory_order_relaxed), ref_block_.load(std::memory_order_relaxed) });
+}
+
+void counter(const char* name, int64_t value) {
+	if (enabled)
+		buffer().events.push_back({ 'C', name, nullptr, nullptr, now(), 0, value, -1, -1 });
+}
+
+static string escape(const string& s) {
+	string out;
+	for (char c : s) {
+		if (c == '"' || c == '\\')
+			out += '\\';
+		if ((unsigned char)c >= 0x20)
+			out += c;
+	}
+	return out;
+}
+
+// Writes the events of all threads. The worker threads have to be joined at this point.
+void close() {
+	if (!enabled)
+		return;
+	enabled = false;
+	lock_guard<mutex> lock(mtx_);
+	std::ofstream f(file_name_);
+	f << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << endl;
+	bool first = true;
+	for (const auto& b : buffers_) {
+		if (!b->name.empty()) {
+			f << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << b->tid << ", \"args\": {\"name\": \"" << escape(b->name) << "\"}}";
+			first = false;
+		}
+		for (const Event& e : b->events) {
+			f << (first ? "" : ",\n") << "{\"name\": \"" << escape(e.name) << "\", \"ph\": \"" << e.phase << "\", \"ts\": " << e.ts << ", \"pid\": 1, \"tid\": " << b->tid;
+			first = false;
+			if (e.phase == 'C') {
+				f << ", \"args\": {\"value\": " << e.arg << "}}";
+				continue;
+			}
+			f << ", \"cat\": \"" << e.category << "\", \"dur\": " << e.dur << ", \"args\": {";
+			const char* sep = "";
+			if (e.query_block >= 0) {
+				f << "\"query_block\": " << e.query_block;
+				sep = ", ";
+			}
+			if (e.ref_block >= 0) {
+				f << sep << "\"ref_block\": " << e.ref_block;
+				sep = ", ";
+			}
+			if (e.arg_name)
+				f << sep << "\"" << e.arg_name << "\": " << e.arg;
+			f << "}}";
+		}
+	}
+	f << endl << "]}" << endl;
+}
+
+}
@@ -0,0 +1,57 @@
+/****
+DIAMOND protein sequence aligner
+Copyright (C) 2026 Benjamin J. Buchfink
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+****/
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <string>
+#include <stdint.h>
+
+// Timeline of pipeline phases and worker threads in the Chrome/Perfetto trace event format (--trace-events).
+// Events are buffered per thread and written by close(). All functions return immediately unless open() was called.
+namespace Trace {
+
+extern bool enabled;
+
+void open(const std::string& file_name);
+void close();
+// Microseconds since open().
+int64_t now();
+// Sets the block ids attached to the events of all threads.
+void set_blocks(int64_t query_block, int64_t ref_block);
+void thread_name(const std::string& name);
+void complete(const std::string& name, const char* category, int64_t begin, const char* arg_name = nullptr, int64_t arg = 0);
+void counter(const char* name, int64_t value);
+
+struct Span {
+	Span(const char* name, const char* category, const char* arg_name = nullptr, int64_t arg = 0) :
+		name_(enabled ? name : nullptr),
+		category_(category),
+		arg_name_(arg_name),
+		arg_(arg),
+		begin_(enabled ? now() : 0)
+	{}
+	~Span() {
+		if (name_)
+			complete(name_, category_, begin_, arg_name_, arg_);
+	}
+private:
+	const char* name_, * category_, * arg_name_;
+	const int64_t arg_, begin_;
+};
+
+}
@@ -45,6 +45,7 @@ std::ostream* message_stream = new Nullostream;
 std::ostream* log_stream = new Nullostream;
 
 void cleanup() {
+	Trace::close();
 	if (message_stream != &std::cerr)
 		delete message_stream;
 	if (log_stream != &std::cerr)